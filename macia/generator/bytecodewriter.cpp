@@ -0,0 +1,138 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Bytecode Writer
+* - Appends whole instructions to a code buffer
+*/
+
+/* Includes */
+#include "bytecodewriter.h"
+#include <cstdlib>
+#include <new>
+
+/* Initial size of the code buffer */
+#define BYTECODEWRITER_INIT_SIZE	64
+
+/* Constructor
+ * Nothing is allocated before the first instruction */
+BytecodeWriter::BytecodeWriter() {
+	m_pData = NULL;
+	m_iSize = 0;
+	m_iCapacity = 0;
+}
+
+/* Destructor
+ * Cleans up the code */
+BytecodeWriter::~BytecodeWriter() {
+	free(m_pData);
+}
+
+/* Makes room for the given number of bytes and returns 
+ * where they go, the buffer grows geometrically */
+unsigned char *BytecodeWriter::Reserve(size_t Length) {
+	unsigned char *Destination;
+
+	if (m_iSize + Length > m_iCapacity) {
+		size_t Capacity = (m_iCapacity == 0) ? BYTECODEWRITER_INIT_SIZE : (m_iCapacity * 2);
+		unsigned char *Data;
+
+		while (Capacity < m_iSize + Length) {
+			Capacity *= 2;
+		}
+		Data = (unsigned char*)realloc(m_pData, Capacity);
+		if (Data == NULL) {
+			throw std::bad_alloc();
+		}
+		m_pData = Data;
+		m_iCapacity = Capacity;
+	}
+
+	Destination = m_pData + m_iSize;
+	m_iSize += Length;
+	return Destination;
+}
+
+/* op */
+void BytecodeWriter::Write(Opcode_t Opcode) {
+	unsigned char *Code = Reserve(1);
+	Code[0] = (unsigned char)Opcode;
+}
+
+/* op #id */
+void BytecodeWriter::WriteI(Opcode_t Opcode, int Value) {
+	unsigned char *Code = Reserve(5);
+	Code[0] = (unsigned char)Opcode;
+	StoreValue32(&Code[1], (unsigned int)Value);
+}
+
+/* op $, $ */
+void BytecodeWriter::WriteRR(Opcode_t Opcode, int Register1, int Register2) {
+	unsigned char *Code = Reserve(3);
+	Code[0] = (unsigned char)Opcode;
+	Code[1] = (unsigned char)Register1;
+	Code[2] = (unsigned char)Register2;
+}
+
+/* op $, #id */
+void BytecodeWriter::WriteRI(Opcode_t Opcode, int Register, int Value) {
+	unsigned char *Code = Reserve(6);
+	Code[0] = (unsigned char)Opcode;
+	Code[1] = (unsigned char)Register;
+	StoreValue32(&Code[2], (unsigned int)Value);
+}
+
+/* op #id, $ */
+void BytecodeWriter::WriteIR(Opcode_t Opcode, int Value, int Register) {
+	unsigned char *Code = Reserve(6);
+	Code[0] = (unsigned char)Opcode;
+	StoreValue32(&Code[1], (unsigned int)Value);
+	Code[5] = (unsigned char)Register;
+}
+
+/* op #id, #id */
+void BytecodeWriter::WriteII(Opcode_t Opcode, int Value1, int Value2) {
+	unsigned char *Code = Reserve(9);
+	Code[0] = (unsigned char)Opcode;
+	StoreValue32(&Code[1], (unsigned int)Value1);
+	StoreValue32(&Code[5], (unsigned int)Value2);
+}
+
+/* op $, [val64] */
+void BytecodeWriter::WriteRW(Opcode_t Opcode, int Register, long long Value) {
+	unsigned char *Code = Reserve(10);
+	Code[0] = (unsigned char)Opcode;
+	Code[1] = (unsigned char)Register;
+	StoreValue64(&Code[2], (unsigned long long)Value);
+}
+
+/* op #id, [val64] */
+void BytecodeWriter::WriteIW(Opcode_t Opcode, int Value1, long long Value2) {
+	unsigned char *Code = Reserve(13);
+	Code[0] = (unsigned char)Opcode;
+	StoreValue32(&Code[1], (unsigned int)Value1);
+	StoreValue64(&Code[5], (unsigned long long)Value2);
+}
+
+/* op $, #id, count */
+void BytecodeWriter::WriteRIR(Opcode_t Opcode, int Register1, int Value, int Register2) {
+	unsigned char *Code = Reserve(7);
+	Code[0] = (unsigned char)Opcode;
+	Code[1] = (unsigned char)Register1;
+	StoreValue32(&Code[2], (unsigned int)Value);
+	Code[6] = (unsigned char)Register2;
+}
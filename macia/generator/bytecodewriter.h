@@ -0,0 +1,78 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Bytecode Writer
+* - Appends whole instructions to a code buffer
+*/
+#pragma once
+
+/* Includes */
+#include <cstddef>
+#include "opcodes.h"
+
+/* The bytecode writer
+ * Every instruction is written with a single reservation,
+ * and the operands are stored little-endian right after the
+ * opcode. The methods are named by their operands, R is a 
+ * register or another 8 bit operand, I is an id or a 32 bit
+ * value and W is a 64 bit value. Allocation failures throw
+ * std::bad_alloc like the arena does */
+class BytecodeWriter
+{
+public:
+	BytecodeWriter();
+	~BytecodeWriter();
+
+	/* Instructions */
+	void Write(Opcode_t Opcode);
+	void WriteI(Opcode_t Opcode, int Value);
+	void WriteRR(Opcode_t Opcode, int Register1, int Register2);
+	void WriteRI(Opcode_t Opcode, int Register, int Value);
+	void WriteIR(Opcode_t Opcode, int Value, int Register);
+	void WriteII(Opcode_t Opcode, int Value1, int Value2);
+	void WriteRW(Opcode_t Opcode, int Register, long long Value);
+	void WriteIW(Opcode_t Opcode, int Value1, long long Value2);
+	void WriteRIR(Opcode_t Opcode, int Register1, int Value, int Register2);
+
+	/* Gets */
+	const unsigned char *GetData() { return m_pData; }
+	size_t GetSize() { return m_iSize; }
+
+private:
+	/* Private - Functions */
+	unsigned char *Reserve(size_t Length);
+
+	/* Private - Data */
+	unsigned char *m_pData;
+	size_t m_iSize;
+	size_t m_iCapacity;
+};
+
+/* Stores little-endian values, the bytes are written
+ * one by one so any alignment and host order works */
+static inline void StoreValue32(unsigned char *pDestination, unsigned int Value) {
+	pDestination[0] = Value & 0xFF;
+	pDestination[1] = (Value >> 8) & 0xFF;
+	pDestination[2] = (Value >> 16) & 0xFF;
+	pDestination[3] = (Value >> 24) & 0xFF;
+}
+
+static inline void StoreValue64(unsigned char *pDestination, unsigned long long Value) {
+	StoreValue32(pDestination, (unsigned int)(Value & 0xFFFFFFFF));
+	StoreValue32(pDestination + 4, (unsigned int)(Value >> 32));
+}
@@ -24,26 +24,43 @@
 /* Includes */
 #include "generator.h"
 #include <cstdio>
+#include <climits>
+#include <algorithm>
 
 /* Constructor 
- * Takes an AST for a program */
-Generator::Generator(Statement *AST) {
+ * Takes an AST for a program and the symbol
+ * table its identifiers were interned into */
+Generator::Generator(Statement *AST, SymbolTable *Symbols) {
 
 	/* Initialize */
-	m_pPool = new DataPool();
+	m_pSymbols = Symbols;
+	m_pPool = new DataPool(Symbols);
+	m_pArena = new Arena();
+	m_pOptimizer = new Optimizer(m_pArena);
+	m_pAllocator = new RegisterAllocator(m_pPool);
 
 	/* Initialize lists */
-	m_sRegisters.clear();
+	m_sValues.clear();
 	m_lByteCode.clear();
 	m_lByteData.clear();
 
-	/* Add registers */
-	for (int i = 0; i < MACIA_REGISTER_COUNT; i++) {
-		m_sRegisters[i] = 0;
+	/* Store */
+	m_lPrograms.clear();
+	AddProgram(AST);
+}
+
+/* Adds the AST of another compilation unit,
+ * all units are generated into the same program */
+void Generator::AddProgram(Statement *AST) {
+	if (AST != NULL) {
+		m_lPrograms.push_back(AST);
 	}
+}
 
-	/* Store */
-	m_pAST = AST;
+/* Adds a directory to search for the modules 
+ * of imported namespaces, in the order added */
+void Generator::AddModulePath(const char *pPath) {
+	m_lModulePaths.push_back(pPath);
 }
 
 /* Destructor 
@@ -51,15 +68,20 @@ Generator::Generator(Statement *AST) {
 Generator::~Generator() {
 
 	/* Clear out lists */
-	m_sRegisters.clear();
+	m_sValues.clear();
 	m_lByteCode.clear();
 	m_lByteData.clear();
 
-	/* Clear out data pool */
+	/* Clear out allocator and data pool */
+	delete m_pAllocator;
 	delete m_pPool;
 
-	/* Null */
-	m_pAST = NULL;
+	/* The folded expressions */
+	delete m_pOptimizer;
+	delete m_pArena;
+
+	/* Clear out programs */
+	m_lPrograms.clear();
 }
 
 /* Generates the entry point for the program 
@@ -74,10 +96,17 @@ void Generator::GenerateEntry() {
 	int VarId = 0;
 	int Id = 0;
 
-	/* Lookup program object & functions */
-	ObjectId = m_pPool->LookupSymbol("Program", -1);
-	ConstructorId = m_pPool->LookupSymbol("Program", ObjectId);
-	MainId = m_pPool->LookupSymbol("Main", ObjectId);
+	/* Lookup program object & functions, the 
+	 * object can also be in one of our namespaces */
+	ObjectId = m_pPool->LookupSymbol(m_pSymbols->Intern("Program"), -1);
+	for (int i = 0; ObjectId == -1 && i < m_pPool->GetCount(); i++) {
+		if (m_pPool->GetObject(i)->GetType() == CTNamespace
+			&& m_pPool->GetObject(i)->GetModule() == -1) {
+			ObjectId = m_pPool->LookupSymbol(m_pSymbols->Intern("Program"), i);
+		}
+	}
+	ConstructorId = m_pPool->LookupSymbol(m_pSymbols->Intern("Program"), ObjectId);
+	MainId = m_pPool->LookupSymbol(m_pSymbols->Intern("Main"), ObjectId);
 
 	/* Sanity */
 	if (ObjectId == -1
@@ -87,33 +116,23 @@ void Generator::GenerateEntry() {
 	}
 
 	/* Generate the entry point function */
-	Id = m_pPool->CreateFunction("__maciaentry", -1);
+	Id = m_pPool->CreateFunction(m_pSymbols->Intern("__maciaentry"), -1);
 
 	/* Define the needed variables */
-	VarId = m_pPool->DefineVariable("__entry", Id);
+	VarId = m_pPool->DefineVariable(m_pSymbols->Intern("__entry"), Id);
 
 	/* Allocate a register */
-	TemporaryRegister = AllocateRegister();
+	m_pAllocator->Begin(Id);
+	TemporaryRegister = m_pAllocator->CreateRegister();
 
 	/* Add code */
-	m_pPool->AddOpcode(Id, OpNew);
-	m_pPool->AddCode8(Id, TemporaryRegister);
-	m_pPool->AddCode32(Id, ObjectId);
-
-	m_pPool->AddOpcode(Id, OpStoreAR);
-	m_pPool->AddCode32(Id, VarId);
-	m_pPool->AddCode8(Id, TemporaryRegister);
-
-	m_pPool->AddOpcode(Id, OpInvoke);
-	m_pPool->AddCode8(Id, TemporaryRegister);
-	m_pPool->AddCode32(Id, ConstructorId);
-
-	m_pPool->AddOpcode(Id, OpInvoke);
-	m_pPool->AddCode8(Id, TemporaryRegister);
-	m_pPool->AddCode32(Id, MainId);
+	m_pAllocator->EmitRI(OpNew, TemporaryRegister, ObjectId);
+	m_pAllocator->EmitIR(OpStoreAR, VarId, TemporaryRegister);
+	m_pAllocator->EmitRI(OpInvoke, TemporaryRegister, ConstructorId);
+	m_pAllocator->EmitRI(OpInvoke, TemporaryRegister, MainId);
 
 	/* Cleanup */
-	DeallocateRegister(TemporaryRegister);
+	m_pAllocator->Finish();
 }
 
 /* Generate the bytecode from the AST,
@@ -124,70 +143,100 @@ int Generator::Generate() {
 	 * here, unfortunately I can't use this function
 	 * for the recursion as it takes no params */
 
-	/* Step 1 will be parsing the AST */
-	if (ParseStatement(m_pAST, -1)) {
-		return -1;
+	/* Step 0 is folding the constant expressions, 
+	 * so they are generated as a single literal */
+	for (size_t i = 0; i < m_lPrograms.size(); i++) {
+		m_pOptimizer->Optimize(m_lPrograms[i]);
 	}
 
-	/* Generate an entry point */
-	GenerateEntry();
+	/* The labels of a statement fit without rehashing */
+	m_sLabels.reserve(m_pOptimizer->GetLargestExpression());
 
-	/* Step 2 is now compiling everything together */
-	for (std::map<int, CodeObject*>::iterator Itr = m_pPool->GetTable().begin(); 
-		Itr != m_pPool->GetTable().end(); Itr++) {
-		
-		/* Get index */
-		CodeObject *Obj = Itr->second;
-		size_t DataLength = strlen(Obj->GetPath());
-		const char *DataPtr = Obj->GetPath();
-
-		/* Serialize code object */
-
-		/* Write Id */
-		m_lByteData.push_back(Itr->first & 0xFF);
-		m_lByteData.push_back((Itr->first >> 8) & 0xFF);
-		m_lByteData.push_back((Itr->first >> 16) & 0xFF);
-		m_lByteData.push_back((Itr->first >> 24) & 0xFF);
-
-		/* Write Type */
-		m_lByteData.push_back(Obj->GetType() & 0xFF);
-
-		/* Write length */
-		m_lByteData.push_back(DataLength & 0xFF);
-		m_lByteData.push_back((DataLength >> 8) & 0xFF);
-		m_lByteData.push_back((DataLength >> 16) & 0xFF);
-		m_lByteData.push_back((DataLength >> 24) & 0xFF);
-
-		/* Write Data */
-		while (*DataPtr) {
-			m_lByteData.push_back(*DataPtr);
-			DataPtr++;
+	/* Step 1 will be declaring the namespaces and functions
+	 * of every unit, so calls can refer to all of them */
+	for (size_t i = 0; i < m_lPrograms.size(); i++) {
+		if (DeclareFunctions(m_lPrograms[i], -1)) {
+			return -1;
 		}
+	}
 
-		/* Function? */
-		if (Obj->GetType() == CTFunction) {
-			
-			/* Write prologue */
-			m_lByteCode.push_back(OpLabel);
-			m_lByteCode.push_back(Itr->first & 0xFF);
-			m_lByteCode.push_back((Itr->first >> 8) & 0xFF);
-			m_lByteCode.push_back((Itr->first >> 16) & 0xFF);
-			m_lByteCode.push_back((Itr->first >> 24) & 0xFF);
+	/* Step 2 will be parsing the AST of each unit */
+	for (size_t i = 0; i < m_lPrograms.size(); i++) {
+		if (ParseStatement(m_lPrograms[i], -1)) {
+			return -1;
+		}
+	}
 
-			/* Write code */
-			for (int i = 0; i < (int)Obj->GetCode().size(); i++) {
-				m_lByteCode.push_back(Obj->GetCode().at(i));
-			}
+	/* Generate an entry point */
+	GenerateEntry();
 
-			/* Write epilogue */
-			m_lByteCode.push_back(OpReturn);
+	/* Step 3 is now compiling everything together, the 
+	 * image is sized up front so each object is a copy */
+	size_t CodeSize = 0, DataSize = 0;
+	for (int i = 0; i < m_pPool->GetCount(); i++) {
+		CodeObject *Obj = m_pPool->GetObject(i);
+		DataSize += 9 + strlen(Obj->GetPath());
+		if (Obj->GetType() == CTFunction && Obj->GetModule() == -1) {
+			CodeSize += 5 + Obj->GetCode().GetSize() + 1;
 		}
 	}
+	m_lByteCode.reserve(m_lByteCode.size() + CodeSize);
+	m_lByteData.reserve(m_lByteData.size() + DataSize);
+	for (int i = 0; i < m_pPool->GetCount(); i++) {
+		SerializeObject(i, m_pPool->GetObject(i), m_lByteCode, m_lByteData);
+	}
 
 	/* Just return the result of Parser */
 	return 0;
 }
 
+/* Serializes a code object, the entry goes into the data
+ * and the code of functions is appended to the code. Objects
+ * of imported modules are marked and have no code. The buffers
+ * grow by a single resize per object, callers pre-size them 
+ * to avoid reallocations */
+void Generator::SerializeObject(int Id, CodeObject *Obj, 
+	std::vector<unsigned char> &Code, std::vector<unsigned char> &Data) {
+
+	/* Variables */
+	size_t DataLength = strlen(Obj->GetPath());
+	size_t Offset = Data.size();
+	int Type = Obj->GetType();
+
+	/* Imported? */
+	if (Obj->GetModule() != -1) {
+		Type |= CT_IMPORTED;
+	}
+
+	/* Write Id, Type, length and the path */
+	Data.resize(Offset + 9 + DataLength);
+	StoreValue32(&Data[Offset], (unsigned int)Id);
+	Data[Offset + 4] = Type & 0xFF;
+	StoreValue32(&Data[Offset + 5], (unsigned int)DataLength);
+	memcpy(&Data[Offset + 9], Obj->GetPath(), DataLength);
+
+	/* Function? */
+	if (Obj->GetType() == CTFunction && Obj->GetModule() == -1) {
+		
+		/* Variables */
+		BytecodeWriter &Writer = Obj->GetCode();
+		Offset = Code.size();
+		Code.resize(Offset + 5 + Writer.GetSize() + 1);
+
+		/* Write prologue */
+		Code[Offset] = OpLabel;
+		StoreValue32(&Code[Offset + 1], (unsigned int)Id);
+
+		/* Write code */
+		if (Writer.GetSize() != 0) {
+			memcpy(&Code[Offset + 5], Writer.GetData(), Writer.GetSize());
+		}
+
+		/* Write epilogue */
+		Code[Offset + 5 + Writer.GetSize()] = OpReturn;
+	}
+}
+
 /* Save the code and data to a object file
 * this can then be compiled into native code
 * or run by the interpreter */
@@ -212,10 +261,10 @@ int Generator::SaveAs(const char *Path) {
 	Header[0] = 0x01;
 
 	/* Size of code */
-	*((size_t*)&Header[4]) = m_lByteCode.size();
+	StoreValue32((unsigned char*)&Header[4], (unsigned int)m_lByteCode.size());
 
 	/* Size of data */
-	*((size_t*)&Header[8]) = m_lByteData.size();
+	StoreValue32((unsigned char*)&Header[8], (unsigned int)m_lByteData.size());
 
 	/* Write the header */
 	fwrite(&Header[0], 1, sizeof(Header), dest);
@@ -233,29 +282,180 @@ int Generator::SaveAs(const char *Path) {
 	return 0;
 }
 
-/* Allocates a register or 
- * prints an error on register failure */
-int Generator::AllocateRegister() {
+/* Save every namespace as a module of its own
+ * in the given directory. A module holds everything 
+ * declared in the namespace and the string pool, all 
+ * but the strings are in the export table */
+int Generator::SaveModules(const char *pDirectory) {
+
+	/* Iterate the namespaces */
+	for (int SpaceId = 0; SpaceId < m_pPool->GetCount(); SpaceId++) {
+
+		/* Variables */
+		std::vector<ModuleExport_t> Exports;
+		std::vector<unsigned char> Code;
+		std::vector<unsigned char> Data;
+		CodeObject *Space = m_pPool->GetObject(SpaceId);
+		size_t PrefixLength = strlen(Space->GetPath()) + 1;
+		char Path[512];
+
+		/* Only our own */
+		if (Space->GetType() != CTNamespace
+			|| Space->GetModule() != -1) {
+			continue;
+		}
+
+		/* Collect the objects of the namespace */
+		for (int Id = 0; Id < m_pPool->GetCount(); Id++) {
+			CodeObject *Obj = m_pPool->GetObject(Id);
+			int ScopeId = Obj->GetScopeId();
+
+			/* Find the outermost scope */
+			while (ScopeId != -1 && ScopeId != SpaceId) {
+				ScopeId = m_pPool->GetObject(ScopeId)->GetScopeId();
+			}
+
+			/* Strings are shared by everything */
+			if (Obj->GetType() == CTString) {
+				SerializeObject(Id, Obj, Code, Data);
+				continue;
+			}
+			if (ScopeId != SpaceId || Obj->GetModule() != -1) {
+				continue;
+			}
+			SerializeObject(Id, Obj, Code, Data);
+
+			/* The variables of functions are private */
+			if (m_pPool->GetObject(Obj->GetScopeId())->GetType() == CTFunction) {
+				continue;
+			}
 
-	/* Look for a free register */
-	for (int i = 0; i < MACIA_REGISTER_COUNT; i++) {
-		if (m_sRegisters[i] == 0) {
-			m_sRegisters[i] = 1;
-			return i;
+			/* Export it by the path in the namespace */
+			ModuleExport_t Export;
+			Export.Name = (char*)Obj->GetPath() + PrefixLength;
+			Export.Id = Id;
+			Export.Type = Obj->GetType();
+			Export.ArgumentCount = Obj->GetArgumentCount();
+			Exports.push_back(Export);
 		}
+
+		/* Write it */
+		snprintf(&Path[0], sizeof(Path), "%s/%s%s", pDirectory, 
+			Space->GetPath(), MODULE_EXTENSION);
+		if (SaveModule(&Path[0], Exports, Code, Data)) {
+			printf("Unable to write module %s\n", &Path[0]);
+			return -1;
+		}
+
+#ifdef DIAGNOSE
+		printf(" - Wrote module %s (%u exports)\n", &Path[0], (unsigned)Exports.size());
+#endif
 	}
 
-	/* Fail - Abort */
-	printf("OUT OF REGISTERS FOR ALLOCATION! ALERT! ABORT!\n");
-	return -1;
+	/* Done! */
+	return 0;
 }
 
-/* Deallocates a register and 
- * marks it free for usage */
-void Generator::DeallocateRegister(int Register) {
+/* Gets the register the value of a variable is kept in, 
+ * or -1 when it has to be loaded */
+int Generator::LookupValue(int Id) {
+	std::map<int, int>::iterator Value = m_sValues.find(Id);
+	return (Value == m_sValues.end()) ? -1 : Value->second;
+}
 
-	/* Just mark it free */
-	m_sRegisters[Register] = 0;
+/* Remembers the register holding the value of a variable, so
+ * later uses don't load it again. Only the variables of the 
+ * function being generated are kept, as nothing else can change 
+ * them. The register must not be written anymore, -1 forgets it */
+void Generator::SetValue(int Id, int Register, GenState_t *State) {
+	if (Id < 0 || Register == -1 || State->CodeScopeId < 0
+		|| m_pPool->GetObject(State->CodeScopeId)->GetType() != CTFunction
+		|| m_pPool->GetObject(Id)->GetScopeId() != State->CodeScopeId) {
+		m_sValues.erase(Id);
+		return;
+	}
+	m_sValues[Id] = Register;
+}
+
+/* Declares the namespaces and functions of a body before
+ * its code is generated, so calls can refer to functions 
+ * defined later. The arguments are the first variables 
+ * of a function */
+int Generator::DeclareFunctions(Statement *pBody, int ScopeId) {
+
+	/* Variables */
+	Sequence *Seq = NULL;
+
+	/* Sanity */
+	if (pBody == NULL || pBody->GetType() != StmtSequence)
+		return 0;
+
+	/* Cast to correct type */
+	Seq = (Sequence*)pBody;
+
+	/* Only the functions of this body */
+	for (size_t i = 0; i < Seq->GetCount(); i++) {
+		Function *Func = (Function*)Seq->GetStatement(i);
+		int Id;
+
+		/* Namespaces, and the functions in them */
+		if (Func != NULL && Func->GetType() == StmtNamespace && ScopeId == -1) {
+			Namespace *Space = (Namespace*)Seq->GetStatement(i);
+
+			Id = m_pPool->CreateNamespace(Space->GetIdentifier());
+			if (Id == -1) {
+
+				/* Error message */
+				printf("Unable to define namespace %s, check for dublicates...\n", m_pSymbols->GetName(Space->GetIdentifier()));
+
+				/* Return error - bail! */
+				return -1;
+			}
+
+			if (DeclareFunctions(Space->GetBody(), Id)) {
+				return -1;
+			}
+			continue;
+		}
+
+		if (Func == NULL || Func->GetType() != StmtFunction)
+			continue;
+
+		/* Write the Function definition */
+		Id = m_pPool->CreateFunction(Func->GetIdentifier(), ScopeId);
+
+		/* Sanity
+		 * Was it created correctly? */
+		if (Id == -1) {
+
+			/* Error message */
+			printf("Unable to define function %s, check for dublicates...\n", m_pSymbols->GetName(Func->GetIdentifier()));
+
+			/* Return error - bail! */
+			return -1;
+		}
+
+		/* Define the arguments in order */
+		for (size_t j = 0; j < Func->GetParameterCount(); j++) {
+			Declaration *Param = Func->GetParameter(j);
+
+			if (m_pPool->DefineVariable(Param->GetIdentifier(), Id) == -1) {
+
+				/* Error message */
+				printf("Unable to define argument %s of function %s, check for dublicates...\n", 
+					m_pSymbols->GetName(Param->GetIdentifier()), m_pSymbols->GetName(Func->GetIdentifier()));
+
+				/* Return error - bail! */
+				return -1;
+			}
+		}
+
+		/* Store the arity for the calls */
+		m_pPool->GetObject(Id)->SetArgumentCount((int)Func->GetParameterCount());
+	}
+
+	/* No Error */
+	return 0;
 }
 
 /* The actual statement parser
@@ -279,11 +479,100 @@ int Generator::ParseStatement(Statement *pStmt, int ScopeId) {
 			/* Cast to correct type */
 			Sequence *Seq = (Sequence*)pStmt;
 
-			/* Generate code (left-hand first?) */
-			if (ParseStatement(Seq->GetStatement1(), ScopeId)
-				|| ParseStatement(Seq->GetStatement2(), ScopeId)) {
+			/* Generate code in order, only the bodies 
+			 * of objects and functions recurse */
+			for (size_t i = 0; i < Seq->GetCount(); i++) {
+				Statement *Stmt = Seq->GetStatement(i);
+
+				/* Code outside of functions is allocated 
+				 * statement by statement */
+				int Standalone = (Stmt != NULL 
+					&& (Stmt->GetType() == StmtDeclaration || Stmt->GetType() == StmtAssign 
+						|| Stmt->GetType() == StmtCall)
+					&& (ScopeId == -1 || m_pPool->GetObject(ScopeId)->GetType() != CTFunction));
+
+				if (Standalone) {
+					m_pAllocator->Begin(ScopeId);
+				}
+				if (ParseStatement(Stmt, ScopeId)) {
+					return -1;
+				}
+				if (Standalone && m_pAllocator->Finish()) {
+					return -1;
+				}
+			}
+
+		} break;
+
+		/* The namespace declaration */
+		case StmtNamespace: {
+
+			/* Cast to correct type */
+			Namespace *Space = (Namespace*)pStmt;
+
+			/* The namespace was declared with its body */
+			int Id = (ScopeId == -1) ? m_pPool->LookupSymbol(Space->GetIdentifier(), -1) : -1;
+
+			/* Sanity 
+			 * They can't be nested */
+			if (Id == -1) {
+
+				/* Error message */
+				printf("Unable to define namespace %s, namespaces can only be declared at the top level...\n", 
+					m_pSymbols->GetName(Space->GetIdentifier()));
+
+				/* Return error - bail! */
+				return -1;
+			}
+
+			/* Parse the body */
+			if (ParseStatement(Space->GetBody(), Id)) {
+				return -1;
+			}
+
+		} break;
+
+		/* The import of a namespace */
+		case StmtImport: {
+
+			/* Cast to correct type */
+			Import *Imp = (Import*)pStmt;
+			const char *Name = m_pSymbols->GetName(Imp->GetIdentifier());
+			int SpaceId = m_pPool->LookupSymbol(Imp->GetIdentifier(), -1);
+			char Path[512];
+			FILE *Module = NULL;
+
+			/* Sanity */
+			if (ScopeId != -1) {
+				printf("Unable to import %s, imports can only be used at the top level...\n", Name);
+				return -1;
+			}
+
+			/* Compiled with us? */
+			if (SpaceId != -1 && m_pPool->GetObject(SpaceId)->GetType() == CTNamespace) {
+				m_pPool->AddImport(Imp->GetIdentifier(), NULL);
+				break;
+			}
+
+			/* Locate the module, it is not 
+			 * read untill a symbol is used */
+			for (size_t i = 0; i < m_lModulePaths.size() && Module == NULL; i++) {
+				snprintf(&Path[0], sizeof(Path), "%s/%s%s", m_lModulePaths[i], Name, MODULE_EXTENSION);
+				Module = fopen(&Path[0], "rb");
+			}
+
+			/* Sanity */
+			if (Module == NULL) {
+				printf("Unable to find module %s%s for the import...\n", Name, MODULE_EXTENSION);
 				return -1;
 			}
+			fclose(Module);
+
+#ifdef DIAGNOSE
+			printf("Import %s (%s)\n", Name, &Path[0]);
+#endif
+
+			m_pPool->AddImport(Imp->GetIdentifier(), &Path[0]);
 
 		} break;
 
@@ -294,19 +583,24 @@ int Generator::ParseStatement(Statement *pStmt, int ScopeId) {
 			Object *Obj = (Object*)pStmt;
 
 			/* Write the Object definition */
-			int Id = m_pPool->CreateObject(Obj->GetIdentifier());
+			int Id = m_pPool->CreateObject(Obj->GetIdentifier(), ScopeId);
 
 			/* Sanity
 			* Was it created correctly? */
 			if (Id == -1) {
 
 				/* Error message */
-				printf("Unable to define object %s, check for dublicates...\n", Obj->GetIdentifier());
+				printf("Unable to define object %s, check for dublicates...\n", m_pSymbols->GetName(Obj->GetIdentifier()));
 
 				/* Return error - bail! */
 				return -1;
 			}
 
+			/* Declare the functions of the body */
+			if (DeclareFunctions(Obj->GetBody(), Id)) {
+				return -1;
+			}
+
 			/* Parse the body */
 			if (ParseStatement(Obj->GetBody(), Id)) {
 				return -1;
@@ -320,28 +614,34 @@ int Generator::ParseStatement(Statement *pStmt, int ScopeId) {
 			/* Cast to correct type */
 			Function *Func = (Function*)pStmt;
 
-			/* Write the Function definition */
-			int Id = m_pPool->CreateFunction(Func->GetIdentifier(), ScopeId);
+			/* The function was declared with its body */
+			int Id = m_pPool->LookupSymbol(Func->GetIdentifier(), ScopeId);
 
 #ifdef DIAGNOSE
-			printf("Function %s()\n", Func->GetIdentifier());
+			printf("Function %s()\n", m_pSymbols->GetName(Func->GetIdentifier()));
 #endif
 
 			/* Sanity
-			* Was it created correctly? */
+			* Was it declared correctly? */
 			if (Id == -1) {
 
 				/* Error message */
-				printf("Unable to define function %s, check for dublicates...\n", Func->GetIdentifier());
+				printf("Unable to define function %s, check for dublicates...\n", m_pSymbols->GetName(Func->GetIdentifier()));
 
 				/* Return error - bail! */
 				return -1;
 			}
 
-			/* Parse the body */
+			/* Parse the body, the registers are allocated 
+			 * when the whole function is generated */
+			m_pAllocator->Begin(Id);
+			m_sValues.clear();
 			if (ParseStatement(Func->GetBody(), Id)) {
 				return -1;
 			}
+			if (m_pAllocator->Finish()) {
+				return -1;
+			}
 
 #ifdef DIAGNOSE
 			printf("return\n");
@@ -363,7 +663,7 @@ int Generator::ParseStatement(Statement *pStmt, int ScopeId) {
 			if (Id == -1) {
 
 				/* Error message */
-				printf("Unable to define variable %s, check for dublicates...\n", Decl->GetIdentifier());
+				printf("Unable to define variable %s, check for dublicates...\n", m_pSymbols->GetName(Decl->GetIdentifier()));
 
 				/* Return error - bail! */
 				return -1;
@@ -386,15 +686,16 @@ int Generator::ParseStatement(Statement *pStmt, int ScopeId) {
 			/* Cast to correct type */
 			Assignment *Ass = (Assignment*)pStmt;
 
-			/* Lookup the given symbol and get the id */
-			int Id = m_pPool->LookupSymbol(Ass->GetIdentifier(), ScopeId);
+			/* Lookup the given symbol and get the id, 
+			 * it can be in any of the scopes around us */
+			int Id = m_pPool->ResolveSymbol(Ass->GetIdentifier(), ScopeId);
 
 			/* Sanity 
 			 * We must find the id */
 			if (Id == -1) {
 
 				/* Error message */
-				printf("Unable to find variable with name %s...\n", Ass->GetIdentifier());
+				printf("Unable to find variable with name %s...\n", m_pSymbols->GetName(Ass->GetIdentifier()));
 
 				/* Return error - bail! */
 				return -1;
@@ -411,6 +712,27 @@ int Generator::ParseStatement(Statement *pStmt, int ScopeId) {
 
 		} break;
 
+		/* The call statement */
+		case StmtCall: {
+
+			/* Cast to correct type */
+			Call *CallStmt = (Call*)pStmt;
+			int Register = -1;
+
+			/* Setup the GenState */
+			State.CodeScopeId = ScopeId;
+			State.ActiveReference = -1;
+			State.ActiveRegister = -1;
+			State.GenerateCleanUp = 0;
+
+			/* Evaluate the call, the result is not used */
+			if (ParseOperand(CallStmt->GetCall(), &State, &Register, 1)) {
+				return -1;
+			}
+			m_sLabels.clear();
+
+		} break;
+
 		default: {
 			/* Error message */
 			printf("Unsupported statement for bytecode generation...\n");
@@ -429,42 +751,41 @@ int Generator::ParseExpressions(Expression *pExpr, GenState_t *State) {
 
 	/* Setup initial registers */
 	State->ActiveRegister = -1;
-	State->IntermediateRegister = -1;
 	State->GenerateCleanUp = 0;
 
 	/* Now generate the code */
-	for (int i = 0; i < (int)OperatorGroupCount; i++) {
-		if (ParseExpression(pExpr, State, (OperatorGroup_t)i))
-			return -1;
+	if (ParseExpression(pExpr, State)) {
+		return -1;
 	}
 
-	/* Generate cleanup statement? */
-	if (State->GenerateCleanUp) {
-		m_pPool->AddOpcode(State->CodeScopeId, OpStoreAR);
-		m_pPool->AddCode32(State->CodeScopeId, State->ActiveReference);
-		m_pPool->AddCode8(State->CodeScopeId, State->ActiveRegister);
-
-#ifdef DIAGNOSE
-		printf("storear #%i, $%i\n", State->ActiveReference, State->ActiveRegister);
-#endif
+	/* The labels are only needed while
+	 * the expression is generated */
+	m_sLabels.clear();
 
-		/* Deallocate */
-		DeallocateRegister(State->ActiveRegister);
+	/* Generate cleanup statement? The result 
+	 * stays around for later uses */
+	if (State->GenerateCleanUp) {
+		m_pAllocator->EmitIR(OpStoreAR, State->ActiveReference, State->ActiveRegister);
+		SetValue(State->ActiveReference, State->ActiveRegister, State);
 	}
 
 	return 0;
 }
 
-/* This is a recursive expression parser 
- * used for turning AST expressions into bytecode */
-int Generator::ParseExpression(Expression *pExpr, GenState_t *State, OperatorGroup_t Group) {
+/* This turns the AST expression of a statement into
+ * bytecode, values are written to the variable reference
+ * directly and operators are evaluated into a register.
+ * The tree is walked once and is left as it is */
+int Generator::ParseExpression(Expression *pExpr, GenState_t *State) {
 
 	/* Sanity */
-	if (pExpr == NULL
-		|| pExpr->IsSolved()) {
+	if (pExpr == NULL) {
 		return 0;
 	}
 
+	/* Constants are generated as the literal they fold to */
+	pExpr = m_pOptimizer->GetFolded(pExpr);
+
 	/* Determine what kind of expression .. */
 	switch (pExpr->GetType()) {
 
@@ -474,51 +795,17 @@ int Generator::ParseExpression(Expression *pExpr, GenState_t *State, OperatorGro
 			/* Cast to correct expression type */
 			Variable *Var = (Variable*)pExpr;
 
-			/* Lookup Id */
-			int Id = m_pPool->LookupSymbol(Var->GetIdentifier(), State->CodeScopeId);
-
-			/* Sanity, don't parse us 
-			 * unless we are asked for non operators */
-			if (Group != OpGroupSingles) {
-				return 0;
-			}
-
-			/* Generate some code */
-			if ((State->IntermediateRegister != -1
-				|| State->ActiveRegister != -1)) {
-
-				/* Select register */
-				int Register = State->IntermediateRegister;
-
-				/* Sanity */
-				if (Register == -1)
-					Register = State->ActiveRegister;
+			/* Lookup Id, it can be in any 
+			 * of the scopes around us */
+			int Id = m_pPool->ResolveSymbol(Var->GetIdentifier(), State->CodeScopeId);
 
-				/* We are working in a temporary register
-				* use appropriate instructions */
-				m_pPool->AddOpcode(State->CodeScopeId, OpLoadRA);
-				m_pPool->AddCode8(State->CodeScopeId, Register);
-				m_pPool->AddCode32(State->CodeScopeId, Id);
-
-#ifdef DIAGNOSE
-				printf("loadra $%i, #%i\n", Register, Id);
-#endif
-			}
-			else {
-
-				/* We are working with a variable reference
-				* use appropriate instructions */
-				m_pPool->AddOpcode(State->CodeScopeId, OpLoadA);
-				m_pPool->AddCode32(State->CodeScopeId, State->ActiveReference);
-				m_pPool->AddCode32(State->CodeScopeId, Id);
-
-#ifdef DIAGNOSE
-				printf("loada #%i, #%i\n", State->ActiveReference, Id);
-#endif
-			}
-
-			/* Set us to solved */
-			pExpr->SetSolved();
+			/* We are working with a variable reference
+			 * use appropriate instructions */
+			if (LookupValue(Id) != -1)
+				m_pAllocator->EmitIR(OpStoreAR, State->ActiveReference, LookupValue(Id));
+			else
+				m_pAllocator->EmitII(OpLoadA, State->ActiveReference, Id);
+			SetValue(State->ActiveReference, LookupValue(Id), State);
 
 		} break;
 
@@ -531,301 +818,283 @@ int Generator::ParseExpression(Expression *pExpr, GenState_t *State, OperatorGro
 			/* Define it in our data-pool */
 			int Id = m_pPool->DefineString(String->GetValue());
 
-			/* Sanity, don't parse us 
-			 * unless we are asked for non operators */
-			if (Group != OpGroupSingles) {
-				return 0;
-			}
+			/* We are working with a variable reference
+			 * use appropriate instructions */
+			m_pAllocator->EmitII(OpLoadA, State->ActiveReference, Id);
+			SetValue(State->ActiveReference, -1, State);
 
-			/* Generate some code */
-			if ((State->IntermediateRegister != -1
-				|| State->ActiveRegister != -1)) {
+		} break;
 
-				/* Select register */
-				int Register = State->IntermediateRegister;
+		/* Int Literal? */
+		case ExprInteger: {
 
-				/* Sanity */
-				if (Register == -1)
-					Register = State->ActiveRegister;
+			/* Cast to correct expression type */
+			IntValue *Int = (IntValue*)pExpr;
+			long long Value = Int->GetValue();
 
-				/* We are working in a temporary register
-				* use appropriate instructions */
-				m_pPool->AddOpcode(State->CodeScopeId, OpLoadRA);
-				m_pPool->AddCode8(State->CodeScopeId, Register);
-				m_pPool->AddCode32(State->CodeScopeId, Id);
+			/* We are working with a variable reference
+			 * use appropriate instructions, values outside
+			 * 32 bits need the wide opcode */
+			if (Value < INT_MIN || Value > INT_MAX)
+				m_pAllocator->EmitIW(OpStoreIW, State->ActiveReference, Value);
+			else
+				m_pAllocator->EmitII(OpStoreI, State->ActiveReference, (int)Value);
+			SetValue(State->ActiveReference, -1, State);
 
-#ifdef DIAGNOSE
-				printf("loadra $%i, #%i\n", Register, Id);
-#endif
-			}
-			else {
+		} break;
 
-				/* We are working with a variable reference
-				* use appropriate instructions */
-				m_pPool->AddOpcode(State->CodeScopeId, OpLoadA);
-				m_pPool->AddCode32(State->CodeScopeId, State->ActiveReference);
-				m_pPool->AddCode32(State->CodeScopeId, Id);
+		/* Float Literal? */
+		case ExprFloat: {
 
-#ifdef DIAGNOSE
-				printf("loada #%i, #%i\n", State->ActiveReference, Id);
-#endif
+			/* Cast to correct expression type, the 
+			 * value is emitted by its bit pattern */
+			FloatValue *Float = (FloatValue*)pExpr;
+			double Value = Float->GetValue();
+			long long Bits = 0;
+			memcpy(&Bits, &Value, sizeof(Bits));
+
+			/* We are working with a variable reference
+			 * use appropriate instructions */
+			m_pAllocator->EmitIW(OpStoreF, State->ActiveReference, Bits);
+			SetValue(State->ActiveReference, -1, State);
+
+		} break;
+
+		/* Operators? */
+		case ExprBinary:
+		case ExprUnary:
+		case ExprCall: {
+
+			/* Evaluate it into the active register */
+			if (ParseOperand(pExpr, State, &State->ActiveRegister, 0)) {
+				return -1;
 			}
 
-			/* Set us to solved */
-			pExpr->SetSolved();
+			/* Remember to cleanup */
+			State->GenerateCleanUp = 1;
 
 		} break;
 
-		/* Int Literal? */
-		case ExprInteger: {
+		default: {
 
-			/* Cast to correct expression type */
-			IntValue *Int = (IntValue*)pExpr;
+			/* Error message */
+			printf("Unsupported expression for bytecode generation...\n");
 
-			/* Sanity, don't parse us 
-			 * unless we are asked for non operators */
-			if (Group != OpGroupSingles) {
-				return 0;
-			}
+			/* Error - bail out */
+			return -1;
+		}
+	}
 
-			/* Generate some code */
-			if ((State->IntermediateRegister != -1
-				|| State->ActiveRegister != -1)) {
+	/* No Error */
+	return 0;
+}
 
-				/* Select register */
-				int Register = State->IntermediateRegister;
+/* Evaluates an expression into a register, operators
+ * evaluate their operands into registers of their own
+ * and the result ends up in the register of the one that
+ * is written. Operands that are only read can share the
+ * register a variable is kept in */
+int Generator::ParseOperand(Expression *pExpr, GenState_t *State, int *Register, int ReadOnly) {
 
-				/* Sanity */
-				if (Register == -1)
-					Register = State->ActiveRegister;
+	/* Sanity */
+	if (pExpr == NULL) {
+		printf("Missing operand for bytecode generation...\n");
+		return -1;
+	}
 
-				/* We are working in a temporary register
-				* use appropriate instructions */
-				m_pPool->AddOpcode(State->CodeScopeId, OpStoreRI);
-				m_pPool->AddCode8(State->CodeScopeId, Register);
-				m_pPool->AddCode32(State->CodeScopeId, Int->GetValue());
+	/* Constants are generated as the literal they fold to */
+	pExpr = m_pOptimizer->GetFolded(pExpr);
 
-#ifdef DIAGNOSE
-				printf("storeri $%i, [%i]\n", Register, Int->GetValue());
-#endif
-			}
-			else {
+	/* Determine what kind of expression .. */
+	switch (pExpr->GetType()) {
 
-				/* We are working with a variable reference
-				* use appropriate instructions */
-				m_pPool->AddOpcode(State->CodeScopeId, OpStoreI);
-				m_pPool->AddCode32(State->CodeScopeId, State->ActiveReference);
-				m_pPool->AddCode32(State->CodeScopeId, Int->GetValue());
+		/* Variable ? */
+		case ExprVariable: {
 
-#ifdef DIAGNOSE
-				printf("storei #%i, [%i]\n", State->ActiveReference, Int->GetValue());
-#endif
+			/* Lookup Id, it can be in any 
+			 * of the scopes around us */
+			int Id = m_pPool->ResolveSymbol(((Variable*)pExpr)->GetIdentifier(), State->CodeScopeId);
+
+			/* Variables that are read are kept in their register */
+			if (ReadOnly) {
+				*Register = LookupValue(Id);
+				if (*Register == -1) {
+					*Register = m_pAllocator->CreateRegister();
+					m_pAllocator->EmitRI(OpLoadRA, *Register, Id);
+					SetValue(Id, *Register, State);
+				}
+				break;
 			}
 
-			/* Set us to solved */
-			pExpr->SetSolved();
+			/* The register is written so a kept value is copied */
+			*Register = m_pAllocator->CreateRegister();
+			if (LookupValue(Id) != -1)
+				m_pAllocator->EmitRR(OpStore, *Register, LookupValue(Id));
+			else
+				m_pAllocator->EmitRI(OpLoadRA, *Register, Id);
 
 		} break;
 
-		/* Binary Expression?? */
-		case ExprBinary: {
+		/* String Literal? */
+		case ExprString: {
 
-			/* Cast to correct expression type */
-			BinaryExpression *BinExpr = (BinaryExpression*)pExpr;
+			/* Define it in our data-pool */
+			int Id = m_pPool->DefineString(((StringValue*)pExpr)->GetValue());
 
-			/* Are we in the correct group? */
-			if (Group == OpGroup3
-				&& (BinExpr->GetOperator() == ExprOperatorDivide
-				|| BinExpr->GetOperator() == ExprOperatorMultiply)) {
-				goto ParseUs;
-			}
-			else if (Group == OpGroup4
-				&& (BinExpr->GetOperator() == ExprOperatorAdd
-				|| BinExpr->GetOperator() == ExprOperatorSubtract)) {
-				goto ParseUs;
-			}
-			else {
-				return ParseExpression(BinExpr->GetExpression2(), State, Group);
-			}
+			/* Load it */
+			*Register = m_pAllocator->CreateRegister();
+			m_pAllocator->EmitRI(OpLoadRA, *Register, Id);
 
-		ParseUs:
-			/* Use previous state if there is any */
-			if (State->ActiveRegister == -1) {
+		} break;
 
-				/* Allocate a temporary register 
-				 * for calculations */
-				State->ActiveRegister = AllocateRegister();
+		/* Int Literal? */
+		case ExprInteger: {
 
-				/*************************************
-				 ***** LEFT - HAND - EVALUATION ******
-				 *************************************/
+			/* Values outside 32 bits need the wide opcodes */
+			long long Value = ((IntValue*)pExpr)->GetValue();
 
-				/* First of all, if our left hand is a binary expression
-				 * this means we should calculate our left hand tree before
-				 * proceeding. For that we need a new intermediate state */
-				if (BinExpr->GetExpression1()->GetType() == ExprBinary) {
+			*Register = m_pAllocator->CreateRegister();
+			if (Value < INT_MIN || Value > INT_MAX)
+				m_pAllocator->EmitRW(OpStoreRIW, *Register, Value);
+			else
+				m_pAllocator->EmitRI(OpStoreRI, *Register, (int)Value);
 
-					/* Create a new intermediate state */
-					GenState_t TempEnvironment;
+		} break;
 
-					/* Instantiate it */
-					TempEnvironment.CodeScopeId = State->CodeScopeId;
-					TempEnvironment.IntermediateRegister = -1;
-					TempEnvironment.ActiveReference = -1;
-					TempEnvironment.ActiveRegister = -1;
-					TempEnvironment.GenerateCleanUp = 0;
+		/* Float Literal? */
+		case ExprFloat: {
 
-					/* Parse the left hand */
-					for (int i = 0; i < (int)OperatorGroupCount; i++) {
-						if (ParseExpression(BinExpr->GetExpression1(), &TempEnvironment, (OperatorGroup_t)i))
-							return -1;
-					}
+			/* The value is emitted by its bit pattern */
+			double Value = ((FloatValue*)pExpr)->GetValue();
+			long long Bits = 0;
+			memcpy(&Bits, &Value, sizeof(Bits));
 
-					/* Generate cleanup statement? */
-					if (TempEnvironment.GenerateCleanUp) {
-						m_pPool->AddOpcode(State->CodeScopeId, OpStore);
-						m_pPool->AddCode8(State->CodeScopeId, State->ActiveRegister);
-						m_pPool->AddCode8(State->CodeScopeId, TempEnvironment.ActiveRegister);
+			*Register = m_pAllocator->CreateRegister();
+			m_pAllocator->EmitRW(OpStoreRF, *Register, Bits);
 
-#ifdef DIAGNOSE
-						printf("store #%i, $%i\n", State->ActiveRegister, TempEnvironment.ActiveRegister);
-#endif
+		} break;
 
-						/* Deallocate */
-						DeallocateRegister(TempEnvironment.ActiveRegister);
-					}
+		/* Binary Expression?? */
+		case ExprBinary: {
 
-					/* Mark expression as solved */
-					BinExpr->GetExpression1()->SetSolved();
-				}
-				else {
-					/* Simple stuff actually
-					 * this means we can directly load the left hand value in */
-					if (ParseExpression(BinExpr->GetExpression1(), State, OpGroupSingles)) {
-						return -1;
-					}
-				}
+			/* Cast to correct expression type */
+			BinaryExpression *BinExpr = (BinaryExpression*)pExpr;
+			Expression *Operands[2] = { m_pOptimizer->GetFolded(BinExpr->GetExpression1()), 
+				m_pOptimizer->GetFolded(BinExpr->GetExpression2()) };
+			int Registers[2] = { -1, -1 };
+			int Destination = 0, First = 0;
+			Opcode_t Operation;
+
+			switch (BinExpr->GetOperator()) {
+				case ExprOperatorAdd: Operation = OpAdd; break;
+				case ExprOperatorSubtract: Operation = OpSub; break;
+				case ExprOperatorMultiply: Operation = OpMul; break;
+				case ExprOperatorDivide: Operation = OpDiv; break;
+				default: Operation = OpRem; break;
+			}
 
-				/* Remember to cleanup */
-				State->GenerateCleanUp = 1;
-			}
-
-			/* Allocate an intermediate register */
-			State->IntermediateRegister = AllocateRegister();
-
-			/*************************************
-			 ***** RIGHT - HAND - EVALUATION *****
-			 *************************************/
-
-			/* First of all, if right hand is a binary expression
-			 * we have two cases that can happen, however if it is not
-			 * a binary expression, we have reached end of expression list
-			 * and such it's pretty easy to handle */
-			if (BinExpr->GetExpression2()->GetType() == ExprBinary) {
-				
-				/* For convienance, we need a handle to lower expression
-				 * Cast to correct expression type */
-				BinaryExpression *LowerBinExpr = (BinaryExpression*)BinExpr->GetExpression2();
-
-				/* Now we have two possible cases, either the left hand of
-				 * this expression is actually ALSO a binary expression,
-				 * in which case we actually need to parse it */
-				if (LowerBinExpr->GetExpression1()->GetType() == ExprBinary) {
-					
-					/* Create a temporary environment */
-					GenState_t TempEnvironment;
-
-					/* Deallocate the intermediate register */
-					DeallocateRegister(State->IntermediateRegister);
-
-					/* Instantiate it */
-					TempEnvironment.CodeScopeId = State->CodeScopeId;
-					TempEnvironment.IntermediateRegister = -1;
-					TempEnvironment.ActiveReference = -1;
-					TempEnvironment.ActiveRegister = -1;
-					TempEnvironment.GenerateCleanUp = 0;
-
-					/* Parse the left hand */
-					for (int i = 0; i < (int)OperatorGroupCount; i++) {
-						if (ParseExpression(LowerBinExpr->GetExpression1(), &TempEnvironment, (OperatorGroup_t)i))
-							return -1;
-					}
-
-					/* Update the new intermediate */
-					State->IntermediateRegister = TempEnvironment.ActiveRegister;
-
-					/* Mark expression as solved, skip it forever */
-					LowerBinExpr->GetExpression1()->SetSolved();
-				}
-				else {
-					/* Or, it's simply a single expression in which case it's pretty easy */
-					if (ParseExpression(LowerBinExpr->GetExpression1(), State, OpGroupSingles)) {
-						return -1;
-					}
-				}
+			/* Sanity */
+			if (Operands[0] == NULL || Operands[1] == NULL) {
+				printf("Missing operand for bytecode generation...\n");
+				return -1;
+			}
+
+			/* The operand that needs the most registers is
+			 * evaluated first, so the result of the other is
+			 * not held meanwhile. Calls keep their order */
+			ExpressionLabel_t Left = LabelExpression(Operands[0]);
+			ExpressionLabel_t Right = LabelExpression(Operands[1]);
+			if (!Left.Calls && !Right.Calls && Right.Need > Left.Need) {
+				First = 1;
+			}
+
+			/* The result ends up in the register of the left
+			 * operand, so it is written. Multiplication and the
+			 * addition of numbers commute, a variable on the left
+			 * is then only read when the right one is an operator */
+			if ((Operation == OpMul || (Operation == OpAdd && (Left.Numeric || Right.Numeric)))
+				&& Operands[0]->GetType() == ExprVariable
+				&& (Operands[1]->GetType() == ExprBinary
+					|| Operands[1]->GetType() == ExprUnary
+					|| Operands[1]->GetType() == ExprCall)) {
+				Destination = 1;
 			}
-			else {
-				/* Ok, end of chain, load second into intermediate 
-				 * generate the last statements */
-				if (ParseExpression(BinExpr->GetExpression2(), State, OpGroupSingles)) {
+
+			/* Evaluate both operands */
+			for (int i = 0; i < 2; i++) {
+				int Index = (First + i) % 2;
+				if (ParseOperand(Operands[Index], State, &Registers[Index], Index != Destination)) {
 					return -1;
 				}
 			}
 
-			/*************************************
-			 ****** OPERATOR CODE APPENDUM *******
-			 *************************************/
+			/* Generate the operator */
+			m_pAllocator->EmitRR(Operation, Registers[Destination], Registers[1 - Destination]);
+			*Register = Registers[Destination];
 
-			/* Generate code for both active 
-			 * intermediate code */
-			if (BinExpr->GetOperator() == ExprOperatorAdd) {
-				m_pPool->AddOpcode(State->CodeScopeId, OpAdd);
-				m_pPool->AddCode8(State->CodeScopeId, State->ActiveRegister);
-				m_pPool->AddCode8(State->CodeScopeId, State->IntermediateRegister);
+		} break;
 
-#ifdef DIAGNOSE
-				printf("add $%i, $%i\n", State->ActiveRegister, State->IntermediateRegister);
-#endif
-			}
-			else if (BinExpr->GetOperator() == ExprOperatorSubtract) {
-				m_pPool->AddOpcode(State->CodeScopeId, OpSub);
-				m_pPool->AddCode8(State->CodeScopeId, State->ActiveRegister);
-				m_pPool->AddCode8(State->CodeScopeId, State->IntermediateRegister);
+		/* Unary Expression? */
+		case ExprUnary: {
 
-#ifdef DIAGNOSE
-				printf("sub $%i, $%i\n", State->ActiveRegister, State->IntermediateRegister);
-#endif
+			/* Evaluate the operand, it is only read */
+			int Operand = -1;
+			if (ParseOperand(((UnaryExpression*)pExpr)->GetExpression(), State, &Operand, 1)) {
+				return -1;
 			}
-			else if (BinExpr->GetOperator() == ExprOperatorMultiply) {
-				m_pPool->AddOpcode(State->CodeScopeId, OpMul);
-				m_pPool->AddCode8(State->CodeScopeId, State->ActiveRegister);
-				m_pPool->AddCode8(State->CodeScopeId, State->IntermediateRegister);
 
-#ifdef DIAGNOSE
-				printf("mul $%i, $%i\n", State->ActiveRegister, State->IntermediateRegister);
-#endif
+			/* Negation is done as 0 - operand */
+			*Register = m_pAllocator->CreateRegister();
+			m_pAllocator->EmitRI(OpStoreRI, *Register, 0);
+			m_pAllocator->EmitRR(OpSub, *Register, Operand);
+
+		} break;
+
+		/* Call Expression? */
+		case ExprCall: {
+
+			/* Cast to correct expression type */
+			CallExpression *CallExpr = (CallExpression*)pExpr;
+			int Count = (int)CallExpr->GetArgumentCount();
+
+			/* Lookup the function, it can be in 
+			 * any of the scopes around us */
+			int Id = m_pPool->ResolveSymbol(CallExpr->GetIdentifier(), State->CodeScopeId);
+
+			/* Sanity */
+			if (Id == -1 || m_pPool->GetObject(Id)->GetType() != CTFunction) {
+				printf("Unable to find function with name %s...\n", m_pSymbols->GetName(CallExpr->GetIdentifier()));
+				return -1;
 			}
-			else if (BinExpr->GetOperator() == ExprOperatorDivide) {
-				m_pPool->AddOpcode(State->CodeScopeId, OpDiv);
-				m_pPool->AddCode8(State->CodeScopeId, State->ActiveRegister);
-				m_pPool->AddCode8(State->CodeScopeId, State->IntermediateRegister);
 
-#ifdef DIAGNOSE
-				printf("div $%i, $%i\n", State->ActiveRegister, State->IntermediateRegister);
-#endif
+			/* The arity is fixed */
+			if (m_pPool->GetObject(Id)->GetArgumentCount() != Count) {
+				printf("Function %s takes %i arguments, %i given...\n", m_pSymbols->GetName(CallExpr->GetIdentifier()),
+					m_pPool->GetObject(Id)->GetArgumentCount(), Count);
+				return -1;
 			}
 
-			/* Free the intermediate */
-			DeallocateRegister(State->IntermediateRegister);
-			State->IntermediateRegister = -1;
+			/* The arguments are passed in consecutive registers */
+			if (Count > m_pAllocator->GetRegisterCount()) {
+				printf("Function %s takes %i arguments, only %i registers are available...\n", 
+					m_pSymbols->GetName(CallExpr->GetIdentifier()), Count, m_pAllocator->GetRegisterCount());
+				return -1;
+			}
 
-			/* Recursive down */
-			if (BinExpr->GetExpression2()->GetType() == ExprBinary) {
-				if (ParseExpression(BinExpr->GetExpression2(), State, Group)) {
+			/* Evaluate the arguments in order, the allocator 
+			 * moves them into place for the call, which only
+			 * reads them */
+			std::vector<int> Arguments(Count);
+			for (int i = 0; i < Count; i++) {
+				if (ParseOperand(CallExpr->GetArgument(i), State, &Arguments[i], 1)) {
 					return -1;
 				}
 			}
 
+			/* Generate the call, the result is in a new register */
+			*Register = m_pAllocator->CreateRegister();
+			m_pAllocator->EmitCall(*Register, Id, (Count == 0) ? NULL : &Arguments[0], Count);
+
 		} break;
 
 		default: {
@@ -841,3 +1110,76 @@ int Generator::ParseExpression(Expression *pExpr, GenState_t *State, OperatorGro
 	/* No Error */
 	return 0;
 }
+
+/* Labels an expression with the number of registers
+ * needed to evaluate it. Operands are held in a register
+ * each, when both sides need the same the result of the
+ * first is held while the other is evaluated. A call needs
+ * the block its arguments are passed in. The labels are
+ * kept in a hash table, so every node is labeled once */
+ExpressionLabel_t Generator::LabelExpression(Expression *pExpr) {
+
+	/* Constants are labeled as the literal they fold to */
+	pExpr = m_pOptimizer->GetFolded(pExpr);
+
+	/* Labeled already? */
+	std::unordered_map<Expression*, ExpressionLabel_t>::iterator Known = m_sLabels.find(pExpr);
+	if (Known != m_sLabels.end()) {
+		return Known->second;
+	}
+
+	/* Values need the register they are loaded in */
+	ExpressionLabel_t Label;
+	Label.Need = 1;
+	Label.Calls = 0;
+	Label.Numeric = 0;
+
+	/* Sanity */
+	if (pExpr == NULL) {
+		return Label;
+	}
+
+	switch (pExpr->GetType()) {
+		case ExprInteger:
+		case ExprFloat: {
+			Label.Numeric = 1;
+		} break;
+
+		case ExprUnary: {
+			ExpressionLabel_t Operand = LabelExpression(((UnaryExpression*)pExpr)->GetExpression());
+			Label.Need = std::max(Operand.Need, 2);
+			Label.Calls = Operand.Calls;
+			Label.Numeric = 1;
+		} break;
+
+		case ExprBinary: {
+			BinaryExpression *BinExpr = (BinaryExpression*)pExpr;
+			ExpressionLabel_t Left = LabelExpression(BinExpr->GetExpression1());
+			ExpressionLabel_t Right = LabelExpression(BinExpr->GetExpression2());
+			Label.Need = (Left.Need == Right.Need) ? Left.Need + 1 : std::max(Left.Need, Right.Need);
+			Label.Calls = Left.Calls || Right.Calls;
+
+			/* Strings are only ever added */
+			Label.Numeric = (BinExpr->GetOperator() != ExprOperatorAdd)
+				|| Left.Numeric || Right.Numeric;
+		} break;
+
+		case ExprCall: {
+			CallExpression *CallExpr = (CallExpression*)pExpr;
+			int Count = (int)CallExpr->GetArgumentCount();
+
+			/* The arguments before are held */
+			Label.Need = std::max(Count, 1);
+			Label.Calls = 1;
+			for (int i = 0; i < Count; i++) {
+				Label.Need = std::max(Label.Need, LabelExpression(CallExpr->GetArgument(i)).Need + i);
+			}
+		} break;
+
+		default:
+			break;
+	}
+
+	m_sLabels[pExpr] = Label;
+	return Label;
+}
@@ -24,15 +24,24 @@
 
 #include <cstring>
 #include <cstdlib>
+#include <map>
+#include <unordered_map>
 
-#define MACIA_REGISTER_COUNT	4
+/* The generated code is traced unless 
+ * the build turns it off */
+#ifndef MACIA_NO_DIAGNOSE
 #define DIAGNOSE
+#endif
+
 #define VERSION "0.0.1-dev"
 #define AUTHOR	"Philip Meulengracht"
 
 /* System Includes */
 #include "../parser/parser.h"
 #include "../shared/datapool.h"
+#include "../shared/arena.h"
+#include "optimizer.h"
+#include "registerallocator.h"
 
 /* This is the generator state 
  * structure that holds information 
@@ -47,7 +56,6 @@ typedef struct {
 	/* This contains things 
 	 * as active register */
 	int ActiveRegister;
-	int IntermediateRegister;
 	int ActiveReference;
 
 	/* If we need cleanup for this
@@ -56,43 +64,45 @@ typedef struct {
 
 } GenState_t;
 
-/* Expression precedence groups */
-typedef enum {
-
-	/* Group 1:
-	 * ++ (suffix), -- (suffix), func(),
-	 * arr[], '.' obj access */
-	OpGroup1,
-
-	/* Group 2:
-	 * ++ (prefix), -- (prefix),
-	 * + (unary), - (unary) */
-	OpGroup2,
-
-	/* Group 3:
-	 * '*, '/', '%' */
-	OpGroup3,
+/* This is the label of an expression, 
+ * it decides the order its operands are 
+ * evaluated in */
+typedef struct {
 
-	/* Group 4:
-	 * + (add), - (sub) */
-	OpGroup4,
+	/* The number of registers needed 
+	 * to evaluate it (Sethi-Ullman) */
+	int Need;
 
-	/* Singles */
-	OpGroupSingles,
+	/* If a function is called somewhere
+	 * in it, the order must then be kept */
+	int Calls;
 
-	/* Used for iteration */
-	OperatorGroupCount
+	/* If it is known to be a number, 
+	 * and not a string */
+	int Numeric;
 
-} OperatorGroup_t;
+} ExpressionLabel_t;
 
 /* The generation-class
  * Converts AST into IL Bytecode */
 class Generator
 {
 public:
-	Generator(Statement *AST);
+	Generator(Statement *AST, SymbolTable *Symbols);
 	~Generator();
 
+	/* Adds the AST of another compilation unit,
+	 * all units are generated into the same program */
+	void AddProgram(Statement *AST);
+
+	/* Adds a directory to search for the modules 
+	 * of imported namespaces, in the order added */
+	void AddModulePath(const char *pPath);
+
+	/* Sets the number of physical registers the code 
+	 * is allocated for, returns -1 if it is out of range */
+	int SetRegisterCount(int Count) { return m_pAllocator->SetRegisterCount(Count); }
+
 	/* Generate the bytecode from the AST,
 	 * can be assembled or interpreted afterwards */
 	int Generate();
@@ -102,6 +112,11 @@ public:
 	 * or run by the interpreter */
 	int SaveAs(const char *Path);
 
+	/* Save every namespace as a module of its own
+	 * in the given directory, so other programs can
+	 * import it without compiling the source again */
+	int SaveModules(const char *pDirectory);
+
 	/* Gets */
 	std::vector<unsigned char> &GetCode() { return m_lByteCode; }
 	std::vector<unsigned char> &GetData() { return m_lByteData; }
@@ -109,18 +124,29 @@ public:
 
 private:
 	/* Private - Functions */
+	int DeclareFunctions(Statement *pBody, int ScopeId);
 	int ParseStatement(Statement *pStmt, int ScopeId);
 	int ParseExpressions(Expression *pExpr, GenState_t *State);
-	int ParseExpression(Expression *pExpr, GenState_t *State, OperatorGroup_t Group);
-	int AllocateRegister();
-	void DeallocateRegister(int Register);
+	int ParseExpression(Expression *pExpr, GenState_t *State);
+	int ParseOperand(Expression *pExpr, GenState_t *State, int *Register, int ReadOnly);
+	ExpressionLabel_t LabelExpression(Expression *pExpr);
+	int LookupValue(int Id);
+	void SetValue(int Id, int Register, GenState_t *State);
 
 	void GenerateEntry();
+	void SerializeObject(int Id, CodeObject *Obj, 
+		std::vector<unsigned char> &Code, std::vector<unsigned char> &Data);
 
 	/* Private - Data */
 	std::vector<unsigned char> m_lByteCode;
 	std::vector<unsigned char> m_lByteData;
-	std::map<int, int> m_sRegisters;
-	Statement *m_pAST;
+	std::map<int, int> m_sValues;
+	std::unordered_map<Expression*, ExpressionLabel_t> m_sLabels;
+	std::vector<Statement*> m_lPrograms;
+	std::vector<const char*> m_lModulePaths;
+	SymbolTable *m_pSymbols;
 	DataPool *m_pPool;
+	Arena *m_pArena;
+	Optimizer *m_pOptimizer;
+	RegisterAllocator *m_pAllocator;
 };
\ No newline at end of file
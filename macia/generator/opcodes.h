@@ -50,9 +50,21 @@ typedef enum {
 	OpDivRA,					//(6) divra #id, $
 	OpSub,						//(3) sub $, $
 	OpSubRA,					//(6) subra #id, $
-	OpRem,						//(3) rem $
-	OpRemRA,					//(6) remra $
+	OpRem,						//(3) rem $, $
+	OpRemRA,					//(6) remra #id, $
 	OpMul,						//(3) mul $, $
-	OpMulRA						//(6) mulra #id, $
+	OpMulRA,					//(6) mulra #id, $
+
+	/* Wide Store Opcodes, for integers that need 
+	 * more than 32 bits and for doubles */
+	OpStoreIW,					//(13) storeiw #id, [val64]
+	OpStoreRIW,					//(10) storeriw $, [val64]
+	OpStoreF,					//(13) storef #id, [double]
+	OpStoreRF,					//(10) storerf $, [double]
+
+	/* Calls with a fixed number of arguments, they are
+	 * in the consecutive registers starting at $ and become
+	 * the first variables of the callee. The result is in $ */
+	OpInvokeR					//(7) invoker $, #id, count
 
 } Opcode_t;
\ No newline at end of file
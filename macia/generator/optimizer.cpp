@@ -0,0 +1,206 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - AST Optimizer
+* - Folds constant sub-expressions before code is generated
+*/
+
+/* Includes */
+#include "optimizer.h"
+
+/* Constructor
+ * Takes the arena the folded literals are created in */
+Optimizer::Optimizer(Arena *pArena) {
+	m_pArena = pArena;
+	m_iFolded = 0;
+	m_iNodes = 0;
+	m_iLargest = 0;
+}
+
+/* Folds the expressions of all statements,
+ * the new literals are kept in the arena */
+void Optimizer::Optimize(Statement *pStmt) {
+
+	/* Sanity */
+	if (pStmt == NULL)
+		return;
+
+	switch (pStmt->GetType()) {
+		case StmtSequence: {
+			Sequence *Seq = (Sequence*)pStmt;
+			for (size_t i = 0; i < Seq->GetCount(); i++) {
+				Optimize(Seq->GetStatement(i));
+			}
+		} break;
+		case StmtNamespace: {
+			Optimize(((Namespace*)pStmt)->GetBody());
+		} break;
+		case StmtObject: {
+			Optimize(((Object*)pStmt)->GetBody());
+		} break;
+		case StmtFunction: {
+			Optimize(((Function*)pStmt)->GetBody());
+		} break;
+		case StmtDeclaration: {
+			FoldStatement(((Declaration*)pStmt)->GetExpression());
+		} break;
+		case StmtAssign: {
+			FoldStatement(((Assignment*)pStmt)->GetExpression());
+		} break;
+		case StmtCall: {
+			FoldStatement(((Call*)pStmt)->GetCall());
+		} break;
+		default:
+			break;
+	}
+}
+
+/* Folds the expression of a statement, and keeps 
+ * track of the largest number of nodes in one */
+void Optimizer::FoldStatement(Expression *pExpr) {
+	m_iNodes = 0;
+	Fold(pExpr);
+	if (m_iNodes > m_iLargest) {
+		m_iLargest = m_iNodes;
+	}
+}
+
+/* Folds an expression bottom-up, returns the 
+ * expression that replaces it, which is either 
+ * a new literal or the expression itself. New
+ * literals are stored in the table */
+Expression *Optimizer::Fold(Expression *pExpr) {
+
+	/* Variables */
+	Expression *Result = pExpr;
+
+	/* Sanity */
+	if (pExpr == NULL)
+		return NULL;
+
+	/* Folded before? */
+	m_iNodes++;
+	if (GetFolded(pExpr) != pExpr) {
+		return GetFolded(pExpr);
+	}
+
+	switch (pExpr->GetType()) {
+		case ExprBinary: {
+			BinaryExpression *BinExpr = (BinaryExpression*)pExpr;
+			Expression *Left = Fold(BinExpr->GetExpression1());
+			Expression *Right = Fold(BinExpr->GetExpression2());
+			Result = FoldBinary(BinExpr, Left, Right);
+		} break;
+		case ExprUnary: {
+			Expression *Operand = Fold(((UnaryExpression*)pExpr)->GetExpression());
+
+			/* Negation wraps like subtraction from 0 */
+			if (Operand != NULL && Operand->GetType() == ExprInteger) {
+				unsigned long long Value = (unsigned long long)((IntValue*)Operand)->GetValue();
+				m_iFolded++;
+				Result = new (m_pArena) IntValue((long long)(0ULL - Value));
+			}
+		} break;
+		case ExprCall: {
+			CallExpression *CallExpr = (CallExpression*)pExpr;
+			for (size_t i = 0; i < CallExpr->GetArgumentCount(); i++) {
+				Fold(CallExpr->GetArgument(i));
+			}
+		} break;
+		default:
+			break;
+	}
+
+	if (Result != pExpr) {
+		m_sFolded[pExpr] = Result;
+	}
+	return Result;
+}
+
+/* Folds a binary expression from its folded operands, 
+ * the expression is kept unless both are literals 
+ * of a type the operator can be evaluated for */
+Expression *Optimizer::FoldBinary(BinaryExpression *pExpr, Expression *Left, Expression *Right) {
+
+	/* Sanity */
+	if (Left == NULL || Right == NULL)
+		return pExpr;
+
+	/* Integers, the arithmetic is done unsigned 
+	 * so overflows wrap instead of being undefined */
+	if (Left->GetType() == ExprInteger && Right->GetType() == ExprInteger) {
+		long long A = ((IntValue*)Left)->GetValue();
+		long long B = ((IntValue*)Right)->GetValue();
+		unsigned long long Result;
+
+		switch (pExpr->GetOperator()) {
+			case ExprOperatorAdd: 
+				Result = (unsigned long long)A + (unsigned long long)B; 
+				break;
+			case ExprOperatorSubtract: 
+				Result = (unsigned long long)A - (unsigned long long)B; 
+				break;
+			case ExprOperatorMultiply: 
+				Result = (unsigned long long)A * (unsigned long long)B; 
+				break;
+			case ExprOperatorDivide:
+			case ExprOperatorRemainder: {
+
+				/* Division by zero happens at runtime */
+				if (B == 0) {
+					return pExpr;
+				}
+
+				/* The one quotient that doesn't fit wraps 
+				 * to itself, and leaves no remainder */
+				if (B == -1) {
+					Result = (pExpr->GetOperator() == ExprOperatorDivide) ? 
+						(0ULL - (unsigned long long)A) : 0;
+				}
+				else {
+					Result = (unsigned long long)((pExpr->GetOperator() == ExprOperatorDivide) ? 
+						(A / B) : (A % B));
+				}
+			} break;
+			default:
+				return pExpr;
+		}
+
+		m_iFolded++;
+		return new (m_pArena) IntValue((long long)Result);
+	}
+
+	/* Strings are only concatenated */
+	if (Left->GetType() == ExprString && Right->GetType() == ExprString
+		&& pExpr->GetOperator() == ExprOperatorAdd) {
+		const char *A = ((StringValue*)Left)->GetValue();
+		const char *B = ((StringValue*)Right)->GetValue();
+		size_t LengthA = strlen(A), LengthB = strlen(B);
+		char *Text = (char*)m_pArena->Allocate(LengthA + LengthB + 1);
+
+		if (Text == NULL) {
+			throw std::bad_alloc();
+		}
+		memcpy(Text, A, LengthA);
+		memcpy(Text + LengthA, B, LengthB + 1);
+
+		m_iFolded++;
+		return new (m_pArena) StringValue(Text);
+	}
+	return pExpr;
+}
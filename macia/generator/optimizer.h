@@ -0,0 +1,71 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - AST Optimizer
+* - Folds constant sub-expressions before code is generated
+*/
+#pragma once
+
+/* Includes */
+#include "../parser/parser.h"
+#include "../shared/arena.h"
+#include <unordered_map>
+
+/* The optimizer class
+ * Walks the AST and finds the literal that operators on 
+ * literals evaluate to. Integers are 64 bit and wrap around 
+ * in two's complement, division truncates towards zero and 
+ * divisions by zero are left for the runtime. Strings are 
+ * concatenated by '+'. The AST is left as it is, the folded
+ * literals are kept in a table next to it */
+class Optimizer
+{
+public:
+	Optimizer(Arena *pArena);
+
+	/* Folds the expressions of all statements,
+	 * the new literals are kept in the arena */
+	void Optimize(Statement *pStmt);
+
+	/* Gets the literal an expression was folded
+	 * into, or the expression itself */
+	Expression *GetFolded(Expression *pExpr) {
+		if (m_sFolded.empty()) {
+			return pExpr;
+		}
+		std::unordered_map<Expression*, Expression*>::iterator Folded = m_sFolded.find(pExpr);
+		return (Folded == m_sFolded.end()) ? pExpr : Folded->second;
+	}
+
+	/* Gets */
+	size_t GetFoldCount() { return m_iFolded; }
+	size_t GetLargestExpression() { return m_iLargest; }
+
+private:
+	/* Private - Functions */
+	Expression *Fold(Expression *pExpr);
+	Expression *FoldBinary(BinaryExpression *pExpr, Expression *Left, Expression *Right);
+	void FoldStatement(Expression *pExpr);
+
+	/* Private - Data */
+	std::unordered_map<Expression*, Expression*> m_sFolded;
+	Arena *m_pArena;
+	size_t m_iFolded;
+	size_t m_iNodes;
+	size_t m_iLargest;
+};
@@ -0,0 +1,845 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+* Macia - Register Allocator
+* - Maps the virtual registers of generated code onto the
+*   physical register file
+*/
+
+/* Includes */
+#include "registerallocator.h"
+#include <algorithm>
+#include <map>
+#include <cstdio>
+#include <cstring>
+
+/* The generated code is traced unless 
+ * the build turns it off */
+#ifndef MACIA_NO_DIAGNOSE
+#define DIAGNOSE
+#endif
+
+/* Constructor
+ * The register file has the default size */
+RegisterAllocator::RegisterAllocator(DataPool *pPool) {
+	m_pPool = pPool;
+	m_iRegisterCount = MACIA_REGISTER_COUNT;
+	m_iScopeId = -1;
+	m_iVirtualCount = 0;
+	m_iSlotCount = 0;
+}
+
+/* Destructor
+ * Nothing is owned besides the lists */
+RegisterAllocator::~RegisterAllocator() {
+	m_lInstructions.clear();
+	m_lArguments.clear();
+}
+
+/* Sets the size of the physical register file, spilled 
+ * operands are loaded into registers for the instruction */
+int RegisterAllocator::SetRegisterCount(int Count) {
+	if (Count < MACIA_REGISTER_MIN || Count > MACIA_REGISTER_MAX) {
+		return -1;
+	}
+	m_iRegisterCount = Count;
+	return 0;
+}
+
+/* Starts the code of a scope, the virtual 
+ * registers are numbered from zero again */
+void RegisterAllocator::Begin(int ScopeId) {
+	m_lInstructions.clear();
+	m_lArguments.clear();
+	m_lSlots.clear();
+	m_iScopeId = ScopeId;
+	m_iVirtualCount = 0;
+	m_iSlotCount = 0;
+}
+
+/* Appends an instruction to the code of the scope */
+void RegisterAllocator::Emit(Opcode_t Opcode, int Register1, int Register2, 
+	int Value1, long long Value2) {
+	Instruction_t Instruction;
+
+	Instruction.Opcode = Opcode;
+	Instruction.Register1 = Register1;
+	Instruction.Register2 = Register2;
+	Instruction.Value1 = Value1;
+	Instruction.Value2 = Value2;
+	Instruction.Arguments = 0;
+	m_lInstructions.push_back(Instruction);
+}
+
+/* Instructions */
+void RegisterAllocator::EmitRR(Opcode_t Opcode, int Register1, int Register2) {
+	Emit(Opcode, Register1, Register2, 0, 0);
+}
+
+void RegisterAllocator::EmitRI(Opcode_t Opcode, int Register, int Value) {
+	Emit(Opcode, Register, -1, Value, 0);
+}
+
+void RegisterAllocator::EmitIR(Opcode_t Opcode, int Value, int Register) {
+	Emit(Opcode, Register, -1, Value, 0);
+}
+
+void RegisterAllocator::EmitII(Opcode_t Opcode, int Value1, int Value2) {
+	Emit(Opcode, -1, -1, Value1, Value2);
+}
+
+void RegisterAllocator::EmitRW(Opcode_t Opcode, int Register, long long Value) {
+	Emit(Opcode, Register, -1, 0, Value);
+}
+
+void RegisterAllocator::EmitIW(Opcode_t Opcode, int Value1, long long Value2) {
+	Emit(Opcode, -1, -1, Value1, Value2);
+}
+
+/* Calls the function with the arguments in the given registers,
+ * the result is defined in its own register */
+void RegisterAllocator::EmitCall(int Result, int Id, const int *pArguments, int Count) {
+	Emit(OpInvokeR, Result, -1, Id, Count);
+	m_lInstructions.back().Arguments = m_lArguments.size();
+	for (int i = 0; i < Count; i++) {
+		m_lArguments.push_back(pArguments[i]);
+	}
+}
+
+/* Gets the number of registers an instruction uses, 
+ * they are always the first register operands */
+static int GetRegisterOperands(Opcode_t Opcode) {
+	switch (Opcode) {
+		case OpStore:
+		case OpAdd:
+		case OpSub:
+		case OpMul:
+		case OpDiv:
+		case OpRem:
+			return 2;
+		case OpNew:
+		case OpInvoke:
+		case OpInvokeR:
+		case OpStoreAR:
+		case OpStoreRI:
+		case OpStoreRIW:
+		case OpStoreRF:
+		case OpLoadRA:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+/* Extends the live range of a register to the instruction */
+static void Touch(LiveInterval_t *pInterval, int Position) {
+	if (pInterval->Start == -1) {
+		pInterval->Start = Position;
+	}
+	pInterval->End = Position;
+}
+
+/* Builds the live range of every virtual register, the
+ * code is straight so the ranges are exact. The arguments 
+ * of calls are hinted towards their argument register */
+void RegisterAllocator::BuildIntervals() {
+	LiveInterval_t Empty = { -1, -1, 0, -1, -1, -1, -1, -1 };
+
+	m_lIntervals.assign(m_iVirtualCount, Empty);
+	for (size_t i = 0; i < m_lInstructions.size(); i++) {
+		Instruction_t *Instruction = &m_lInstructions[i];
+		int Operands = GetRegisterOperands(Instruction->Opcode);
+
+		/* The arguments are used before the result is defined */
+		if (Instruction->Opcode == OpInvokeR) {
+			for (int j = 0; j < (int)Instruction->Value2; j++) {
+				LiveInterval_t *Argument = &m_lIntervals[m_lArguments[Instruction->Arguments + j]];
+				Touch(Argument, (int)i);
+				if (Argument->Hint == -1) {
+					Argument->Hint = j;
+				}
+			}
+			m_lIntervals[Instruction->Register1].Hint = 0;
+		}
+
+		if (Operands >= 1) {
+			Touch(&m_lIntervals[Instruction->Register1], (int)i);
+		}
+		if (Operands == 2) {
+			Touch(&m_lIntervals[Instruction->Register2], (int)i);
+		}
+	}
+
+	/* The scan goes by start */
+	std::vector<std::pair<int, int> > Starts;
+	for (int i = 0; i < m_iVirtualCount; i++) {
+		if (m_lIntervals[i].Start != -1) {
+			Starts.push_back(std::make_pair(m_lIntervals[i].Start, i));
+		}
+	}
+	std::sort(Starts.begin(), Starts.end());
+
+	m_lOrder.clear();
+	for (size_t i = 0; i < Starts.size(); i++) {
+		m_lOrder.push_back(Starts[i].second);
+	}
+}
+
+/* Registers that are only loaded from a variable, which is not written
+ * while they live, are spilled to that variable instead of a slot. The
+ * variables outside of the function can also be written by calls */
+void RegisterAllocator::FindHomes() {
+	std::map<int, std::vector<int> > Writes;
+	std::vector<int> Definitions(m_iVirtualCount, 0);
+	std::vector<int> Calls;
+
+	for (size_t i = 0; i < m_lInstructions.size(); i++) {
+		Instruction_t *Instruction = &m_lInstructions[i];
+
+		switch (Instruction->Opcode) {
+			case OpStoreAR:
+			case OpLoadA:
+			case OpStoreI:
+			case OpStoreIW:
+			case OpStoreF:
+				Writes[Instruction->Value1].push_back((int)i);
+				break;
+			case OpInvoke:
+				Calls.push_back((int)i);
+				break;
+			case OpInvokeR:
+				Calls.push_back((int)i);
+				Definitions[Instruction->Register1]++;
+				break;
+			case OpLoadRA:
+				if (m_lIntervals[Instruction->Register1].Start == (int)i) {
+					m_lIntervals[Instruction->Register1].Home = Instruction->Value1;
+				}
+				Definitions[Instruction->Register1]++;
+				break;
+			default:
+				if (GetRegisterOperands(Instruction->Opcode) >= 1) {
+					Definitions[Instruction->Register1]++;
+				}
+				break;
+		}
+	}
+
+	for (int i = 0; i < m_iVirtualCount; i++) {
+		LiveInterval_t *Interval = &m_lIntervals[i];
+		std::vector<int> *Positions;
+
+		if (Interval->Home == -1) {
+			continue;
+		}
+		if (Definitions[i] != 1) {
+			Interval->Home = -1;
+			continue;
+		}
+
+		/* Written in between? */
+		Positions = &Writes[Interval->Home];
+		if (std::upper_bound(Positions->begin(), Positions->end(), Interval->Start) 
+			!= std::lower_bound(Positions->begin(), Positions->end(), Interval->End)) {
+			Interval->Home = -1;
+			continue;
+		}
+
+		/* Called in between? */
+		if (m_pPool->GetObject(Interval->Home)->GetScopeId() != m_iScopeId
+			&& std::upper_bound(Calls.begin(), Calls.end(), Interval->Start) 
+			!= std::lower_bound(Calls.begin(), Calls.end(), Interval->End)) {
+			Interval->Home = -1;
+		}
+	}
+}
+
+/* A call overwrites the registers from $0 up to its argument count, 
+ * so registers that live across it must stay above them. The largest
+ * count within each range is looked up in a sparse table of the calls */
+void RegisterAllocator::LimitIntervals() {
+	std::vector<int> Positions;
+	std::vector<std::vector<int> > Table(1);
+
+	for (size_t i = 0; i < m_lInstructions.size(); i++) {
+		if (m_lInstructions[i].Opcode == OpInvokeR) {
+			Positions.push_back((int)i);
+			Table[0].push_back(std::max((int)m_lInstructions[i].Value2, 1));
+		}
+	}
+
+	/* No calls? */
+	if (Positions.empty()) {
+		return;
+	}
+
+	/* Level k holds the largest count of 2^k calls */
+	for (size_t k = 1; ((size_t)1 << k) <= Positions.size(); k++) {
+		size_t Half = (size_t)1 << (k - 1);
+		Table.push_back(std::vector<int>(Positions.size() - (2 * Half) + 1));
+		for (size_t j = 0; j < Table[k].size(); j++) {
+			Table[k][j] = std::max(Table[k - 1][j], Table[k - 1][j + Half]);
+		}
+	}
+
+	for (size_t i = 0; i < m_lOrder.size(); i++) {
+		LiveInterval_t *Interval = &m_lIntervals[m_lOrder[i]];
+		size_t First = std::upper_bound(Positions.begin(), Positions.end(), Interval->Start) - Positions.begin();
+		size_t Last = std::lower_bound(Positions.begin(), Positions.end(), Interval->End) - Positions.begin();
+		size_t k = 0;
+
+		if (First >= Last) {
+			continue;
+		}
+		while (((size_t)2 << k) <= Last - First) {
+			k++;
+		}
+		Interval->Limit = std::max(Table[k][First], Table[k][Last - ((size_t)1 << k)]);
+	}
+}
+
+/* The linear scan, the ranges are visited by start and given a free
+ * register. When there is none, the range that ends last is spilled */
+void RegisterAllocator::Scan() {
+	std::vector<int> Active;
+	bool Used[MACIA_REGISTER_MAX];
+
+	std::fill(&Used[0], &Used[MACIA_REGISTER_MAX], false);
+	for (size_t i = 0; i < m_lOrder.size(); i++) {
+		LiveInterval_t *Current = &m_lIntervals[m_lOrder[i]];
+		int Register = -1;
+		size_t Expired = 0;
+
+		/* Free the registers of ranges that ended, a range
+		 * may end at the instruction that starts the next */
+		while (Expired < Active.size() && m_lIntervals[Active[Expired]].End <= Current->Start) {
+			Used[m_lIntervals[Active[Expired]].Physical] = false;
+			Expired++;
+		}
+		Active.erase(Active.begin(), Active.begin() + Expired);
+
+		/* Take the hinted register, or the lowest free */
+		if (Current->Hint >= Current->Limit && Current->Hint < m_iRegisterCount 
+			&& !Used[Current->Hint]) {
+			Register = Current->Hint;
+		}
+		for (int j = Current->Limit; Register == -1 && j < m_iRegisterCount; j++) {
+			if (!Used[j]) {
+				Register = j;
+			}
+		}
+
+		/* Spill the range that ends last, and whose 
+		 * register we may use */
+		if (Register == -1) {
+			int Victim = -1;
+			for (size_t j = Active.size(); j-- > 0;) {
+				if (m_lIntervals[Active[j]].Physical >= Current->Limit) {
+					Victim = (int)j;
+					break;
+				}
+			}
+
+			if (Victim == -1 || m_lIntervals[Active[Victim]].End <= Current->End) {
+				Current->Physical = -1;
+				continue;
+			}
+
+			Register = m_lIntervals[Active[Victim]].Physical;
+			m_lIntervals[Active[Victim]].Physical = -1;
+			Active.erase(Active.begin() + Victim);
+		}
+
+		/* Keep the active ranges sorted by end */
+		Current->Physical = Register;
+		Used[Register] = true;
+		size_t Position = Active.size();
+		while (Position > 0 && m_lIntervals[Active[Position - 1]].End > Current->End) {
+			Position--;
+		}
+		Active.insert(Active.begin() + Position, m_lOrder[i]);
+	}
+}
+
+/* Gets the variable of a frame slot, they are 
+ * created in the scope the first time they are used */
+int RegisterAllocator::GetSlot(int Index) {
+	while ((int)m_lSlots.size() <= Index) {
+		char Name[32];
+		int Symbol, Id;
+
+		snprintf(&Name[0], sizeof(Name), "__spill%u", (unsigned)m_lSlots.size());
+		Symbol = m_pPool->GetSymbols()->Intern(&Name[0]);
+		Id = m_pPool->LookupSymbol(Symbol, m_iScopeId);
+		if (Id == -1) {
+			Id = m_pPool->DefineVariable(Symbol, m_iScopeId);
+		}
+		if (Id == -1) {
+			printf("Unable to define the frame slot %s...\n", &Name[0]);
+			return -1;
+		}
+		m_lSlots.push_back(Id);
+	}
+	return m_lSlots[Index];
+}
+
+/* Gives the spilled ranges a frame slot, the slots are 
+ * shared by ranges that don't overlap. Ranges with a home 
+ * variable are kept there */
+int RegisterAllocator::AssignSlots() {
+	std::vector<int> Active;
+	std::vector<int> Free;
+
+	m_iSlotCount = 0;
+	for (size_t i = 0; i < m_lOrder.size(); i++) {
+		LiveInterval_t *Current = &m_lIntervals[m_lOrder[i]];
+		size_t Expired = 0;
+
+		if (Current->Physical != -1 || Current->Home != -1) {
+			continue;
+		}
+
+		while (Expired < Active.size() && m_lIntervals[Active[Expired]].End <= Current->Start) {
+			Free.push_back(m_lIntervals[Active[Expired]].Slot);
+			Expired++;
+		}
+		Active.erase(Active.begin(), Active.begin() + Expired);
+
+		if (Free.empty()) {
+			Current->Slot = m_iSlotCount++;
+		}
+		else {
+			Current->Slot = Free.back();
+			Free.pop_back();
+		}
+
+		size_t Position = Active.size();
+		while (Position > 0 && m_lIntervals[Active[Position - 1]].End > Current->End) {
+			Position--;
+		}
+		Active.insert(Active.begin() + Position, m_lOrder[i]);
+	}
+
+	/* Create the variables */
+	if (m_iSlotCount != 0 && GetSlot(m_iSlotCount - 1) == -1) {
+		return -1;
+	}
+
+	/* Where the spilled registers are kept */
+	for (size_t i = 0; i < m_lOrder.size(); i++) {
+		LiveInterval_t *Current = &m_lIntervals[m_lOrder[i]];
+		if (Current->Physical == -1) {
+			Current->Location = (Current->Home != -1) ? Current->Home : m_lSlots[Current->Slot];
+		}
+	}
+	return 0;
+}
+
+/* Writes an instruction with physical registers to the code */
+void RegisterAllocator::Write(Opcode_t Opcode, int Register1, int Register2, 
+	int Value1, long long Value2) {
+	BytecodeWriter &Code = m_pPool->GetCode(m_iScopeId);
+
+	switch (Opcode) {
+		case OpStore:
+		case OpAdd:
+		case OpSub:
+		case OpMul:
+		case OpDiv:
+		case OpRem: {
+			const char *Mnemonic = (Opcode == OpStore) ? "store" : (Opcode == OpAdd) ? "add" 
+				: (Opcode == OpSub) ? "sub" : (Opcode == OpMul) ? "mul" : (Opcode == OpDiv) ? "div" : "rem";
+			Code.WriteRR(Opcode, Register1, Register2);
+#ifdef DIAGNOSE
+			printf("%s $%i, $%i\n", Mnemonic, Register1, Register2);
+#else
+			(void)Mnemonic;
+#endif
+		} break;
+
+		case OpNew:
+		case OpInvoke:
+		case OpLoadRA: {
+			Code.WriteRI(Opcode, Register1, Value1);
+#ifdef DIAGNOSE
+			printf("%s $%i, #%i\n", (Opcode == OpNew) ? "new" : (Opcode == OpInvoke) ? "invoke" : "loadra", 
+				Register1, Value1);
+#endif
+		} break;
+
+		case OpStoreRI: {
+			Code.WriteRI(Opcode, Register1, Value1);
+#ifdef DIAGNOSE
+			printf("storeri $%i, [%i]\n", Register1, Value1);
+#endif
+		} break;
+
+		case OpStoreAR: {
+			Code.WriteIR(Opcode, Value1, Register1);
+#ifdef DIAGNOSE
+			printf("storear #%i, $%i\n", Value1, Register1);
+#endif
+		} break;
+
+		case OpLoadA: {
+			Code.WriteII(Opcode, Value1, (int)Value2);
+#ifdef DIAGNOSE
+			printf("loada #%i, #%i\n", Value1, (int)Value2);
+#endif
+		} break;
+
+		case OpStoreI: {
+			Code.WriteII(Opcode, Value1, (int)Value2);
+#ifdef DIAGNOSE
+			printf("storei #%i, [%i]\n", Value1, (int)Value2);
+#endif
+		} break;
+
+		case OpStoreRIW: {
+			Code.WriteRW(Opcode, Register1, Value2);
+#ifdef DIAGNOSE
+			printf("storeriw $%i, [%lli]\n", Register1, Value2);
+#endif
+		} break;
+
+		case OpStoreIW: {
+			Code.WriteIW(Opcode, Value1, Value2);
+#ifdef DIAGNOSE
+			printf("storeiw #%i, [%lli]\n", Value1, Value2);
+#endif
+		} break;
+
+		case OpStoreRF:
+		case OpStoreF: {
+			double Float = 0.0;
+			memcpy(&Float, &Value2, sizeof(Float));
+			if (Opcode == OpStoreRF) {
+				Code.WriteRW(Opcode, Register1, Value2);
+#ifdef DIAGNOSE
+				printf("storerf $%i, [%g]\n", Register1, Float);
+#endif
+			}
+			else {
+				Code.WriteIW(Opcode, Value1, Value2);
+#ifdef DIAGNOSE
+				printf("storef #%i, [%g]\n", Value1, Float);
+#endif
+			}
+		} break;
+
+		case OpInvokeR: {
+			Code.WriteRIR(Opcode, Register1, Value1, (int)Value2);
+#ifdef DIAGNOSE
+			printf("invoker $%i, #%i, %i\n", Register1, Value1, (int)Value2);
+#endif
+		} break;
+
+		default: {
+			Code.Write(Opcode);
+		} break;
+	}
+}
+
+/* Moves the arguments of a call into the registers from $0 up, the
+ * moves happen at once so a register is not written before the moves 
+ * that read it. Cycles are broken through a frame slot. The result 
+ * is moved from $0 to where it was allocated */
+int RegisterAllocator::RewriteCall(Instruction_t *pInstruction) {
+	int Count = (int)pInstruction->Value2;
+	LiveInterval_t *Result = &m_lIntervals[pInstruction->Register1];
+	int Sources[MACIA_REGISTER_MAX];
+	int Slots[MACIA_REGISTER_MAX];
+	bool Pending[MACIA_REGISTER_MAX];
+	int Remaining = 0;
+	int Temporaries = 0;
+
+	for (int i = 0; i < Count; i++) {
+		LiveInterval_t *Argument = &m_lIntervals[m_lArguments[pInstruction->Arguments + i]];
+		Sources[i] = Argument->Physical;
+		Slots[i] = (Argument->Physical == -1) ? Argument->Location : -1;
+		Pending[i] = (Sources[i] != i);
+		Remaining += Pending[i] ? 1 : 0;
+	}
+
+	while (Remaining > 0) {
+		int Progress = 0;
+
+		/* A move can be done once no other move reads its register */
+		for (int i = 0; i < Count; i++) {
+			int Blocked = 0;
+
+			if (!Pending[i]) {
+				continue;
+			}
+			for (int j = 0; j < Count && !Blocked; j++) {
+				Blocked = (j != i && Pending[j] && Sources[j] == i);
+			}
+			if (Blocked) {
+				continue;
+			}
+
+			if (Sources[i] == -1) {
+				Write(OpLoadRA, i, -1, Slots[i], 0);
+			}
+			else {
+				Write(OpStore, i, Sources[i], 0, 0);
+			}
+			Pending[i] = false;
+			Remaining--;
+			Progress = 1;
+		}
+
+		/* Cycle, store a register that is read and let 
+		 * those moves load it from the slot instead */
+		if (!Progress) {
+			int Register = 0, Slot;
+			while (!Pending[Register]) {
+				Register++;
+			}
+
+			Slot = GetSlot(m_iSlotCount + Temporaries++);
+			if (Slot == -1) {
+				return -1;
+			}
+			Write(OpStoreAR, Register, -1, Slot, 0);
+			for (int j = 0; j < Count; j++) {
+				if (Pending[j] && Sources[j] == Register) {
+					Sources[j] = -1;
+					Slots[j] = Slot;
+				}
+			}
+		}
+	}
+
+	Write(OpInvokeR, 0, -1, pInstruction->Value1, Count);
+
+	/* Move the result */
+	if (Result->Physical == -1) {
+		Write(OpStoreAR, 0, -1, Result->Location, 0);
+	}
+	else if (Result->Physical != 0) {
+		Write(OpStore, Result->Physical, 0, 0, 0);
+	}
+	return 0;
+}
+
+/* Finds a register for a spilled operand of the instruction, one that
+ * holds nothing at this point is preferred. Otherwise the value in one 
+ * is restored after the instruction, from its home variable or from a 
+ * slot it is stored in */
+int RegisterAllocator::Borrow(int Position, int Exclude, int Index, int *pSaved) {
+	for (int i = 0; i < m_iRegisterCount; i++) {
+		if (i != Exclude && (m_lOccupants[i] == -1 
+			|| m_lIntervals[m_lOccupants[i]].End < Position)) {
+			return i;
+		}
+	}
+
+	/* Move one out of the way */
+	for (int i = 0; i < m_iRegisterCount; i++) {
+		if (i != Exclude && m_lIntervals[m_lOccupants[i]].Home != -1) {
+			*pSaved = m_lIntervals[m_lOccupants[i]].Home;
+			return i;
+		}
+	}
+	for (int i = 0; i < m_iRegisterCount; i++) {
+		if (i != Exclude) {
+			*pSaved = GetSlot(m_iSlotCount + Index);
+			if (*pSaved == -1) {
+				return -1;
+			}
+			Write(OpStoreAR, i, -1, *pSaved, 0);
+			return i;
+		}
+	}
+	return -1;
+}
+
+/* Writes the code with the allocated registers, spilled registers
+ * are loaded into and stored from borrowed registers around the
+ * instructions, or the variable forms of instructions are used */
+int RegisterAllocator::Rewrite() {
+	size_t Next = 0;
+
+	m_lOccupants.assign(m_iRegisterCount, -1);
+	for (size_t i = 0; i < m_lInstructions.size(); i++) {
+		Instruction_t *Instruction = &m_lInstructions[i];
+		int Register1 = -1, Register2 = -1;
+		int Slot1 = -1, Slot2 = -1;
+		int Saved1 = -1, Saved2 = -1;
+
+		/* Keep track of what every register holds */
+		while (Next < m_lOrder.size() && m_lIntervals[m_lOrder[Next]].Start <= (int)i) {
+			if (m_lIntervals[m_lOrder[Next]].Physical != -1) {
+				m_lOccupants[m_lIntervals[m_lOrder[Next]].Physical] = m_lOrder[Next];
+			}
+			Next++;
+		}
+
+		/* Lookup the operands */
+		if (GetRegisterOperands(Instruction->Opcode) >= 1) {
+			LiveInterval_t *First = &m_lIntervals[Instruction->Register1];
+			Register1 = First->Physical;
+			Slot1 = (Register1 == -1) ? First->Location : -1;
+		}
+		if (GetRegisterOperands(Instruction->Opcode) == 2) {
+			LiveInterval_t *Second = &m_lIntervals[Instruction->Register2];
+			Register2 = Second->Physical;
+			Slot2 = (Register2 == -1) ? Second->Location : -1;
+		}
+
+		switch (Instruction->Opcode) {
+			case OpAdd:
+			case OpSub:
+			case OpMul:
+			case OpDiv:
+			case OpRem: {
+				if (Slot1 != -1 && (Register1 = Borrow((int)i, Register2, 0, &Saved1)) == -1) {
+					return -1;
+				}
+				if (Slot2 != -1 && (Register2 = Borrow((int)i, Register1, 1, &Saved2)) == -1) {
+					return -1;
+				}
+				if (Slot1 != -1) {
+					Write(OpLoadRA, Register1, -1, Slot1, 0);
+				}
+				if (Slot2 != -1) {
+					Write(OpLoadRA, Register2, -1, Slot2, 0);
+				}
+				Write(Instruction->Opcode, Register1, Register2, 0, 0);
+				if (Slot1 != -1) {
+					Write(OpStoreAR, Register1, -1, Slot1, 0);
+				}
+			} break;
+
+			case OpStore: {
+				if (Slot1 != -1 && Slot2 != -1) {
+					if (Slot1 != Slot2) {
+						Write(OpLoadA, -1, -1, Slot1, Slot2);
+					}
+				}
+				else if (Slot1 != -1) {
+					Write(OpStoreAR, Register2, -1, Slot1, 0);
+				}
+				else if (Slot2 != -1) {
+					Write(OpLoadRA, Register1, -1, Slot2, 0);
+				}
+				else if (Register1 != Register2) {
+					Write(OpStore, Register1, Register2, 0, 0);
+				}
+			} break;
+
+			case OpStoreAR: {
+				if (Slot1 != -1) {
+					if (Slot1 != Instruction->Value1) {
+						Write(OpLoadA, -1, -1, Instruction->Value1, Slot1);
+					}
+				}
+				else {
+					Write(OpStoreAR, Register1, -1, Instruction->Value1, 0);
+				}
+			} break;
+
+			case OpLoadRA: {
+				if (Slot1 != -1) {
+					if (Slot1 != Instruction->Value1) {
+						Write(OpLoadA, -1, -1, Slot1, Instruction->Value1);
+					}
+				}
+				else {
+					Write(OpLoadRA, Register1, -1, Instruction->Value1, 0);
+				}
+			} break;
+
+			case OpStoreRI: {
+				if (Slot1 != -1) {
+					Write(OpStoreI, -1, -1, Slot1, Instruction->Value1);
+				}
+				else {
+					Write(OpStoreRI, Register1, -1, Instruction->Value1, 0);
+				}
+			} break;
+
+			case OpStoreRIW:
+			case OpStoreRF: {
+				if (Slot1 != -1) {
+					Write((Instruction->Opcode == OpStoreRIW) ? OpStoreIW : OpStoreF, 
+						-1, -1, Slot1, Instruction->Value2);
+				}
+				else {
+					Write(Instruction->Opcode, Register1, -1, 0, Instruction->Value2);
+				}
+			} break;
+
+			case OpNew:
+			case OpInvoke: {
+				if (Slot1 != -1 && (Register1 = Borrow((int)i, -1, 0, &Saved1)) == -1) {
+					return -1;
+				}
+				if (Slot1 != -1 && Instruction->Opcode == OpInvoke) {
+					Write(OpLoadRA, Register1, -1, Slot1, 0);
+				}
+				Write(Instruction->Opcode, Register1, -1, Instruction->Value1, 0);
+				if (Slot1 != -1 && Instruction->Opcode == OpNew) {
+					Write(OpStoreAR, Register1, -1, Slot1, 0);
+				}
+			} break;
+
+			case OpInvokeR: {
+				if (RewriteCall(Instruction)) {
+					return -1;
+				}
+			} break;
+
+			default: {
+				Write(Instruction->Opcode, -1, -1, Instruction->Value1, Instruction->Value2);
+			} break;
+		}
+
+		/* Restore borrowed registers */
+		if (Saved1 != -1) {
+			Write(OpLoadRA, Register1, -1, Saved1, 0);
+		}
+		if (Saved2 != -1) {
+			Write(OpLoadRA, Register2, -1, Saved2, 0);
+		}
+	}
+	return 0;
+}
+
+/* Allocates the code of the scope and appends it */
+int RegisterAllocator::Finish() {
+	int Result = 0;
+
+	BuildIntervals();
+	FindHomes();
+	LimitIntervals();
+	Scan();
+
+	/* Write it */
+	if (AssignSlots() || Rewrite()) {
+		Result = -1;
+	}
+
+	/* Cleanup */
+	m_lInstructions.clear();
+	m_lArguments.clear();
+	m_lIntervals.clear();
+	m_lOrder.clear();
+	m_iScopeId = -1;
+	return Result;
+}
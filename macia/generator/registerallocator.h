@@ -0,0 +1,129 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+* Macia - Register Allocator
+* - Maps the virtual registers of generated code onto the
+*   physical register file
+*/
+#pragma once
+
+/* Includes */
+#include <vector>
+#include "opcodes.h"
+#include "../shared/datapool.h"
+
+/* The default size of the physical register file, an 
+ * instruction uses up to two registers and the register 
+ * operands are 8 bit, so it is between 2 and 256 */
+#define MACIA_REGISTER_COUNT	4
+#define MACIA_REGISTER_MIN		2
+#define MACIA_REGISTER_MAX		256
+
+/* A generated instruction, the registers are virtual until
+ * the code is allocated. Register1 and Register2 are the 
+ * register operands in order, Value1 is the first id or 32 bit
+ * operand and Value2 the second one or the 64 bit operand. 
+ * Calls keep their arguments in the argument list */
+typedef struct {
+	Opcode_t Opcode;
+	int Register1;
+	int Register2;
+	int Value1;
+	long long Value2;
+	size_t Arguments;
+} Instruction_t;
+
+/* The live range of a virtual register, from the instruction
+ * that defines it to the last one that uses it. Limit is the 
+ * lowest physical register it may use, as calls take the ones
+ * below for their arguments. Spilled ranges are kept in the 
+ * variable Location, their home variable or a frame slot */
+typedef struct {
+	int Start;
+	int End;
+	int Limit;
+	int Hint;
+	int Physical;
+	int Slot;
+	int Home;
+	int Location;
+} LiveInterval_t;
+
+/* The register allocator
+ * The generator emits the code of a function over an unlimited 
+ * number of virtual registers, which are mapped onto the physical 
+ * registers by linear scan when the function is done. Registers 
+ * that don't fit are spilled to hidden variables of the function,
+ * the frame slots. The arguments of a call are moved into the 
+ * registers from $0 up, which is also where the result is */
+class RegisterAllocator
+{
+public:
+	RegisterAllocator(DataPool *pPool);
+	~RegisterAllocator();
+
+	/* Sets the size of the physical register file, 
+	 * returns -1 if it is out of range */
+	int SetRegisterCount(int Count);
+	int GetRegisterCount() { return m_iRegisterCount; }
+
+	/* Starts the code of a scope, the code is appended
+	 * to the scope when it is finished */
+	void Begin(int ScopeId);
+	int Finish();
+
+	/* Creates a new virtual register */
+	int CreateRegister() { return m_iVirtualCount++; }
+
+	/* Instructions, named by their operands like the 
+	 * bytecode writer */
+	void EmitRR(Opcode_t Opcode, int Register1, int Register2);
+	void EmitRI(Opcode_t Opcode, int Register, int Value);
+	void EmitIR(Opcode_t Opcode, int Value, int Register);
+	void EmitII(Opcode_t Opcode, int Value1, int Value2);
+	void EmitRW(Opcode_t Opcode, int Register, long long Value);
+	void EmitIW(Opcode_t Opcode, int Value1, long long Value2);
+	void EmitCall(int Result, int Id, const int *pArguments, int Count);
+
+private:
+	/* Private - Functions */
+	void Emit(Opcode_t Opcode, int Register1, int Register2, int Value1, long long Value2);
+	void BuildIntervals();
+	void FindHomes();
+	void LimitIntervals();
+	void Scan();
+	int AssignSlots();
+	int GetSlot(int Index);
+	int Borrow(int Position, int Exclude, int Index, int *pSaved);
+	int Rewrite();
+	int RewriteCall(Instruction_t *pInstruction);
+	void Write(Opcode_t Opcode, int Register1, int Register2, int Value1, long long Value2);
+
+	/* Private - Data */
+	DataPool *m_pPool;
+	int m_iRegisterCount;
+	int m_iScopeId;
+	int m_iVirtualCount;
+
+	std::vector<Instruction_t> m_lInstructions;
+	std::vector<int> m_lArguments;
+	std::vector<LiveInterval_t> m_lIntervals;
+	std::vector<int> m_lOrder;
+	std::vector<int> m_lSlots;
+	std::vector<int> m_lOccupants;
+	int m_iSlotCount;
+};
@@ -59,20 +59,21 @@ int Interpreter::Execute() {
 	//Instance = new ObjectInstance(m_pPool->CalculateObjectSize(0), NULL);
 
 	/* Execute code */
-	return ExecuteCode(Instance, EntryObj->GetCode());
+	return ExecuteCode(Instance, EntryObj->GetCode().GetData(), 
+		EntryObj->GetCode().GetSize());
 }
 
 /* Executes the given code 
  * this function may be called recursive */
-int Interpreter::ExecuteCode(ObjectInstance *Instance, std::vector<unsigned char> &Code) {
+int Interpreter::ExecuteCode(ObjectInstance *Instance, const unsigned char *pCode, size_t Length) {
 	
 	/* Iterator */
 	size_t Iterator = 0;
 
-	while (Iterator < Code.size()) {
+	while (Iterator < Length) {
 
 		/* Get opcode */
-		Opcode_t Opcode = (Opcode_t)Code[Iterator];
+		Opcode_t Opcode = (Opcode_t)pCode[Iterator];
 
 		/* Increament */
 		Iterator++;
@@ -84,6 +85,7 @@ int Interpreter::ExecuteCode(ObjectInstance *Instance, std::vector<unsigned char
 			case OpLabel:
 			case OpNew:
 			case OpInvoke:
+			case OpInvokeR:
 			case OpReturn: {
 
 			} break;
@@ -92,7 +94,11 @@ int Interpreter::ExecuteCode(ObjectInstance *Instance, std::vector<unsigned char
 			case OpStore:
 			case OpStoreAR:
 			case OpStoreRI:
-			case OpStoreI: {
+			case OpStoreI:
+			case OpStoreRIW:
+			case OpStoreIW:
+			case OpStoreRF:
+			case OpStoreF: {
 
 			} break;
 
@@ -74,7 +74,7 @@ public:
 
 private:
 	/* Private - Functions */
-	int ExecuteCode(ObjectInstance *Instance, std::vector<unsigned char> &Code);
+	int ExecuteCode(ObjectInstance *Instance, const unsigned char *pCode, size_t Length);
 
 	/* Private - Data */
 	DataPool *m_pPool;
@@ -0,0 +1,235 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Character Classification (Lexer)
+* - Table driven classification and run scanning
+* - Uses SSE2/AVX2 when available, MACIA_SCANNER_SCALAR forces the fallback
+*/
+
+/* Includes */
+#include "charclass.h"
+
+#if !defined(MACIA_SCANNER_SCALAR) && defined(__AVX2__)
+#define CHARCLASS_AVX2
+#include <immintrin.h>
+#elif !defined(MACIA_SCANNER_SCALAR) && defined(__SSE2__)
+#define CHARCLASS_SSE2
+#include <emmintrin.h>
+#endif
+
+/* Shorthands for the table */
+#define S CHARCLASS_SPACE
+#define N (CHARCLASS_SPACE | CHARCLASS_NEWLINE)
+#define A CHARCLASS_ALPHA
+#define D CHARCLASS_DIGIT
+
+/* Classification table, indexed by the
+ * unsigned value of the character */
+const unsigned char CharClassTable[256] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 0, S, N, S, S, S, 0, 0,		/* 0x00 */
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,		/* 0x10 */
+	S, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,		/* 0x20 */
+	D, D, D, D, D, D, D, D, D, D, 0, 0, 0, 0, 0, 0,		/* 0x30 */
+	0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,		/* 0x40 */
+	A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, A,		/* 0x50 */
+	0, A, A, A, A, A, A, A, A, A, A, A, A, A, A, A,		/* 0x60 */
+	A, A, A, A, A, A, A, A, A, A, A, 0, 0, 0, 0, 0,		/* 0x70 */
+};
+
+#undef S
+#undef N
+#undef A
+#undef D
+
+#if defined(CHARCLASS_AVX2)
+/* Vector helpers, 32 characters at a time 
+ * Characters above 0x7F are negative and never match a range */
+#define CHARCLASS_WIDTH		32
+typedef __m256i Vector_t;
+#define VectorLoad(p)		_mm256_loadu_si256((const __m256i*)(p))
+#define VectorSet(c)		_mm256_set1_epi8(c)
+#define VectorEqual(a, b)	_mm256_cmpeq_epi8(a, b)
+#define VectorGreater(a, b)	_mm256_cmpgt_epi8(a, b)
+#define VectorAnd(a, b)		_mm256_and_si256(a, b)
+#define VectorOr(a, b)		_mm256_or_si256(a, b)
+#define VectorMask(a)		((unsigned int)_mm256_movemask_epi8(a))
+#define VECTOR_FULL			0xFFFFFFFFu
+#elif defined(CHARCLASS_SSE2)
+/* Vector helpers, 16 characters at a time 
+ * Characters above 0x7F are negative and never match a range */
+#define CHARCLASS_WIDTH		16
+typedef __m128i Vector_t;
+#define VectorLoad(p)		_mm_loadu_si128((const __m128i*)(p))
+#define VectorSet(c)		_mm_set1_epi8(c)
+#define VectorEqual(a, b)	_mm_cmpeq_epi8(a, b)
+#define VectorGreater(a, b)	_mm_cmpgt_epi8(a, b)
+#define VectorAnd(a, b)		_mm_and_si128(a, b)
+#define VectorOr(a, b)		_mm_or_si128(a, b)
+#define VectorMask(a)		((unsigned int)_mm_movemask_epi8(a))
+#define VECTOR_FULL			0xFFFFu
+#endif
+
+#ifdef CHARCLASS_WIDTH
+/* Matches characters in the inclusive range [Low, High] */
+static inline Vector_t VectorRange(Vector_t Value, char Low, char High) {
+	return VectorAnd(VectorGreater(Value, VectorSet(Low - 1)),
+		VectorGreater(VectorSet(High + 1), Value));
+}
+
+/* Matches whitespace, ' ' and '\t' through '\r' */
+static inline unsigned int MaskWhitespace(const char *Data) {
+	Vector_t Value = VectorLoad(Data);
+	return VectorMask(VectorOr(VectorEqual(Value, VectorSet(' ')),
+		VectorRange(Value, '\t', '\r')));
+}
+
+/* Matches letters, digits and '_' */
+static inline unsigned int MaskIdentifier(const char *Data) {
+	Vector_t Value = VectorLoad(Data);
+	Vector_t Lower = VectorOr(Value, VectorSet(0x20));
+	return VectorMask(VectorOr(VectorOr(VectorRange(Lower, 'a', 'z'),
+		VectorRange(Value, '0', '9')), VectorEqual(Value, VectorSet('_'))));
+}
+
+/* Matches decimal digits */
+static inline unsigned int MaskDigits(const char *Data) {
+	Vector_t Value = VectorLoad(Data);
+	return VectorMask(VectorRange(Value, '0', '9'));
+}
+
+/* Matches a single character */
+static inline unsigned int MaskCharacter(const char *Data, char Character) {
+	return VectorMask(VectorEqual(VectorLoad(Data), VectorSet(Character)));
+}
+#endif
+
+/* Skips a run of whitespace */
+size_t ScanWhitespace(const char *Data, size_t Index, size_t Length)
+{
+#ifdef CHARCLASS_WIDTH
+	while (Index + CHARCLASS_WIDTH <= Length) {
+		unsigned int Mask = MaskWhitespace(&Data[Index]);
+		if (Mask != VECTOR_FULL) {
+			return Index + __builtin_ctz(~Mask);
+		}
+		Index += CHARCLASS_WIDTH;
+	}
+#endif
+	while (Index < Length && CharIsClass(Data[Index], CHARCLASS_SPACE)) {
+		Index++;
+	}
+	return Index;
+}
+
+/* Skips the characters of an identifier */
+size_t ScanIdentifier(const char *Data, size_t Index, size_t Length)
+{
+#ifdef CHARCLASS_WIDTH
+	while (Index + CHARCLASS_WIDTH <= Length) {
+		unsigned int Mask = MaskIdentifier(&Data[Index]);
+		if (Mask != VECTOR_FULL) {
+			return Index + __builtin_ctz(~Mask);
+		}
+		Index += CHARCLASS_WIDTH;
+	}
+#endif
+	while (Index < Length 
+		&& CharIsClass(Data[Index], CHARCLASS_ALPHA | CHARCLASS_DIGIT)) {
+		Index++;
+	}
+	return Index;
+}
+
+/* Skips a run of decimal digits */
+size_t ScanDigits(const char *Data, size_t Index, size_t Length)
+{
+#ifdef CHARCLASS_WIDTH
+	while (Index + CHARCLASS_WIDTH <= Length) {
+		unsigned int Mask = MaskDigits(&Data[Index]);
+		if (Mask != VECTOR_FULL) {
+			return Index + __builtin_ctz(~Mask);
+		}
+		Index += CHARCLASS_WIDTH;
+	}
+#endif
+	while (Index < Length && CharIsClass(Data[Index], CHARCLASS_DIGIT)) {
+		Index++;
+	}
+	return Index;
+}
+
+/* Finds the next occurence of the given character */
+size_t ScanCharacter(const char *Data, size_t Index, size_t Length, char Character)
+{
+#ifdef CHARCLASS_WIDTH
+	while (Index + CHARCLASS_WIDTH <= Length) {
+		unsigned int Mask = MaskCharacter(&Data[Index], Character);
+		if (Mask != 0) {
+			return Index + __builtin_ctz(Mask);
+		}
+		Index += CHARCLASS_WIDTH;
+	}
+#endif
+	while (Index < Length && Data[Index] != Character) {
+		Index++;
+	}
+	return Index;
+}
+
+/* Finds the '*' of the next comment block closer */
+size_t ScanBlockCloser(const char *Data, size_t Index, size_t Length)
+{
+#ifdef CHARCLASS_WIDTH
+	/* Compare the stars against the slashes one character ahead */
+	while (Index + CHARCLASS_WIDTH + 1 <= Length) {
+		unsigned int Mask = MaskCharacter(&Data[Index], '*') 
+			& MaskCharacter(&Data[Index + 1], '/');
+		if (Mask != 0) {
+			return Index + __builtin_ctz(Mask);
+		}
+		Index += CHARCLASS_WIDTH;
+	}
+#endif
+	while (Index + 1 < Length 
+		&& !(Data[Index] == '*' && Data[Index + 1] == '/')) {
+		Index++;
+	}
+	return (Index + 1 < Length) ? Index : Length;
+}
+
+/* Records the start of a new line in the index for
+ * every newline in [Start, End) */
+void RecordNewlines(const char *Data, size_t Start, size_t End, LineIndex *Lines)
+{
+#ifdef CHARCLASS_WIDTH
+	while (Start + CHARCLASS_WIDTH <= End) {
+		unsigned int Mask = MaskCharacter(&Data[Start], '\n');
+		while (Mask != 0) {
+			Lines->Add(Start + __builtin_ctz(Mask) + 1);
+			Mask &= Mask - 1;
+		}
+		Start += CHARCLASS_WIDTH;
+	}
+#endif
+	while (Start < End) {
+		if (Data[Start] == '\n') {
+			Lines->Add(Start + 1);
+		}
+		Start++;
+	}
+}
@@ -0,0 +1,56 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Character Classification (Lexer)
+* - Table driven classification and run scanning
+* - Uses SSE2/AVX2 when available, MACIA_SCANNER_SCALAR forces the fallback
+*/
+#pragma once
+
+/* Includes */
+#include <cstddef>
+#include "../shared/lineindex.h"
+
+/* Character classes 
+ * Letters are ASCII only, like isalpha in the C locale */
+#define CHARCLASS_SPACE			0x01
+#define CHARCLASS_NEWLINE		0x02
+#define CHARCLASS_ALPHA			0x04
+#define CHARCLASS_DIGIT			0x08
+
+/* Classification table, indexed by the
+ * unsigned value of the character */
+extern const unsigned char CharClassTable[256];
+
+/* Helper to classify a single character */
+static inline int CharIsClass(char Character, int Class) {
+	return CharClassTable[(unsigned char)Character] & Class;
+}
+
+/* Run scanners
+ * All of them start at Index and return the index of the
+ * first character that ends the run, or Length */
+size_t ScanWhitespace(const char *Data, size_t Index, size_t Length);
+size_t ScanIdentifier(const char *Data, size_t Index, size_t Length);
+size_t ScanDigits(const char *Data, size_t Index, size_t Length);
+size_t ScanCharacter(const char *Data, size_t Index, size_t Length, char Character);
+size_t ScanBlockCloser(const char *Data, size_t Index, size_t Length);
+
+/* Records the start of a new line in the index for
+ * every newline in [Start, End) */
+void RecordNewlines(const char *Data, size_t Start, size_t End, LineIndex *Lines);
@@ -0,0 +1,145 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+* Macia - Keyword Recognition (Lexer)
+* - Maps identifiers to keyword elements with a perfect hash
+*/
+
+/* Includes */
+#include "keywords.h"
+
+/* Number of slots in the keyword table, must be a power 
+ * of two and larger than the number of keywords */
+#define KEYWORD_SLOTS			16
+
+/* The keyword list, the table below is generated 
+ * from this at compile time */
+typedef struct {
+	const char *Text;
+	size_t Length;
+	ElementType_t Type;
+} KeywordDefinition_t;
+
+static constexpr KeywordDefinition_t __Keywords[] = {
+	{ "object", 6, KeywordObject },
+	{ "func", 4, KeywordFunc },
+	{ "const", 5, KeywordConst },
+	{ "locked", 6, KeywordLocked },
+	{ "namespace", 9, KeywordNamespace },
+	{ "import", 6, KeywordImport },
+	{ "readonly", 8, KeywordReadonly },
+	{ "get", 3, KeywordGet },
+	{ "set", 3, KeywordSet }
+};
+
+#define KEYWORD_COUNT			(sizeof(__Keywords) / sizeof(__Keywords[0]))
+
+/* Folds a single ASCII character to lower-case */
+static constexpr unsigned char FoldKeyCharacter(char Character) {
+	return (Character >= 'A' && Character <= 'Z') ? 
+		(unsigned char)(Character + ('a' - 'A')) : (unsigned char)Character;
+}
+
+/* The hash only looks at the length and the first and last 
+ * character, so an identifier is hashed in constant time */
+static constexpr size_t HashKeyword(const char *pText, size_t Length, unsigned int Seed) {
+	return ((FoldKeyCharacter(pText[0]) * Seed) 
+		^ (FoldKeyCharacter(pText[Length - 1]) + Length * 7)) & (KEYWORD_SLOTS - 1);
+}
+
+/* Searches for the first seed that places every 
+ * keyword in a slot of its own, 0 if there is none */
+static constexpr unsigned int FindKeywordSeed() {
+	for (unsigned int Seed = 1; Seed < 1024; Seed++) {
+		bool Used[KEYWORD_SLOTS] = { };
+		bool Collision = false;
+		for (size_t i = 0; i < KEYWORD_COUNT && !Collision; i++) {
+			size_t Slot = HashKeyword(__Keywords[i].Text, __Keywords[i].Length, Seed);
+			Collision = Used[Slot];
+			Used[Slot] = true;
+		}
+		if (!Collision) {
+			return Seed;
+		}
+	}
+	return 0;
+}
+
+/* The length range of the keywords, anything 
+ * outside of it can be rejected without hashing */
+static constexpr size_t KeywordLength(bool Longest) {
+	size_t Result = __Keywords[0].Length;
+	for (size_t i = 1; i < KEYWORD_COUNT; i++) {
+		if (Longest ? (__Keywords[i].Length > Result) : (__Keywords[i].Length < Result)) {
+			Result = __Keywords[i].Length;
+		}
+	}
+	return Result;
+}
+
+static constexpr size_t KeywordMinLength = KeywordLength(false);
+static constexpr size_t KeywordMaxLength = KeywordLength(true);
+static constexpr unsigned int KeywordSeed = FindKeywordSeed();
+static_assert(KeywordSeed != 0, "No perfect hash seed for the keyword list, increase KEYWORD_SLOTS");
+
+/* The keyword table
+ * Every slot holds at most one keyword, empty slots have
+ * a length of zero so they never match */
+typedef struct {
+	const char *Text[KEYWORD_SLOTS];
+	size_t Length[KEYWORD_SLOTS];
+	ElementType_t Type[KEYWORD_SLOTS];
+} KeywordTable_t;
+
+static constexpr KeywordTable_t BuildKeywordTable() {
+	KeywordTable_t Table = { };
+	for (size_t i = 0; i < KEYWORD_COUNT; i++) {
+		size_t Slot = HashKeyword(__Keywords[i].Text, __Keywords[i].Length, KeywordSeed);
+		Table.Text[Slot] = __Keywords[i].Text;
+		Table.Length[Slot] = __Keywords[i].Length;
+		Table.Type[Slot] = __Keywords[i].Type;
+	}
+	return Table;
+}
+
+static constexpr KeywordTable_t __KeywordTable = BuildKeywordTable();
+
+/* Returns the keyword element type for the given identifier 
+ * text, or Identifier if it is not a keyword. Keywords are
+ * matched case-insensitive like all other names */
+ElementType_t LookupKeyword(const char *pText, size_t Length) {
+
+	/* Variables */
+	size_t Slot;
+
+	/* Most identifiers are rejected by length alone */
+	if (Length < KeywordMinLength || Length > KeywordMaxLength) {
+		return Identifier;
+	}
+
+	/* Only one candidate to compare against */
+	Slot = HashKeyword(pText, Length, KeywordSeed);
+	if (__KeywordTable.Length[Slot] != Length) {
+		return Identifier;
+	}
+	for (size_t i = 0; i < Length; i++) {
+		if (FoldKeyCharacter(pText[i]) != (unsigned char)__KeywordTable.Text[Slot][i]) {
+			return Identifier;
+		}
+	}
+	return __KeywordTable.Type[Slot];
+}
@@ -0,0 +1,30 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+* Macia - Keyword Recognition (Lexer)
+* - Maps identifiers to keyword elements with a perfect hash
+*/
+#pragma once
+
+/* Includes */
+#include <cstddef>
+#include "../shared/element.h"
+
+/* Returns the keyword element type for the given identifier 
+ * text, or Identifier if it is not a keyword. Keywords are
+ * matched case-insensitive like all other names */
+ElementType_t LookupKeyword(const char *pText, size_t Length);
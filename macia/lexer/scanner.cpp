@@ -20,34 +20,105 @@
 */
 
 /* Includes */
-#include "../shared/stringbuffer.h"
 #include "scanner.h"
+#include "charclass.h"
+#include "keywords.h"
+#include "../shared/diagnostics.h"
 
 /* C-Library */
-#include <cctype>
 #include <cstdio>
-
-/* Initialize variables 
- * and clear out the elements just to be sure */
-Scanner::Scanner() {
-	m_lElements.clear();
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+/* Longest float literal that is converted, 
+ * the text is copied to terminate it */
+#define SCANNER_FLOAT_LENGTH	64
+
+/* Initialize variables, identifiers are 
+ * interned into the given symbol table */
+Scanner::Scanner(SymbolTable *Symbols, int Flags) {
+	m_pSymbols = Symbols;
+	m_iFlags = Flags;
+	Begin(NULL, 0);
 }
 
-/* Go through list, delete elements 
- * and clear list */
+/* Destructor
+ * Tokens are views, there is nothing to free */
 Scanner::~Scanner() {
 	
 }
 
-/* Parses a file and converts 
- * it into a stream of tokens for use by the
- * parser */
-int Scanner::Scan(char *Data, size_t Length)
+/* Starts pulling tokens from the given source, 
+ * it must stay resident while tokens are in use */
+void Scanner::Begin(const char *Data, size_t Length, int FirstLine, int FirstColumn)
+{
+	/* Store the source, all tokens reference it */
+	m_pSource = Data;
+	m_iError = 0;
+
+	/* Reset the cursor and the line starts, 
+	 * they are recorded as newlines are passed */
+	m_iLength = Length;
+	m_iPosition = 0;
+	m_Lines.Clear(FirstLine, FirstColumn);
+
+	/* Forget the doc-comments of the last source */
+	m_lDocComments.clear();
+
+	/* Empty the lookahead */
+	m_iRingHead = 0;
+	m_iRingCount = 0;
+	m_iConsumed = 0;
+}
+
+/* Returns the token Ahead positions from the current
+ * one without consuming it */
+const Token_t &Scanner::Peek(int Ahead)
+{
+	/* Fill the ring untill we have the token */
+	while (m_iRingCount <= Ahead) {
+		Lex(&m_Ring[(m_iRingHead + m_iRingCount) & (SCANNER_LOOKAHEAD - 1)]);
+		m_iRingCount++;
+	}
+	return m_Ring[(m_iRingHead + Ahead) & (SCANNER_LOOKAHEAD - 1)];
+}
+
+/* Consumes and returns the next token */
+Token_t Scanner::NextToken()
+{
+	Token_t Token;
+
+	/* Take it from the lookahead if we have peeked */
+	if (m_iRingCount != 0) {
+		Token = m_Ring[m_iRingHead];
+		m_iRingHead = (m_iRingHead + 1) & (SCANNER_LOOKAHEAD - 1);
+		m_iRingCount--;
+	}
+	else {
+		Lex(&Token);
+	}
+
+	/* The end is not counted as a token */
+	if (Token.Type != UNKNOWN) {
+		m_iConsumed++;
+	}
+	return Token;
+}
+
+/* Scans the next token from the cursor, the end of
+ * the source and errors both produce an UNKNOWN token */
+void Scanner::Lex(Token_t *Token)
 {
-	/* Some state variables */
-	long CharPos = 1;
-	int LineNo = 1;
-	size_t Count = 0;
+	/* Shorthands for the cursor */
+	const char *Data = m_pSource;
+	size_t Length = m_iLength;
+	size_t Count = m_iPosition;
+
+	/* Nothing more after an error */
+	if (m_iError) {
+		Count = Length;
+	}
 
 	/* Iterate through data */
 	while (Count < Length) 
@@ -56,16 +127,12 @@ int Scanner::Scan(char *Data, size_t Length)
 		char Character = Data[Count];
 
 		/* Handle the types of characters 
-		 * that we don't care about */
-		if (isspace(Character)) {
-			if (Character == '\n') {
-				LineNo++;
-				CharPos = 0;
-			}
-
-			/* Increase, go */
-			CharPos++;
-			goto NextScan;
+		 * that we don't care about, skip the whole run */
+		if (CharIsClass(Character, CHARCLASS_SPACE)) {
+			size_t End = ScanWhitespace(Data, Count, Length);
+			RecordNewlines(Data, Count, End, &m_Lines);
+			Count = End;
+			continue;
 		}
 
 		/* Check for comments first */
@@ -73,264 +140,342 @@ int Scanner::Scan(char *Data, size_t Length)
 			&& ((Count + 1) < Length)
 			&& Data[Count + 1] == '/') {
 			/* This is a comment line */
+			size_t Start = Count + 2;
 
-			/* We need a string buffer for this
-			* to append */
-			StringBuffer_t *Sb = GetStringBuffer();
+			/* Consume everything untill we reach a newline, 
+			 * the newline itself is left for the whitespace */
+			Count = ScanCharacter(Data, Start, Length, '\n');
 
-			/* Consume the comment line tokens */
-			Count += 2;
-			Character = Data[Count];
-
-			/* Keep iterating! 
-			 * Consume everything untill we reach a newline */
-			while (Character != '\n') {
-				Sb->Append(Sb, Character);
-
-				/* Consume -> Next */
-				Count++;
-				CharPos++;
-				Character = Data[Count];
+			/* Doc-comments start with '///' */
+			if ((m_iFlags & ScannerDocComments) 
+				&& Start < Count && Data[Start] == '/') {
+				AddDocComment(Start + 1, Count - Start - 1);
 			}
 
-			/* Create the token */
-			CreateElement(CommentLine, Sb->ToString(Sb), LineNo, CharPos);
-
-			/* Cleanup */
-			Sb->Dispose(&Sb);
-
-			/* Go one back */
-			Count--;
+			/* Create the token, unless comments are elided */
+			if (m_iFlags & ScannerSkipComments) {
+				continue;
+			}
+			CreateToken(Token, CommentLine, Start, Count - Start);
 		}
 		else if (Character == '/'
 			&& ((Count + 1) < Length)
 			&& Data[Count + 1] == '*') {
 
 			/* This is a comment block */
-			int TempLineIncrease = 0;
-
-			/* We need a string buffer for this
-			* to append */
-			StringBuffer_t *Sb = GetStringBuffer();
-
-			/* Consume the comment line tokens */
-			Count += 2;
-			Character = Data[Count];
-
-			/* Keep iterating!
-			* Consume everything untill we reach a newline */
-			while (1) {
-
-				/* Check for end of command block 
-				 * If it's the end, then consume them */
-				if (Character == '*'
-					&& Data[Count + 1] == '/') {
-					Count += 2;
-					break;
-				}
+			size_t Start = Count + 2;
 
-				/* Keep track of line-skips */
-				if (Character == '\n') {
-					TempLineIncrease++;
-					CharPos = 0;
-				}
-
-				/* Append */
-				Sb->Append(Sb, Character);
+			/* Consume everything untill we reach the closer */
+			Count = ScanBlockCloser(Data, Start, Length);
 
-				/* Consume -> Next */
-				Count++;
-				CharPos++;
-				Character = Data[Count];
-
-				/* Sanity */
-				if ((Count + 1) >= Length) 
-				{
-					/* Error message */
-					printf("Comment Block without closer at line %i\n", LineNo);
+			/* Sanity */
+			if (Count >= Length) 
+			{
+				/* Error message */
+				ReportAt(Start, "Comment Block without closer at line %i\n", m_Lines.GetLine(Start));
 
-					/* Bail out */
-					return -1;
-				}
+				/* Bail out */
+				m_iError = -1;
+				break;
 			}
 
-			/* Create the token */
-			CreateElement(CommentBlock, Sb->ToString(Sb), LineNo, CharPos);
-
-			/* Cleanup */
-			Sb->Dispose(&Sb);
+			/* Doc-comments start with slash-star-star */
+			if ((m_iFlags & ScannerDocComments) 
+				&& Start + 1 < Count && Data[Start] == '*') {
+				AddDocComment(Start + 1, Count - Start - 1);
+			}
 
-			/* Restore line-no */
-			LineNo += TempLineIncrease;
+			/* Keep track of line-skips, and consume the closer */
+			RecordNewlines(Data, Start, Count, &m_Lines);
+			Count += 2;
 
-			/* Go one back */
-			Count--;
+			/* Create the token, unless comments are elided */
+			if (m_iFlags & ScannerSkipComments) {
+				continue;
+			}
+			CreateToken(Token, CommentBlock, Start, Count - 2 - Start);
 		}
 		/* Identifier? */
-		else if (isalpha(Character)
-			|| Character == '_') {
-
-			/* We need a string buffer for this
-			 * to append */
-			StringBuffer_t *Sb = GetStringBuffer();
-
-			/* Keep iterating! */
-			while (isalpha(Character)
-				|| isdigit(Character)
-				|| Character == '_') {
-				Sb->Append(Sb, Character);
-				
-				/* Consume -> Next */
-				Count++;
-				CharPos++;
-				Character = Data[Count];
-			}
-
-			/* Create the token */
-			CreateElement(Identifier, Sb->ToString(Sb), LineNo, CharPos);
+		else if (CharIsClass(Character, CHARCLASS_ALPHA)) {
+			size_t Start = Count;
 
-			/* Cleanup */
-			Sb->Dispose(&Sb);
+			/* Consume letters, digits and '_' */
+			Count = ScanIdentifier(Data, Start, Length);
 
-			/* Go one back */
-			Count--;
+			/* Create the token */
+			CreateToken(Token, Identifier, Start, Count - Start);
 		}
 		/* String literal? */
 		else if (Character == '"') {
+			size_t Start = Count + 1;
 
-			/* We need a string buffer for this
-			* to append */
-			StringBuffer_t *Sb = GetStringBuffer();
-
-			/* Skip Character */
-			Count++;
-			Character = Data[Count];
+			/* Consume untill the closing quote */
+			Count = ScanCharacter(Data, Start, Length, '"');
 
-			/* Keep iterating! */
-			while (Character != '"') {
-				Sb->Append(Sb, Character);
+			/* Sanity */
+			if (Count >= Length) {
+				/* Error message */
+				ReportAt(Start, "String literal without closer at line %i\n", m_Lines.GetLine(Start));
 
-				/* Consume -> Next */
-				Count++;
-				CharPos++;
-				Character = Data[Count];
+				/* Bail out */
+				m_iError = -1;
+				break;
 			}
 
 			/* Create the token */
-			CreateElement(StringLiteral, Sb->ToString(Sb), LineNo, CharPos);
-
-			/* Cleanup */
-			Sb->Dispose(&Sb);
+			CreateToken(Token, StringLiteral, Start, Count - Start);
 
-			/* Increase */
-			CharPos++;
+			/* Keep track of line-skips, and consume the quote */
+			RecordNewlines(Data, Start, Count, &m_Lines);
+			Count++;
 		}
 		/* Digit literal? */
-		else if (isdigit(Character)) {
-
-			/* We need a string buffer for this
-			* to append */
-			StringBuffer_t *Sb = GetStringBuffer();
-
-			/* Keep iterating! */
-			while (isdigit(Character)
-				|| Character == '.') {
-				Sb->Append(Sb, Character);
-
-				/* Consume -> Next */
-				Count++;
-				CharPos++;
-				Character = Data[Count];
+		else if (CharIsClass(Character, CHARCLASS_DIGIT)) {
+			if (LexNumber(Token, &Count)) {
+				m_iError = -1;
+				break;
 			}
-
-			/* Create the token */
-			CreateElement(DigitLiteral, Sb->ToString(Sb), LineNo, CharPos);
-
-			/* Cleanup */
-			Sb->Dispose(&Sb);
-
-			/* Go one back */
-			Count--;
 		}
 		else
 		{
 			/* Which type of character is this? */
+			ElementType_t Type = UNKNOWN;
 			switch (Character)
 			{
 				/* Tackle operators */
-				case '+': {
-					CreateElement(OperatorAdd, NULL, LineNo, CharPos);
-				} break;
-				case '-': {
-					CreateElement(OperatorSubtract, NULL, LineNo, CharPos);
-				} break;
-				case '*': {
-					CreateElement(OperatorMultiply, NULL, LineNo, CharPos);
-				} break;
-				case '/': {
-					CreateElement(OperatorDivide, NULL, LineNo, CharPos);
-				} break;
-				case '=': {
-					CreateElement(OperatorAssign, NULL, LineNo, CharPos);
-				} break;
+				case '+': Type = OperatorAdd; break;
+				case '-': Type = OperatorSubtract; break;
+				case '*': Type = OperatorMultiply; break;
+				case '/': Type = OperatorDivide; break;
+				case '%': Type = OperatorRemainder; break;
+				case '=': Type = OperatorAssign; break;
 
 				/* Tackle brackets */
-				case '(': {
-					CreateElement(LeftParenthesis, NULL, LineNo, CharPos);
-				} break;
-				case ')': {
-					CreateElement(RightParenthesis, NULL, LineNo, CharPos);
-				} break;
-				case '[': {
-					CreateElement(LeftBracket, NULL, LineNo, CharPos);
-				} break;
-				case ']': {
-					CreateElement(RightBracket, NULL, LineNo, CharPos);
-				} break;
-				case '{': {
-					CreateElement(LeftFuncBracket, NULL, LineNo, CharPos);
-				} break;
-				case '}': {
-					CreateElement(RightFuncBracket, NULL, LineNo, CharPos);
-				} break;
+				case '(': Type = LeftParenthesis; break;
+				case ')': Type = RightParenthesis; break;
+				case '[': Type = LeftBracket; break;
+				case ']': Type = RightBracket; break;
+				case '{': Type = LeftFuncBracket; break;
+				case '}': Type = RightFuncBracket; break;
 
-				case ';': {
-					CreateElement(OperatorSemiColon, NULL, LineNo, CharPos);
-				} break;
+				case ';': Type = OperatorSemiColon; break;
+				case ',': Type = OperatorComma; break;
 
 				default: {
 					/* Error message */
-					printf("Invalid token at line %i, position %li: %c\n", LineNo, CharPos, Character);
+					ReportAt(Count, "Invalid token at line %i, position %li: %c\n", 
+						m_Lines.GetLine(Count), (long)m_Lines.GetColumn(Count), Character);
+				} break;
+			}
 
-					/* Bail out */
-					return -1;
+			/* Bail out */
+			if (Type == UNKNOWN) {
+				m_iError = -1;
+				break;
+			}
 
-				} break;
+			/* Single character consumed */
+			CreateToken(Token, Type, Count, 0);
+			Count++;
+		}
+
+		/* Token is ready */
+		m_iPosition = Count;
+		return;
+	}
+
+	/* We only get here at the end of the source or 
+	 * on errors, the cursor stays there */
+	m_iPosition = Count;
+	Token->Type = UNKNOWN;
+	Token->Symbol = -1;
+	Token->Offset = Count;
+	Token->Length = 0;
+	Token->Value.Integer = 0;
+}
+
+/* Returns the value of a hex digit, or -1 */
+static inline int HexDigitValue(char Character)
+{
+	if (Character >= '0' && Character <= '9') {
+		return Character - '0';
+	}
+	if (Character >= 'a' && Character <= 'f') {
+		return Character - 'a' + 10;
+	}
+	if (Character >= 'A' && Character <= 'F') {
+		return Character - 'A' + 10;
+	}
+	return -1;
+}
+
+/* Scans a numeric literal at the index into its binary value. 
+ * Decimal literals with a fraction or an exponent are floats, 
+ * 0x and 0b prefixes give hex and binary integers which may use
+ * all 64 bits. Returns 0 and updates the index on success */
+int Scanner::LexNumber(Token_t *Token, size_t *Index)
+{
+	/* Variables */
+	const char *Data = m_pSource;
+	size_t Length = m_iLength;
+	size_t Start = *Index;
+	size_t Count = Start;
+	unsigned long long Value = 0;
+	int IsFloat = 0;
+
+	/* Hex and binary literals */
+	if (Data[Count] == '0' && (Count + 1) < Length
+		&& (Data[Count + 1] == 'x' || Data[Count + 1] == 'X'
+			|| Data[Count + 1] == 'b' || Data[Count + 1] == 'B')) {
+		int Bits = (Data[Count + 1] == 'x' || Data[Count + 1] == 'X') ? 4 : 1;
+		size_t Digits;
+
+		/* Consume the prefix */
+		Count += 2;
+		Digits = Count;
+
+		/* Shift in the digits, a set bit leaving 
+		 * the top means it does not fit */
+		while (Count < Length) {
+			int Digit = HexDigitValue(Data[Count]);
+			if (Digit < 0 || Digit >= (1 << Bits)) {
+				break;
+			}
+			if ((Value >> (64 - Bits)) != 0) {
+				ReportAt(Start, "Integer literal %.*s exceeds 64 bits at line %i\n", 
+					(int)(Count + 1 - Start), &Data[Start], m_Lines.GetLine(Start));
+				return -1;
+			}
+			Value = (Value << Bits) | (unsigned long long)Digit;
+			Count++;
+		}
+
+		/* Sanity */
+		if (Count == Digits) {
+			ReportAt(Start, "Integer literal %.*s without digits at line %i\n", 
+				(int)(Count - Start), &Data[Start], m_Lines.GetLine(Start));
+			return -1;
+		}
+	}
+	else {
+		/* The integer part */
+		Count = ScanDigits(Data, Count, Length);
+
+		/* A fraction needs a digit after the '.' */
+		if ((Count + 1) < Length && Data[Count] == '.'
+			&& CharIsClass(Data[Count + 1], CHARCLASS_DIGIT)) {
+			Count = ScanDigits(Data, Count + 1, Length);
+			IsFloat = 1;
+		}
+
+		/* And so does the exponent, after the sign */
+		if (Count < Length && (Data[Count] == 'e' || Data[Count] == 'E')) {
+			size_t Exponent = Count + 1;
+			if (Exponent < Length && (Data[Exponent] == '+' || Data[Exponent] == '-')) {
+				Exponent++;
+			}
+			if (Exponent < Length && CharIsClass(Data[Exponent], CHARCLASS_DIGIT)) {
+				Count = ScanDigits(Data, Exponent, Length);
+				IsFloat = 1;
 			}
 		}
 
-	NextScan:
-		Count++;
+		/* Accumulate integers while checking the range */
+		if (!IsFloat) {
+			for (size_t i = Start; i < Count; i++) {
+				unsigned long long Digit = (unsigned long long)(Data[i] - '0');
+				if (Value > (9223372036854775807ULL - Digit) / 10) {
+					ReportAt(Start, "Integer literal %.*s is out of range at line %i\n", 
+						(int)(Count - Start), &Data[Start], m_Lines.GetLine(Start));
+					return -1;
+				}
+				Value = (Value * 10) + Digit;
+			}
+		}
+	}
+
+	/* Numbers can't run into names */
+	if (Count < Length && CharIsClass(Data[Count], CHARCLASS_ALPHA | CHARCLASS_DIGIT)) {
+		ReportAt(Count, "Invalid numeric literal at line %i, position %li\n", 
+			m_Lines.GetLine(Count), (long)m_Lines.GetColumn(Count));
+		return -1;
+	}
+
+	/* Create the token */
+	if (IsFloat) {
+		char Buffer[SCANNER_FLOAT_LENGTH];
+		double Float;
+
+		/* The source is not terminated, convert a copy */
+		if ((Count - Start) >= sizeof(Buffer)) {
+			ReportAt(Start, "Float literal is too long at line %i\n", m_Lines.GetLine(Start));
+			return -1;
+		}
+		memcpy(&Buffer[0], &Data[Start], Count - Start);
+		Buffer[Count - Start] = '\0';
+
+		Float = strtod(&Buffer[0], NULL);
+		if (std::isinf(Float)) {
+			ReportAt(Start, "Float literal %s is out of range at line %i\n", &Buffer[0], m_Lines.GetLine(Start));
+			return -1;
+		}
+
+		CreateToken(Token, FloatLiteral, Start, Count - Start);
+		Token->Value.Float = Float;
+	}
+	else {
+		CreateToken(Token, DigitLiteral, Start, Count - Start);
+		Token->Value.Integer = (long long)Value;
 	}
 
-	/* Return 0 on success */
+	/* Done */
+	*Index = Count;
 	return 0;
 }
 
-/* Private helper for creating elements
- * and adding to the element list */
-void Scanner::CreateElement(ElementType_t Type, const char *Data, int Line, long Character)
+/* Records the span of a doc-comment, the
+ * text itself is never copied */
+void Scanner::AddDocComment(size_t Offset, size_t Length)
 {
-	/* Allocate a new instance and assign */
-	Element *elem = new Element(Type, Line, Character);
+	CommentSpan_t Span;
+	Span.Offset = Offset;
+	Span.Length = Length;
+	m_lDocComments.push_back(Span);
+}
 
-	/* Add data? */
-	if (Data != NULL)
-		elem->SetData(Data);
+/* Reports an error at an offset of the source */
+void Scanner::ReportAt(size_t Offset, const char *Format, ...)
+{
+	va_list Arguments;
+
+	va_start(Arguments, Format);
+	ReportErrorList(m_Lines.GetLine(Offset), m_Lines.GetColumn(Offset), Format, Arguments);
+	va_end(Arguments);
+}
+
+/* Private helper for filling out tokens,
+ * the text is referenced directly in the source */
+void Scanner::CreateToken(Token_t *Token, ElementType_t Type, 
+	size_t Offset, size_t Length)
+{
+	/* Keywords get their own element type, the rest of the 
+	 * identifiers are folded and interned once, all later 
+	 * stages compare the symbol id */
+	int Symbol = -1;
+	if (Type == Identifier) {
+		Type = LookupKeyword(m_pSource + Offset, Length);
+		if (Type == Identifier) {
+			Symbol = m_pSymbols->Intern(m_pSource + Offset, Length);
+		}
+	}
 
-	/* Add to list */
-	m_lElements.push_back(elem);
+	Token->Type = Type;
+	Token->Symbol = Symbol;
+	Token->Offset = Offset;
+	Token->Length = Length;
+	Token->Value.Integer = 0;
 
-	/* Diagnose */
-	printf("Found Element %s\n", elem->GetName());
+#ifdef DIAGNOSE
+	printf("Found Element %s\n", GetElementName(Type));
+#endif
 }
@@ -22,29 +22,122 @@
 
 /* Includes */
 #include "../shared/element.h"
+#include "../shared/lineindex.h"
+#include "../shared/symboltable.h"
 #include <vector>
 
+/* Number of tokens the scanner can look ahead,
+ * must be a power of two */
+#define SCANNER_LOOKAHEAD		8
+
+/* Scanner options
+ * Controls how elements are created */
+typedef enum
+{
+	/* Every token is scanned */
+	ScannerDefault		= 0x0,
+
+	/* Comments are skipped, no elements are 
+	 * created for them */
+	ScannerSkipComments	= 0x2,
+
+	/* The spans of doc-comments (triple-slash and slash-star-star) are 
+	 * recorded, see GetDocComments */
+	ScannerDocComments	= 0x4
+
+} ScannerFlags_t;
+
+/* A span of the source, used for doc-comments 
+ * The span covers the text between the markers */
+typedef struct {
+	size_t Offset;
+	size_t Length;
+} CommentSpan_t;
+
+/* A single scanned token
+ * The text is always a view into the source being scanned,
+ * the end of the source is an UNKNOWN token. Numeric literals
+ * carry their binary value. The position is only the offset,
+ * the line is looked up when needed */
+typedef struct {
+	ElementType_t Type;
+	int Symbol;
+	size_t Offset;
+	size_t Length;
+	union {
+		long long Integer;
+		double Float;
+	} Value;
+} Token_t;
+
 /* The class 
  * Scans a file and breaks it down
  * into elements, this also filters all 
- * unneccessary bullshit from the file */
+ * unneccessary bullshit from the file. 
+ * Tokens are either pulled one at a time with 
+ * NextToken/Peek, or all collected by Scan */
 class Scanner
 {
 public:
-	Scanner();
+	Scanner(SymbolTable *Symbols, int Flags = ScannerDefault);
 	~Scanner();
 
-	/* Parse file */
-	int Scan(char *Data, size_t Length);
+	/* Starts pulling tokens from the given source, 
+	 * it must stay resident while tokens are in use. A
+	 * source that is part of a larger text can number 
+	 * its positions from FirstLine and FirstColumn */
+	void Begin(const char *Data, size_t Length, int FirstLine = 1, int FirstColumn = 1);
+
+	/* Consumes and returns the next token */
+	Token_t NextToken();
+
+	/* Returns the token Ahead positions from the current
+	 * one without consuming it, Ahead must be below SCANNER_LOOKAHEAD */
+	const Token_t &Peek(int Ahead);
 
-	/* Retrieve elements */
-	std::vector<Element*> &GetElements() { return m_lElements; }
+	/* Gets, the start of a token is the offset of its
+	 * first character, which for string literals and 
+	 * comments comes before the text. The position is how
+	 * far the source has been read, lookahead included */
+	SymbolTable *GetSymbols() { return m_pSymbols; }
+	const char *GetSource() { return m_pSource; }
+	size_t GetLength() { return m_iLength; }
+	int GetFlags() { return m_iFlags; }
+	const char *GetText(const Token_t &Token) { return m_pSource + Token.Offset; }
+	size_t GetTokenCount() { return m_iConsumed; }
+	size_t GetStart(const Token_t &Token) { 
+		return (Token.Type == StringLiteral) ? (Token.Offset - 1) : 
+			(Token.Type == CommentLine || Token.Type == CommentBlock) ? (Token.Offset - 2) : Token.Offset;
+	}
+	int GetLine(const Token_t &Token) { return m_Lines.GetLine(Token.Offset); }
+	int GetColumn(const Token_t &Token) { return m_Lines.GetColumn(Token.Offset); }
+	int GetError() { return m_iError; }
+	size_t GetPosition() { return m_iPosition; }
+	std::vector<CommentSpan_t> &GetDocComments() { return m_lDocComments; }
 
 private:
 	/* Private - Functions */
-	void CreateElement(ElementType_t Type, const char *Data, int Line, long Character);
+	void Lex(Token_t *Token);
+	int LexNumber(Token_t *Token, size_t *Index);
+	void AddDocComment(size_t Offset, size_t Length);
+	void ReportAt(size_t Offset, const char *Format, ...);
+	void CreateToken(Token_t *Token, ElementType_t Type, size_t Offset, size_t Length);
 
 	/* Private - Data */
-	std::vector<Element*> m_lElements;
-};
+	LineIndex m_Lines;
+	std::vector<CommentSpan_t> m_lDocComments;
+	SymbolTable *m_pSymbols;
+	const char *m_pSource;
+	int m_iFlags;
+	int m_iError;
+
+	/* Cursor */
+	size_t m_iLength;
+	size_t m_iPosition;
 
+	/* Lookahead ring */
+	Token_t m_Ring[SCANNER_LOOKAHEAD];
+	int m_iRingHead;
+	int m_iRingCount;
+	size_t m_iConsumed;
+};
@@ -19,74 +19,216 @@
  * Macia - Compiler Suite
  */
 
-#include <iostream>
-#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
 #include "lexer/scanner.h"
 #include "parser/parser.h"
 #include "generator/generator.h"
 #include "interpreter/interpreter.h"
+#include "shared/sourcefile.h"
 
 // Supported arguments
 // -o        outfile 
 // -r        run / interpret
+// -j        parser threads, 0 (default) uses one per core
+// -I        directory to search for imported modules
+// -m        also write every namespace as a module
+// -R        number of registers to allocate the code for
 // [ files ] the files to be compiled
 
+/* The compilation unit
+ * Keeps the mapped source and the front-end of a 
+ * single input file alive untill the program is generated */
+typedef struct {
+	SourceFile *pSource;
+	Scanner *pScanner;
+	Parser *pParser;
+} CompilationUnit_t;
+
+/* Creates the default output path from the
+ * first input, the extension is replaced with .mo */
+static void GetDefaultOutput(const char *pInput, char *pBuffer, size_t Length)
+{
+	const char *Extension = strrchr(pInput, '.');
+	const char *Separator = strrchr(pInput, '/');
+	int BaseLength = (int)strlen(pInput);
+
+	/* Only strip the extension of the file name itself */
+	if (Extension != NULL && (Separator == NULL || Extension > Separator)) {
+		BaseLength = (int)(Extension - pInput);
+	}
+	snprintf(pBuffer, Length, "%.*s.mo", BaseLength, pInput);
+}
+
 int main(int argc, char* argv[])
 {
-    std::ifstream fs_in;
+	std::vector<CompilationUnit_t> Units;
+	std::vector<const char*> Inputs;
+	const char *OutputPath = NULL;
+	char DefaultOutput[256];
 	Interpreter *vm = NULL;
 	Generator *ilgen = NULL;
-	Scanner *scrambler = NULL;
-	Parser *parser = NULL;
+	SymbolTable Symbols;
+	std::vector<const char*> ModulePaths;
+	int Run = 0;
+	int Modules = 0;
+	int Threads = 0;
+	int Registers = MACIA_REGISTER_COUNT;
+	int Result = -1;
 
 #ifdef DIAGNOSE
 	printf("macia-lang compiler %s - 2018 oct 12 [%s]\n", VERSION, AUTHOR);
 #endif
 
-    // Sanitize input parameters
-    if (argc == 1) {
-        printf("macia: invalid number of arguments\n");
-        return -1;
-    }
+	/* Parse the arguments */
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-o")) {
+			if (i + 1 >= argc) {
+				printf("macia: -o requires an output file\n");
+				return -1;
+			}
+			OutputPath = argv[++i];
+		}
+		else if (!strcmp(argv[i], "-r")) {
+			Run = 1;
+		}
+		else if (!strcmp(argv[i], "-I")) {
+			if (i + 1 >= argc) {
+				printf("macia: -I requires a directory\n");
+				return -1;
+			}
+			ModulePaths.push_back(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "-m")) {
+			Modules = 1;
+		}
+		else if (!strcmp(argv[i], "-j")) {
+			if (i + 1 >= argc || atoi(argv[i + 1]) < 0) {
+				printf("macia: -j requires a thread count\n");
+				return -1;
+			}
+			Threads = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "-R")) {
+			if (i + 1 >= argc) {
+				printf("macia: -R requires a register count\n");
+				return -1;
+			}
+			Registers = atoi(argv[++i]);
+		}
+		else {
+			Inputs.push_back(argv[i]);
+		}
+	}
 
-	scrambler = new Scanner();
+	// Sanitize input parameters
+	if (Inputs.size() == 0) {
+		printf("macia: no input files\n");
+		return -1;
+	}
 
-#ifdef DIAGNOSE
-	printf(" - Scanning (flength = %u)\n", 0);
-#endif
-	if (scrambler->Scan(NULL, 0)) {
-		printf("Failed to scramble file\n");
-		goto Cleanup;
+	if (OutputPath == NULL) {
+		GetDefaultOutput(Inputs[0], &DefaultOutput[0], sizeof(DefaultOutput));
+		OutputPath = &DefaultOutput[0];
 	}
 
+	/* Run the front-end for every file, the sources are mapped
+	 * and scanned in place, so they must stay resident. All units
+	 * intern into the same symbol table so ids match across files. 
+	 * The parser has no use for comments, so they are never tokenized */
+	for (size_t i = 0; i < Inputs.size(); i++) {
+		CompilationUnit_t NewUnit = { new SourceFile(Inputs[i]), 
+			new Scanner(&Symbols, ScannerSkipComments), NULL };
+		Units.push_back(NewUnit);
+		CompilationUnit_t &Unit = Units.back();
+
+		if (Unit.pSource->Open()) {
+			printf("macia: failed to open %s\n", Inputs[i]);
+			goto Cleanup;
+		}
+
 #ifdef DIAGNOSE
-	printf(" - Parsing (elements = %u)\n", (unsigned)scrambler->GetElements().size());
+		printf(" - Scanning & parsing %s (flength = %u)\n", Inputs[i], (unsigned)Unit.pSource->GetLength());
 #endif
 
-	parser = new Parser(scrambler->GetElements());
-	if (parser->Parse()) {
-		printf("Failed to parse file\n");
-		goto Cleanup;
+		/* The parser pulls tokens as it goes, so lexing 
+		 * overlaps with parsing and no token list is built. 
+		 * Large files are split over threads by declaration */
+		Unit.pScanner->Begin(Unit.pSource->GetData(), Unit.pSource->GetLength());
+		Unit.pParser = new Parser(Unit.pScanner);
+		if (Unit.pParser->Parse(Threads)) {
+			if (Unit.pScanner->GetError()) {
+				printf("Failed to scramble file %s\n", Inputs[i]);
+			}
+			else {
+				printf("Failed to parse file %s\n", Inputs[i]);
+			}
+			goto Cleanup;
+		}
+
+#ifdef DIAGNOSE
+		printf(" - Parsed %u elements\n", (unsigned)Unit.pParser->GetTokenCount());
+#endif
 	}
 
 #ifdef DIAGNOSE
 	printf(" - Generating IL (Bytecode)\n");
 #endif
 
-	ilgen = new Generator(parser->GetProgram());
+	/* Imports are searched for in the given
+	 * directories and then the current one */
+	ilgen = new Generator(NULL, &Symbols);
+	if (ilgen->SetRegisterCount(Registers)) {
+		printf("macia: -R must be between %i and %i\n", MACIA_REGISTER_MIN, MACIA_REGISTER_MAX);
+		goto Cleanup;
+	}
+	for (size_t i = 0; i < Units.size(); i++) {
+		ilgen->AddProgram(Units[i].pParser->GetProgram());
+	}
+	for (size_t i = 0; i < ModulePaths.size(); i++) {
+		ilgen->AddModulePath(ModulePaths[i]);
+	}
+	ilgen->AddModulePath(".");
+
 	if (ilgen->Generate()) {
 		printf("Failed to create bytecode from the AST\n");
 		goto Cleanup;
 	}
-	ilgen->SaveAs("test.mo");
 
+	if (ilgen->SaveAs(OutputPath)) {
+		printf("macia: failed to write %s\n", OutputPath);
+		goto Cleanup;
+	}
+
+	/* The modules go next to the output */
+	if (Modules) {
+		const char *Separator = strrchr(OutputPath, '/');
+		char Directory[256];
+
+		if (Separator != NULL) {
+			snprintf(&Directory[0], sizeof(Directory), "%.*s", (int)(Separator - OutputPath), OutputPath);
+		}
+		else {
+			strcpy(&Directory[0], ".");
+		}
+
+		if (ilgen->SaveModules(&Directory[0])) {
+			goto Cleanup;
+		}
+	}
+	Result = 0;
+
+	if (Run) {
 #ifdef DIAGNOSE
-	printf(" - Executing the code\n");
+		printf(" - Executing the code\n");
 #endif
 
-	vm = new Interpreter(ilgen->GetPool());
-	printf("The interpreter finished with result %i\n", vm->Execute());
-	delete vm;
+		vm = new Interpreter(ilgen->GetPool());
+		printf("The interpreter finished with result %i\n", vm->Execute());
+		delete vm;
+	}
 
 Cleanup:
 #ifdef DIAGNOSE
@@ -97,13 +239,12 @@ Cleanup:
 		delete ilgen;
 	}
 
-	if (parser != NULL) {
-		delete parser;
+	for (size_t i = 0; i < Units.size(); i++) {
+		if (Units[i].pParser != NULL) {
+			delete Units[i].pParser;
+		}
+		delete Units[i].pScanner;
+		delete Units[i].pSource;
 	}
-
-	if (scrambler != NULL) {
-		delete scrambler;
-	}
-	return 0;
+	return Result;
 }
-
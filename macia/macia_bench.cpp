@@ -0,0 +1,421 @@
+/* The Macia Language (MACIA)
+ *
+ * Copyright 2016, Philip Meulengracht
+ *
+ * This program is free software : you can redistribute it and / or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation ? , either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Macia - Front-end Benchmark
+ */
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include "lexer/scanner.h"
+#include "parser/parser.h"
+#include "generator/generator.h"
+#include "shared/stringbuilder.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Supported arguments
+// -r        repetitions per measurement, the best is reported
+// -s        size multiplier for the corpora
+// -j        parser threads, 0 uses one per core
+
+/* Repetitions of every measurement */
+#define BENCH_REPETITIONS	3
+
+/* The corpora
+ * Every corpus stresses a different part of the front-end */
+typedef enum {
+	CorpusExpressions,
+	CorpusFunctions,
+	CorpusComments,
+	CorpusStrings,
+
+	CorpusCount
+} Corpus_t;
+
+static const char *__CorpusNames[CorpusCount] = {
+	"expressions", "functions", "comments", "strings"
+};
+
+/* Number of units in each corpus size */
+static const int __CorpusSizes[] = { 64, 256, 1024 };
+static const char *__CorpusSizeNames[] = { "small", "medium", "large" };
+#define BENCH_SIZE_COUNT	(int)(sizeof(__CorpusSizes) / sizeof(__CorpusSizes[0]))
+
+/* The result of a single measurement */
+typedef struct {
+	double Seconds;
+	size_t Count;
+} Measurement_t;
+
+/* Appends formatted text to the corpus */
+static void Emit(StringBuilder *Out, const char *Format, ...)
+{
+	char Buffer[256];
+	va_list Arguments;
+	int Length;
+
+	va_start(Arguments, Format);
+	Length = vsnprintf(&Buffer[0], sizeof(Buffer), Format, Arguments);
+	va_end(Arguments);
+
+	if (Length > 0) {
+		Out->Append(&Buffer[0], ((size_t)Length < sizeof(Buffer)) ? (size_t)Length : (sizeof(Buffer) - 1));
+	}
+}
+
+/* Builds a corpus of the given number of units, every 
+ * corpus is a valid program with a Program.Main */
+static void BuildCorpus(Corpus_t Corpus, int Units, StringBuilder *Out)
+{
+	Out->Reset();
+	Emit(Out, "object Program {\n");
+
+	for (int i = 0; i < Units; i++) {
+		switch (Corpus) {
+
+			/* Nested expressions over a few variables */
+			case CorpusExpressions: {
+				Emit(Out, "    func Expr%i() {\n", i);
+				Emit(Out, "        int a = %i;\n        int b = a * 3 + 7;\n", i);
+				Emit(Out, "        int c = ((((((%i - a) * b) + a) / b) - a) * b) + a;\n", i + 1);
+				Emit(Out, "        a = (((((((c * 2) + a) - b) / c) * a) + b) - c) * -5;\n");
+				Emit(Out, "        b = a * b + c / 2 - a * 4 + b / 3 - c * 7 + %i;\n", i);
+				Emit(Out, "    }\n");
+			} break;
+
+			/* Many small functions and members */
+			case CorpusFunctions: {
+				Emit(Out, "    int Member%i = %i;\n", i, i);
+				Emit(Out, "    func Function%i() {\n", i);
+				Emit(Out, "        int Local = %i;\n        Local = Local + 1;\n    }\n", i);
+			} break;
+
+			/* Long comments around little code */
+			case CorpusComments: {
+				Emit(Out, "    /* Block comment %i\n", i);
+				for (int j = 0; j < 8; j++) {
+					Emit(Out, "     * This line of the comment only has to be skipped by the scanner %i\n", j);
+				}
+				Emit(Out, "     */\n");
+				for (int j = 0; j < 4; j++) {
+					Emit(Out, "    // Line comment %i of %i, also skipped entirely\n", j, i);
+				}
+				Emit(Out, "    int Commented%i = %i;\n", i, i);
+			} break;
+
+			/* String literals */
+			case CorpusStrings: {
+				Emit(Out, "    string Text%i = \"String literal number %i with some text to copy\";\n", i, i);
+			} break;
+
+			default:
+				break;
+		}
+	}
+
+	Emit(Out, "    func Program() { }\n    func Main() { }\n}\n");
+}
+
+/* Counts the statements and expressions of an AST */
+static size_t CountExpression(Expression *pExpr)
+{
+	if (pExpr == NULL) {
+		return 0;
+	}
+	if (pExpr->GetType() == ExprBinary) {
+		BinaryExpression *Binary = (BinaryExpression*)pExpr;
+		return 1 + CountExpression(Binary->GetExpression1()) 
+			+ CountExpression(Binary->GetExpression2());
+	}
+	if (pExpr->GetType() == ExprUnary) {
+		return 1 + CountExpression(((UnaryExpression*)pExpr)->GetExpression());
+	}
+	if (pExpr->GetType() == ExprCall) {
+		CallExpression *Call = (CallExpression*)pExpr;
+		size_t Count = 1;
+		for (size_t i = 0; i < Call->GetArgumentCount(); i++) {
+			Count += CountExpression(Call->GetArgument(i));
+		}
+		return Count;
+	}
+	return 1;
+}
+
+static size_t CountStatement(Statement *pStmt)
+{
+	if (pStmt == NULL) {
+		return 0;
+	}
+	switch (pStmt->GetType()) {
+		case StmtSequence: {
+			Sequence *Seq = (Sequence*)pStmt;
+			size_t Count = 1;
+			for (size_t i = 0; i < Seq->GetCount(); i++) {
+				Count += CountStatement(Seq->GetStatement(i));
+			}
+			return Count;
+		}
+		case StmtNamespace:
+			return 1 + CountStatement(((Namespace*)pStmt)->GetBody());
+		case StmtImport:
+			return 1;
+		case StmtObject:
+			return 1 + CountStatement(((Object*)pStmt)->GetBody());
+		case StmtFunction:
+			return 1 + ((Function*)pStmt)->GetParameterCount() 
+				+ CountStatement(((Function*)pStmt)->GetBody());
+		case StmtCall:
+			return 1 + CountExpression(((Call*)pStmt)->GetCall());
+		case StmtDeclaration:
+			return 1 + CountExpression(((Declaration*)pStmt)->GetExpression());
+		case StmtAssign:
+			return 1 + CountExpression(((Assignment*)pStmt)->GetExpression());
+		default:
+			return 1;
+	}
+}
+
+/* Seconds since the last call */
+static double Elapsed(std::chrono::steady_clock::time_point *Start)
+{
+	std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+	double Seconds = std::chrono::duration<double>(Now - *Start).count();
+	*Start = Now;
+	return Seconds;
+}
+
+/* Gets the peak resident set size in kilobytes, 
+ * 0 where it can't be queried. It is the peak of 
+ * the process, so every corpus is run in its own */
+static long PeakResidentSize()
+{
+#if defined(__unix__) || defined(__APPLE__)
+	struct rusage Usage;
+	if (getrusage(RUSAGE_SELF, &Usage) == 0) {
+#if defined(__APPLE__)
+		return Usage.ru_maxrss / 1024;
+#else
+		return Usage.ru_maxrss;
+#endif
+	}
+#endif
+	return 0;
+}
+
+/* Parses the corpus into a new parser, the
+ * scanner must outlive the parser */
+static Parser *ParseCorpus(Scanner *pScanner, StringBuilder *Corpus, int Threads)
+{
+	Parser *pParser;
+
+	pScanner->Begin(Corpus->GetData(), Corpus->GetLength());
+	pParser = new Parser(pScanner);
+	if (pParser->Parse(Threads)) {
+		delete pParser;
+		return NULL;
+	}
+	return pParser;
+}
+
+/* Runs every phase on the corpus, the best of the 
+ * repetitions is kept. The source bytes per second
+ * are those of the scan alone, the generated bytes 
+ * those of the code without the data pool. 
+ * Returns 0 on success */
+static int Measure(StringBuilder *Corpus, int Repetitions, int Threads, 
+	Measurement_t *Scan, Measurement_t *Parse, Measurement_t *Generate)
+{
+	SymbolTable Symbols;
+	Scanner ScanOnly(&Symbols);
+	Scanner ParseScanner(&Symbols, ScannerSkipComments);
+	std::chrono::steady_clock::time_point Start;
+	double Seconds;
+
+	Scan->Seconds = Parse->Seconds = Generate->Seconds = 0.0;
+	Scan->Count = Parse->Count = Generate->Count = 0;
+	for (int i = 0; i < Repetitions; i++) {
+		Parser *pParser;
+		Generator *pGenerator;
+
+		/* Scanning alone pulls every token like the parser does */
+		Start = std::chrono::steady_clock::now();
+		ScanOnly.Begin(Corpus->GetData(), Corpus->GetLength());
+		while (ScanOnly.NextToken().Type != UNKNOWN) {
+		}
+		if (ScanOnly.GetError()) {
+			return -1;
+		}
+		Seconds = Elapsed(&Start);
+		if (i == 0 || Seconds < Scan->Seconds) {
+			Scan->Seconds = Seconds;
+		}
+		Scan->Count = ScanOnly.GetTokenCount();
+
+		/* The parser pulls its tokens, so this includes scanning */
+		pParser = ParseCorpus(&ParseScanner, Corpus, Threads);
+		Seconds = Elapsed(&Start);
+		if (pParser == NULL) {
+			return -1;
+		}
+		if (i == 0 || Seconds < Parse->Seconds) {
+			Parse->Seconds = Seconds;
+		}
+		Parse->Count = CountStatement(pParser->GetProgram());
+
+		/* The generator works on the fresh tree */
+		pGenerator = new Generator(pParser->GetProgram(), &Symbols);
+		Start = std::chrono::steady_clock::now();
+		if (pGenerator->Generate()) {
+			delete pGenerator;
+			delete pParser;
+			return -1;
+		}
+		Seconds = Elapsed(&Start);
+		if (i == 0 || Seconds < Generate->Seconds) {
+			Generate->Seconds = Seconds;
+		}
+		Generate->Count = pGenerator->GetCode().size();
+
+		delete pGenerator;
+		delete pParser;
+	}
+	return 0;
+}
+
+/* Formats a rate with a metric suffix */
+static const char *FormatRate(char *pBuffer, size_t Length, size_t Count, double Seconds)
+{
+	double Rate = (Seconds > 0.0) ? ((double)Count / Seconds) : 0.0;
+	if (Rate >= 1e9) {
+		snprintf(pBuffer, Length, "%.2fG", Rate / 1e9);
+	}
+	else if (Rate >= 1e6) {
+		snprintf(pBuffer, Length, "%.2fM", Rate / 1e6);
+	}
+	else if (Rate >= 1e3) {
+		snprintf(pBuffer, Length, "%.2fk", Rate / 1e3);
+	}
+	else {
+		snprintf(pBuffer, Length, "%.2f", Rate);
+	}
+	return pBuffer;
+}
+
+/* Builds and measures a single corpus and prints 
+ * its row, returns 0 on success */
+static int RunCorpus(Corpus_t Kind, int Size, int Multiplier, int Repetitions, int Threads)
+{
+	StringBuilder Corpus;
+	Measurement_t Scan = { 0.0, 0 }, Parse = { 0.0, 0 }, Generate = { 0.0, 0 };
+	char Source[32], Tokens[32], Nodes[32], Bytes[32];
+
+	BuildCorpus(Kind, __CorpusSizes[Size] * Multiplier, &Corpus);
+	if (Measure(&Corpus, Repetitions, Threads, &Scan, &Parse, &Generate)) {
+		printf("%-12s %-7s %10u failed\n", __CorpusNames[Kind], 
+			__CorpusSizeNames[Size], (unsigned)Corpus.GetLength());
+		return -1;
+	}
+
+	printf("%-12s %-7s %10u %12s %12s %12s %14s %8ldkB\n", __CorpusNames[Kind], 
+		__CorpusSizeNames[Size], (unsigned)Corpus.GetLength(),
+		FormatRate(&Source[0], sizeof(Source), Corpus.GetLength(), Scan.Seconds),
+		FormatRate(&Tokens[0], sizeof(Tokens), Scan.Count, Scan.Seconds),
+		FormatRate(&Nodes[0], sizeof(Nodes), Parse.Count, Parse.Seconds),
+		FormatRate(&Bytes[0], sizeof(Bytes), Generate.Count, Generate.Seconds),
+		PeakResidentSize());
+	return 0;
+}
+
+/* Runs a corpus in a child process where fork is 
+ * available, so the peak rss is that of the corpus 
+ * and not of the largest one measured before it */
+static int IsolateCorpus(Corpus_t Kind, int Size, int Multiplier, int Repetitions, int Threads)
+{
+#if defined(__unix__) || defined(__APPLE__)
+	int Status = 0;
+	pid_t Child;
+
+	fflush(stdout);
+	Child = fork();
+	if (Child == 0) {
+		int Result = RunCorpus(Kind, Size, Multiplier, Repetitions, Threads);
+		fflush(stdout);
+		_exit((Result == 0) ? 0 : 1);
+	}
+	if (Child > 0) {
+		if (waitpid(Child, &Status, 0) != Child
+			|| !WIFEXITED(Status) || WEXITSTATUS(Status) != 0) {
+			return -1;
+		}
+		return 0;
+	}
+#endif
+	return RunCorpus(Kind, Size, Multiplier, Repetitions, Threads);
+}
+
+int main(int argc, char* argv[])
+{
+	int Repetitions = BENCH_REPETITIONS;
+	int Multiplier = 1;
+	int Threads = 1;
+	int Result = 0;
+
+	/* Parse the arguments */
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-r") && i + 1 < argc) {
+			Repetitions = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+			Multiplier = atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i], "-j") && i + 1 < argc) {
+			Threads = atoi(argv[++i]);
+		}
+		else {
+			printf("usage: macia_bench [-r repetitions] [-s size multiplier] [-j threads]\n");
+			return -1;
+		}
+	}
+	if (Repetitions < 1 || Multiplier < 1 || Threads < 0) {
+		printf("macia_bench: repetitions and sizes must be positive\n");
+		return -1;
+	}
+
+#ifdef DIAGNOSE
+	printf("macia_bench: built with the DIAGNOSE trace, configure with "
+		"-DMACIA_DIAGNOSE=OFF for meaningful generator numbers\n");
+#endif
+
+	printf("%-12s %-7s %10s %12s %12s %12s %14s %10s\n", "corpus", "size", "bytes",
+		"scan B/s", "tokens/s", "nodes/s", "bytecode B/s", "peak rss");
+	for (int Kind = 0; Kind < CorpusCount; Kind++) {
+		for (int Size = 0; Size < BENCH_SIZE_COUNT; Size++) {
+			if (IsolateCorpus((Corpus_t)Kind, Size, Multiplier, Repetitions, Threads)) {
+				Result = -1;
+			}
+		}
+	}
+	return Result;
+}
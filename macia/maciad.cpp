@@ -0,0 +1,163 @@
+/* The Macia Language (MACIA)
+ *
+ * Copyright 2016, Philip Meulengracht
+ *
+ * This program is free software : you can redistribute it and / or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation ? , either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.If not, see <http://www.gnu.org/licenses/>.
+ *
+ *
+ * Macia - Language Server
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "parser/document.h"
+
+// Requests are read from stdin, one per line, text
+// follows a request as exactly <length> raw bytes
+// open <length>                      replaces the document
+// change <offset> <removed> <length> edits the document
+// exit                               stops the server
+//
+// Every open and change is answered on stdout with 
+// parsed <declarations> <reparsed> <diagnostics>
+// followed by a line per diagnostic:
+// <line> <column> <message>
+// Texts longer than MACIAD_TEXT_LIMIT are skipped and
+// answered with an error
+
+/* Longest request line */
+#define MACIAD_REQUEST_SIZE 256
+
+/* Longest text of a request */
+#define MACIAD_TEXT_LIMIT	(256 * 1024 * 1024)
+
+/* Skips the text of a request that is too long */
+static void SkipText(size_t Length)
+{
+	char Buffer[4096];
+	while (Length != 0) {
+		size_t Chunk = (Length < sizeof(Buffer)) ? Length : sizeof(Buffer);
+		if (fread(&Buffer[0], 1, Chunk, stdin) != Chunk) {
+			return;
+		}
+		Length -= Chunk;
+	}
+}
+
+/* Reads the text following a request, 
+ * returns NULL when it can't be read */
+static char *ReadText(size_t Length)
+{
+	char *Text;
+
+	/* Never allocate what the length says 
+	 * before it is known to be sane */
+	if (Length > MACIAD_TEXT_LIMIT) {
+		SkipText(Length);
+		return NULL;
+	}
+
+	Text = (char*)malloc(Length + 1);
+	if (Text == NULL) {
+		return NULL;
+	}
+	if (fread(Text, 1, Length, stdin) != Length) {
+		free(Text);
+		return NULL;
+	}
+	Text[Length] = '\0';
+	return Text;
+}
+
+/* Writes a message on a single line, messages 
+ * can quote source text that has line breaks */
+static void WriteMessage(int Line, int Column, const char *Message)
+{
+	printf("%i %i ", Line, Column);
+	for (const char *Character = Message; *Character != '\0'; Character++) {
+		putchar((*Character == '\n' || *Character == '\r') ? ' ' : *Character);
+	}
+	putchar('\n');
+}
+
+/* Answers a request with the state of the document */
+static void Respond(Document *Doc)
+{
+	printf("parsed %u %u %u\n", (unsigned)Doc->GetDeclarationCount(), 
+		(unsigned)Doc->GetReparsed(), (unsigned)Doc->GetDiagnosticCount());
+	for (size_t i = 0; i < Doc->GetDeclarationCount(); i++) {
+		DocumentDeclaration_t &Declaration = Doc->GetDeclaration(i);
+		for (size_t j = 0; j < Declaration.Diagnostics->size(); j++) {
+			DocumentDiagnostic_t &Diagnostic = (*Declaration.Diagnostics)[j];
+
+			/* Messages without a position are 
+			 * given the one of the declaration */
+			if (Diagnostic.Line == 0) {
+				WriteMessage(Declaration.Line, 1, Diagnostic.Message);
+			}
+			else {
+				WriteMessage(Diagnostic.Line, Diagnostic.Column, Diagnostic.Message);
+			}
+		}
+	}
+	fflush(stdout);
+}
+
+int main(int argc, char* argv[])
+{
+	char Request[MACIAD_REQUEST_SIZE];
+	SymbolTable Symbols;
+	Document Doc(&Symbols);
+
+	(void)argc;
+	(void)argv;
+
+	/* Serve requests untill the editor goes away */
+	while (fgets(&Request[0], sizeof(Request), stdin) != NULL) {
+		unsigned long Offset, Removed, Length;
+		char *Text = NULL;
+		int Result = -1;
+
+		if (!strncmp(&Request[0], "exit", 4)) {
+			break;
+		}
+		else if (sscanf(&Request[0], "open %lu", &Length) == 1) {
+			Text = ReadText(Length);
+			if (Text != NULL) {
+				Result = Doc.Open(Text, Length);
+			}
+		}
+		else if (sscanf(&Request[0], "change %lu %lu %lu", &Offset, &Removed, &Length) == 3) {
+			Text = ReadText(Length);
+			if (Text != NULL) {
+				Result = Doc.Change(Offset, Removed, Text, Length);
+			}
+		}
+		else {
+			printf("error unknown request\n");
+			fflush(stdout);
+			continue;
+		}
+		free(Text);
+
+		if (Result) {
+			printf("error invalid request\n");
+			fflush(stdout);
+			continue;
+		}
+		Respond(&Doc);
+	}
+	return 0;
+}
@@ -0,0 +1,320 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Document (Parser)
+* - Keeps an edited source parsed per top-level declaration
+*/
+
+/* Includes */
+#include "document.h"
+#include "../shared/diagnostics.h"
+#include <cstdlib>
+#include <cstring>
+
+/* Collects the messages of a declaration, the context 
+ * points to the list of the declaration being parsed. The
+ * trailing newline is dropped */
+static void CollectDiagnostic(void *Context, int Line, int Column, const char *Message)
+{
+	std::vector<DocumentDiagnostic_t> *Diagnostics = *(std::vector<DocumentDiagnostic_t>**)Context;
+	size_t Length = strlen(Message);
+	DocumentDiagnostic_t Diagnostic;
+
+	if (Length != 0 && Message[Length - 1] == '\n') {
+		Length--;
+	}
+
+	Diagnostic.Line = Line;
+	Diagnostic.Column = Column;
+	Diagnostic.Message = (char*)malloc(Length + 1);
+	if (Diagnostic.Message != NULL) {
+		memcpy(Diagnostic.Message, Message, Length);
+		Diagnostic.Message[Length] = '\0';
+		Diagnostics->push_back(Diagnostic);
+	}
+}
+
+/* Counts the newlines of a text */
+static int CountLines(const char *pText, size_t Length)
+{
+	int Lines = 0;
+	for (size_t i = 0; i < Length; i++) {
+		if (pText[i] == '\n') {
+			Lines++;
+		}
+	}
+	return Lines;
+}
+
+/* Finds the column of an offset by 
+ * looking back for the start of its line */
+static int FindColumn(const char *pText, size_t Offset)
+{
+	size_t Start = Offset;
+	while (Start != 0 && pText[Start - 1] != '\n') {
+		Start--;
+	}
+	return (int)(Offset - Start) + 1;
+}
+
+/* Constructor
+ * The document starts out empty, identifiers 
+ * are interned into the given symbol table */
+Document::Document(SymbolTable *Symbols) : m_Scanner(Symbols, ScannerSkipComments) {
+	m_pText = NULL;
+	m_iLength = 0;
+	m_iCapacity = 0;
+	m_iReparsed = 0;
+}
+
+/* Destructor
+ * Cleans up the declarations and the text */
+Document::~Document() {
+	for (size_t i = 0; i < m_lDeclarations.size(); i++) {
+		FreeDeclaration(&m_lDeclarations[i]);
+	}
+	free(m_pText);
+}
+
+/* Cleans up the program and the messages of a declaration */
+void Document::FreeDeclaration(DocumentDeclaration_t *Declaration) {
+	delete Declaration->Nodes;
+	for (size_t i = 0; i < Declaration->Diagnostics->size(); i++) {
+		free((*Declaration->Diagnostics)[i].Message);
+	}
+	delete Declaration->Diagnostics;
+}
+
+/* Makes room for a text of the given length, 
+ * the text grows geometrically as it is edited */
+int Document::Reserve(size_t Length) {
+	size_t Capacity = (m_iCapacity == 0) ? 256 : m_iCapacity;
+	char *Text;
+
+	if (Length <= m_iCapacity) {
+		return 0;
+	}
+	while (Capacity < Length) {
+		Capacity *= 2;
+	}
+
+	Text = (char*)realloc(m_pText, Capacity);
+	if (Text == NULL) {
+		return -1;
+	}
+	m_pText = Text;
+	m_iCapacity = Capacity;
+	return 0;
+}
+
+/* Counts the messages of all declarations */
+size_t Document::GetDiagnosticCount() {
+	size_t Count = 0;
+	for (size_t i = 0; i < m_lDeclarations.size(); i++) {
+		Count += m_lDeclarations[i].Diagnostics->size();
+	}
+	return Count;
+}
+
+/* Replaces the text and parses all of it, 
+ * returns 0 on success */
+int Document::Open(const char *pText, size_t Length) {
+	
+	/* Sanity */
+	if (Reserve(Length)) {
+		return -1;
+	}
+
+	/* Drop everything we had */
+	for (size_t i = 0; i < m_lDeclarations.size(); i++) {
+		FreeDeclaration(&m_lDeclarations[i]);
+	}
+	m_lDeclarations.clear();
+
+	memcpy(m_pText, pText, Length);
+	m_iLength = Length;
+	m_iReparsed = 0;
+
+	/* No declarations to line up with */
+	ParseFrom(0, 0, 0, 0);
+	return 0;
+}
+
+/* Replaces Removed bytes at Offset with the given text, 
+ * and parses what it changed. Returns 0 on success */
+int Document::Change(size_t Offset, size_t Removed, const char *pText, size_t Length) {
+
+	/* Variables */
+	size_t End = Offset + Removed;
+	size_t First = 0, Last = 0;
+	int LineDelta;
+
+	/* Sanity */
+	if (Offset > m_iLength || Removed > m_iLength - Offset
+		|| Reserve(m_iLength - Removed + Length)) {
+		return -1;
+	}
+
+	/* Find the declarations the edit touches, the first one
+	 * either contains it or read into it while being parsed */
+	while (First + 1 < m_lDeclarations.size() 
+		&& m_lDeclarations[First].Scanned < Offset
+		&& m_lDeclarations[First + 1].Start < Offset) {
+		First++;
+	}
+	Last = First;
+	while (Last < m_lDeclarations.size() 
+		&& m_lDeclarations[Last].Start <= End) {
+		Last++;
+	}
+
+	/* Apply the edit */
+	LineDelta = CountLines(pText, Length) - CountLines(m_pText + Offset, Removed);
+	memmove(m_pText + Offset + Length, m_pText + End, m_iLength - End);
+	memcpy(m_pText + Offset, pText, Length);
+	m_iLength = m_iLength - Removed + Length;
+	m_iReparsed = 0;
+
+	/* Declarations from Last on start after the edit */
+	ParseFrom(First, Last, (long long)Length - (long long)Removed, LineDelta);
+	return 0;
+}
+
+/* Parses declarations from the start of declaration First. The 
+ * declarations from Resume on were parsed before the edit and 
+ * start Delta bytes and LineDelta lines later now, parsing stops 
+ * as soon as the next declaration starts where one of them does */
+void Document::ParseFrom(size_t First, size_t Resume, long long Delta, int LineDelta) {
+
+	/* Variables */
+	std::vector<DocumentDeclaration_t> Parsed;
+	std::vector<DocumentDiagnostic_t> *Diagnostics = new std::vector<DocumentDiagnostic_t>();
+	size_t Start = (First < m_lDeclarations.size()) ? m_lDeclarations[First].Start : 0;
+	int Line = (First < m_lDeclarations.size()) ? m_lDeclarations[First].Line : 1;
+	size_t Kept = m_lDeclarations.size();
+	int Result;
+
+	/* Messages go to the declaration being parsed */
+	SetDiagnosticHandler(CollectDiagnostic, &Diagnostics);
+	m_Scanner.Begin(m_pText + Start, m_iLength - Start, Line, FindColumn(m_pText, Start));
+	while (1) {
+		DocumentDeclaration_t Declaration = { Start, Start, Line, NULL, NULL, NULL };
+		const Token_t &Next = m_Scanner.Peek(0);
+
+		/* The rest is only comments, or the scanner stopped */
+		if (Next.Type == UNKNOWN) {
+			break;
+		}
+
+		/* Does an old declaration start here? Then
+		 * everything from it on is still valid */
+		if (Parsed.size() != 0) {
+			Declaration.Start = Start + m_Scanner.GetStart(Next);
+			Declaration.Line = m_Scanner.GetLine(Next);
+			while (Resume < m_lDeclarations.size()
+				&& (long long)m_lDeclarations[Resume].Start + Delta < (long long)Declaration.Start) {
+				Resume++;
+			}
+			if (Resume < m_lDeclarations.size()
+				&& (long long)m_lDeclarations[Resume].Start + Delta == (long long)Declaration.Start) {
+				Kept = Resume;
+				break;
+			}
+		}
+
+		/* A declaration that fails, or that the scanner stops in, 
+		 * covers the rest of the text like it would stop a compile */
+		Declaration.Diagnostics = Diagnostics;
+		Parsed.push_back(Declaration);
+		m_iReparsed++;
+		Parsed.back().Nodes = new Arena(DOCUMENT_ARENA_BLOCK_SIZE);
+		Parser DocParser(&m_Scanner, Parsed.back().Nodes);
+		Result = DocParser.ParseDeclaration(&Parsed.back().Program);
+		Parsed.back().Scanned = Start + m_Scanner.GetPosition();
+		if (Result < 0 || m_Scanner.GetError()) {
+			Parsed.back().Scanned = m_iLength;
+			break;
+		}
+		Diagnostics = new std::vector<DocumentDiagnostic_t>();
+	}
+	SetDiagnosticHandler(NULL, NULL);
+
+	/* Scanner messages without a declaration to 
+	 * parse go to the one before, if there is one */
+	if (Parsed.size() == 0 || Parsed.back().Diagnostics != Diagnostics) {
+		if (Diagnostics->size() != 0) {
+			if (Parsed.size() == 0) {
+				DocumentDeclaration_t Declaration = { Start, m_iLength, Line, NULL, NULL, Diagnostics };
+				Parsed.push_back(Declaration);
+				Diagnostics = NULL;
+			}
+			else {
+				Parsed.back().Diagnostics->insert(Parsed.back().Diagnostics->end(), 
+					Diagnostics->begin(), Diagnostics->end());
+				Diagnostics->clear();
+			}
+		}
+		delete Diagnostics;
+	}
+
+	/* Replace the declarations that were parsed again */
+	for (size_t i = First; i < Kept; i++) {
+		FreeDeclaration(&m_lDeclarations[i]);
+	}
+	m_lDeclarations.erase(m_lDeclarations.begin() + First, m_lDeclarations.begin() + Kept);
+	m_lDeclarations.insert(m_lDeclarations.begin() + First, Parsed.begin(), Parsed.end());
+
+	/* Move the kept ones */
+	for (size_t i = First + Parsed.size(); i < m_lDeclarations.size(); i++) {
+		m_lDeclarations[i].Start = (size_t)((long long)m_lDeclarations[i].Start + Delta);
+		m_lDeclarations[i].Scanned = (size_t)((long long)m_lDeclarations[i].Scanned + Delta);
+		m_lDeclarations[i].Line += LineDelta;
+	}
+
+	/* The messages of declarations that moved 
+	 * are reported again with their new position */
+	for (size_t i = First + Parsed.size(); (Delta != 0 || LineDelta != 0) && i < m_lDeclarations.size(); i++) {
+		if (m_lDeclarations[i].Diagnostics->size() != 0) {
+			ReparseDeclaration(i);
+		}
+	}
+}
+
+/* Parses a declaration again in place, it reads 
+ * the same text as before so it ends in the same place */
+void Document::ReparseDeclaration(size_t Index) {
+	DocumentDeclaration_t &Declaration = m_lDeclarations[Index];
+
+	FreeDeclaration(&Declaration);
+	Declaration.Program = NULL;
+	Declaration.Nodes = new Arena(DOCUMENT_ARENA_BLOCK_SIZE);
+	Parser DocParser(&m_Scanner, Declaration.Nodes);
+	Declaration.Diagnostics = new std::vector<DocumentDiagnostic_t>();
+
+	SetDiagnosticHandler(CollectDiagnostic, &Declaration.Diagnostics);
+	m_Scanner.Begin(m_pText + Declaration.Start, m_iLength - Declaration.Start, 
+		Declaration.Line, FindColumn(m_pText, Declaration.Start));
+	DocParser.ParseDeclaration(&Declaration.Program);
+
+	/* The last one also owns the errors of the text after it */
+	if (Index + 1 == m_lDeclarations.size()) {
+		m_Scanner.Peek(0);
+	}
+	SetDiagnosticHandler(NULL, NULL);
+	m_iReparsed++;
+}
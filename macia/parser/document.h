@@ -0,0 +1,99 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Document (Parser)
+* - Keeps an edited source parsed per top-level declaration
+*/
+#pragma once
+
+/* Includes */
+#include "parser.h"
+#include <vector>
+
+/* Block size of the declaration arenas, most 
+ * declarations are small and there are many */
+#define DOCUMENT_ARENA_BLOCK_SIZE	1024
+
+/* A message of the parse, at the position 
+ * of the token it is about */
+typedef struct {
+	int Line;
+	int Column;
+	char *Message;
+} DocumentDiagnostic_t;
+
+/* A top-level declaration of the document
+ * Declarations tile the text, each runs from its first token 
+ * up to the first token of the next one, so comments and 
+ * whitespace after it belong to it. The first declaration 
+ * starts at the beginning of the text. The parser may look 
+ * past the end, Scanned is how far the text was read. The 
+ * program lives in an arena of its own, so a declaration
+ * is dropped without touching the others */
+typedef struct {
+	size_t Start;
+	size_t Scanned;
+	int Line;
+	Statement *Program;
+	Arena *Nodes;
+	std::vector<DocumentDiagnostic_t> *Diagnostics;
+} DocumentDeclaration_t;
+
+/* The document class
+ * Holds the text of a source being edited. An edit only 
+ * re-scans and re-parses from the declaration it starts in, 
+ * untill the scanner lines up with a declaration that was 
+ * parsed before the edit again, all other declarations and
+ * their programs are kept */
+class Document
+{
+public:
+	Document(SymbolTable *Symbols);
+	~Document();
+
+	/* Replaces the text and parses all of it, 
+	 * returns 0 on success */
+	int Open(const char *pText, size_t Length);
+
+	/* Replaces Removed bytes at Offset with the given text, 
+	 * and parses what it changed. Returns 0 on success */
+	int Change(size_t Offset, size_t Removed, const char *pText, size_t Length);
+
+	/* Gets */
+	const char *GetText() { return m_pText; }
+	size_t GetLength() { return m_iLength; }
+	size_t GetDeclarationCount() { return m_lDeclarations.size(); }
+	DocumentDeclaration_t &GetDeclaration(size_t Index) { return m_lDeclarations[Index]; }
+	size_t GetReparsed() { return m_iReparsed; }
+	size_t GetDiagnosticCount();
+
+private:
+	/* Private - Functions */
+	int Reserve(size_t Length);
+	void ParseFrom(size_t First, size_t Resume, long long Delta, int LineDelta);
+	void ReparseDeclaration(size_t Index);
+	void FreeDeclaration(DocumentDeclaration_t *Declaration);
+
+	/* Private - Data */
+	Scanner m_Scanner;
+	std::vector<DocumentDeclaration_t> m_lDeclarations;
+	char *m_pText;
+	size_t m_iLength;
+	size_t m_iCapacity;
+	size_t m_iReparsed;
+};
@@ -23,8 +23,10 @@
 #pragma once
 
 /* Includes */
+#include "../shared/arena.h"
 #include <cstring>
 #include <cstdlib>
+#include <new>
 
 /* Expression Types */
 typedef enum
@@ -33,8 +35,11 @@ typedef enum
 
 	ExprString,
 	ExprInteger,
+	ExprFloat,
 
-	ExprBinary
+	ExprUnary,
+	ExprBinary,
+	ExprCall
 
 } ExpressionType_t;
 
@@ -44,29 +49,42 @@ typedef enum
 	ExprOperatorAdd,
 	ExprOperatorSubtract,
 	ExprOperatorMultiply,
-	ExprOperatorDivide
+	ExprOperatorDivide,
+	ExprOperatorRemainder
 
 } ExpressionBinaryOperator_t;
 
+/* Expression Unary Operator Types */
+typedef enum 
+{
+	ExprOperatorNegate
+
+} ExpressionUnaryOperator_t;
+
 /* The base-class
  * An expression is the base class */
 class Expression
 {
 public:
-	Expression(ExpressionType_t Type) { m_eType = Type; m_iSolved = 0; }
-	virtual ~Expression() {}
+	Expression(ExpressionType_t Type) { m_eType = Type; }
 
-	/* Sets */
-	void SetSolved() { m_iSolved = 1; }
+	/* Expressions live in the arena of the parse 
+	 * and are released with it, never one by one */
+	static void *operator new(size_t Size, Arena *pArena) {
+		void *Memory = pArena->Allocate(Size);
+		if (Memory == NULL) {
+			throw std::bad_alloc();
+		}
+		return Memory;
+	}
+	static void operator delete(void *, Arena *) { }
 
 	/* Gets */
 	ExpressionType_t GetType() { return m_eType; }
-	int IsSolved() { return m_iSolved; }
 
 private:
 	/* Private - Data */
 	ExpressionType_t m_eType;
-	int m_iSolved;
 };
 
 /* A variable, this can pretty much be a reference
@@ -75,23 +93,24 @@ class Variable : public Expression
 {
 public:
 	/* Variable Constructor 
-	 * Set type and create a copy of the name */
-	Variable(const char *pIdentifier) : Expression(ExprVariable) {
-		m_pIdentifier = strdup(pIdentifier);
+	 * Set type and store the symbol id of the name */
+	Variable(int Identifier) : Expression(ExprVariable) {
+		m_iIdentifier = Identifier;
 	}
 
-	/* Variable Deconstructor
-	 * Handle cleanup */
-	~Variable() {
-		free(m_pIdentifier);
-	}
 	
+	/* Update identifier, when the symbol 
+	 * moves to another symbol table */
+	void SetIdentifier(int Identifier) {
+		m_iIdentifier = Identifier;
+	}
+
 	/* Gets */
-	char *GetIdentifier() { return m_pIdentifier; }
+	int GetIdentifier() { return m_iIdentifier; }
 
 private:
 	/* Private - Data*/
-	char *m_pIdentifier;
+	int m_iIdentifier;
 };
 
 /* A string literal, this is a string value */
@@ -99,17 +118,12 @@ class StringValue : public Expression
 {
 public:
 	/* Variable Constructor 
-	 * Set type and create a copy of the name */
-	StringValue(const char *pValue) : Expression(ExprString) {
-		m_pValue = strdup(pValue);
+	 * Set type and store the text, it is 
+	 * kept in the arena with the node */
+	StringValue(char *pValue) : Expression(ExprString) {
+		m_pValue = pValue;
 	}
 
-	/* Variable Deconstructor
-	 * Handle cleanup */
-	~StringValue() {
-		free(m_pValue);
-	}
-	
 	/* Gets */
 	char *GetValue() { return m_pValue; }
 
@@ -123,21 +137,65 @@ class IntValue : public Expression
 {
 public:
 	/* Variable Constructor
-	 * Set type and create a copy of the name */
-	IntValue(const char *pValue) : Expression(ExprInteger) {
-		m_iValue = atoi(pValue);
+	 * Set type and store the value the scanner read */
+	IntValue(long long Value) : Expression(ExprInteger) {
+		m_iValue = Value;
+	}
+
+
+	/* Gets */
+	long long GetValue() { return m_iValue; }
+
+private:
+	/* Private - Data*/
+	long long m_iValue;
+};
+
+/* A float literal, this is a double value */
+class FloatValue : public Expression
+{
+public:
+	/* Variable Constructor
+	 * Set type and store the value the scanner read */
+	FloatValue(double Value) : Expression(ExprFloat) {
+		m_dValue = Value;
+	}
+
+
+	/* Gets */
+	double GetValue() { return m_dValue; }
+
+private:
+	/* Private - Data*/
+	double m_dValue;
+};
+
+/* A unary expression, an operator 
+ * applied to a single operand */
+class UnaryExpression : public Expression
+{
+public:
+	/* Variable Constructor
+	 * Set type and take the operand */
+	UnaryExpression(ExpressionUnaryOperator_t Type, Expression *Expr) 
+		: Expression(ExprUnary) {
+		m_eType = Type;
+		m_pExpr = Expr;
 	}
 
-	/* Variable Deconstructor
-	 * Handle cleanup */
-	~IntValue() { }
+	/* Update expression */
+	void SetExpression(Expression *Expr) {
+		m_pExpr = Expr;
+	}
 
 	/* Gets */
-	int GetValue() { return m_iValue; }
+	ExpressionUnaryOperator_t GetOperator() { return m_eType; }
+	Expression *GetExpression() { return m_pExpr; }
 
 private:
 	/* Private - Data*/
-	int m_iValue;
+	ExpressionUnaryOperator_t m_eType;
+	Expression *m_pExpr;
 };
 
 /* A binary expression, this is primarily used 
@@ -154,15 +212,6 @@ public:
 		m_pExpr2 = NULL;
 	}
 
-	/* Variable Deconstructor
-	* Handle cleanup */
-	~BinaryExpression() {
-		if (m_pExpr1 != NULL)
-			delete m_pExpr1;
-		if (m_pExpr2 != NULL)
-			delete m_pExpr2;
-	}
-
 	/* Update expressions */
 	void SetExpression1(Expression *Expr) {
 		m_pExpr1 = Expr;
@@ -181,4 +230,42 @@ private:
 	ExpressionBinaryOperator_t m_eType;
 	Expression *m_pExpr1;
 	Expression *m_pExpr2;
-};
\ No newline at end of file
+};
+
+/* A call expression, a function called with a 
+ * fixed list of arguments that is known up front */
+class CallExpression : public Expression
+{
+public:
+	/* Variable Constructor
+	 * Set type and store the function name and the
+	 * arguments, they are kept in the arena */
+	CallExpression(int Identifier, Expression **Arguments, size_t Count) 
+		: Expression(ExprCall) {
+		m_iIdentifier = Identifier;
+		m_pArguments = Arguments;
+		m_iCount = Count;
+	}
+
+	/* Update identifier, when the symbol 
+	 * moves to another symbol table */
+	void SetIdentifier(int Identifier) {
+		m_iIdentifier = Identifier;
+	}
+
+	/* Update an argument */
+	void SetArgument(size_t Index, Expression *Expr) {
+		m_pArguments[Index] = Expr;
+	}
+
+	/* Gets */
+	int GetIdentifier() { return m_iIdentifier; }
+	size_t GetArgumentCount() { return m_iCount; }
+	Expression *GetArgument(size_t Index) { return m_pArguments[Index]; }
+
+private:
+	/* Private - Data*/
+	int m_iIdentifier;
+	Expression **m_pArguments;
+	size_t m_iCount;
+};
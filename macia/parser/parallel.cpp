@@ -0,0 +1,488 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Parallel Parsing (Parser)
+* - Splits a source at its top-level declarations 
+* - Parses the parts on worker threads and joins them in order
+*/
+
+/* Includes */
+#include "parser.h"
+#include "../lexer/charclass.h"
+#include "../lexer/keywords.h"
+#include "../shared/diagnostics.h"
+#include <atomic>
+#include <string>
+#include <thread>
+
+/* The work queue of a parallel phase 
+ * Threads take the next range untill none are left */
+typedef struct {
+	std::vector<ParseRange_t> *Ranges;
+	std::atomic<size_t> Next;
+	void (*Work)(ParseRange_t *Range, void *Context);
+	void *Context;
+} RangeQueue_t;
+
+/* Marks the range being parsed as failed, the messages
+ * are reported when the source is parsed again in order */
+static void FailRange(void *Context, int Line, int Column, const char *Message)
+{
+	(void)Line;
+	(void)Column;
+	(void)Message;
+	((ParseRange_t*)Context)->Failed = 1;
+}
+
+/* The places a source can be cut at, the end of a declaration,
+ * the '{' that opens the body of a top-level namespace and 
+ * the '}' that closes it. Offset is just after the '{' and
+ * right at the '}', the body is everything in between */
+typedef enum {
+	CutDeclaration,
+	CutOpen,
+	CutClose
+} CutType_t;
+
+typedef struct {
+	size_t Offset;
+	CutType_t Type;
+} Cut_t;
+
+/* A top-level namespace whose body was cut, the 
+ * header is the text from the end of the declaration 
+ * before it up to and including the '{' */
+typedef struct {
+	size_t Header;
+	size_t Open;
+	size_t Tokens;
+	int Symbol;
+	std::string Name;
+} SplitSpace_t;
+
+/* Finds the ends of the top-level declarations by matching
+ * braces, a declaration ends with the '}' that closes it or
+ * a ';' outside of any braces. The body of a top-level namespace
+ * is cut at its own declarations, one level in. Strings and 
+ * comments are skipped the way the scanner reads them, and finding
+ * stops where the source doesn't balance, the scanner will complain 
+ * there. A namespace that isn't closed is not cut */
+static void FindDeclarationEnds(const char *Data, size_t Length, std::vector<Cut_t> *Cuts)
+{
+	/* Variables */
+	size_t Index = 0;
+	size_t Opened = 0;
+	int SpaceDepth = 0;
+	int Pending = 0;
+	int Depth = 0;
+
+	while (Index < Length) {
+		char Character = Data[Index];
+		Cut_t Cut;
+
+		/* Comments and strings */
+		if (Character == '/' && (Index + 1) < Length && Data[Index + 1] == '/') {
+			Index = ScanCharacter(Data, Index + 2, Length, '\n');
+			continue;
+		}
+		if (Character == '/' && (Index + 1) < Length && Data[Index + 1] == '*') {
+			Index = ScanBlockCloser(Data, Index + 2, Length);
+			if (Index >= Length) {
+				break;
+			}
+			Index += 2;
+			continue;
+		}
+		if (Character == '"') {
+			Index = ScanCharacter(Data, Index + 1, Length, '"');
+			if (Index >= Length) {
+				break;
+			}
+			Index++;
+			continue;
+		}
+
+		/* Words, only a top-level namespace matters */
+		if (CharIsClass(Character, CHARCLASS_ALPHA)) {
+			size_t End = ScanIdentifier(Data, Index, Length);
+			if (Depth == 0 && LookupKeyword(&Data[Index], End - Index) == KeywordNamespace) {
+				Pending = 1;
+			}
+			Index = End;
+			continue;
+		}
+
+		/* Brackets */
+		if (Character == '{') {
+			if (Depth == 0 && Pending) {
+				Cut.Offset = Index + 1;
+				Cut.Type = CutOpen;
+				Opened = Cuts->size();
+				Cuts->push_back(Cut);
+				SpaceDepth = 1;
+			}
+			Pending = 0;
+			Depth++;
+		}
+		else if (Character == '}') {
+			if (Depth == 0) {
+				break;
+			}
+			if (--Depth == SpaceDepth) {
+				Cut.Offset = Index + 1;
+				Cut.Type = CutDeclaration;
+				Cuts->push_back(Cut);
+			}
+			else if (Depth == 0 && SpaceDepth == 1) {
+				Cut.Offset = Index;
+				Cut.Type = CutClose;
+				Cuts->push_back(Cut);
+				SpaceDepth = 0;
+			}
+		}
+		else if (Character == ';' && Depth == SpaceDepth) {
+			Cut.Offset = Index + 1;
+			Cut.Type = CutDeclaration;
+			Cuts->push_back(Cut);
+			Pending = 0;
+		}
+		Index++;
+	}
+
+	/* The namespace still open is left whole */
+	if (SpaceDepth == 1) {
+		Cuts->resize(Opened);
+	}
+}
+
+/* Scans the header of a namespace that is cut, it must be 
+ * 'namespace <name> {' with nothing but comments before it, 
+ * as the parser takes it. Returns 0 when it is */
+static int ScanHeader(Scanner *Source, SplitSpace_t *Space)
+{
+	/* Variables */
+	SymbolTable HeaderSymbols;
+	Scanner HeaderScanner(&HeaderSymbols, Source->GetFlags());
+	ElementType_t Expected[] = { KeywordNamespace, Identifier, LeftFuncBracket };
+	size_t Matched = 0;
+
+	HeaderScanner.Begin(Source->GetSource() + Space->Header, Space->Open - Space->Header);
+	while (1) {
+		Token_t Token = HeaderScanner.NextToken();
+		if (Token.Type == UNKNOWN) {
+			break;
+		}
+		if (Matched == 0 && (Token.Type == CommentLine || Token.Type == CommentBlock)) {
+			continue;
+		}
+		if (Matched == 3 || Token.Type != Expected[Matched]) {
+			return -1;
+		}
+		if (Token.Type == Identifier) {
+			Space->Name.assign(HeaderScanner.GetText(Token), Token.Length);
+		}
+		Matched++;
+	}
+	Space->Tokens = HeaderScanner.GetTokenCount();
+	return (Matched == 3 && !HeaderScanner.GetError()) ? 0 : -1;
+}
+
+/* Parses a range with a scanner, symbol table and 
+ * arena of its own, any message fails the range */
+static void ParseRange(ParseRange_t *Range, void *Context)
+{
+	/* Variables */
+	Scanner *Source = (Scanner*)Context;
+	Scanner RangeScanner(Range->Symbols, Source->GetFlags());
+	Parser RangeParser(&RangeScanner, Range->Nodes);
+
+	SetDiagnosticHandler(FailRange, Range);
+	RangeScanner.Begin(Source->GetSource() + Range->Start, Range->Length);
+	if (RangeParser.Parse()) {
+		Range->Failed = 1;
+	}
+	SetDiagnosticHandler(NULL, NULL);
+
+	Range->Program = RangeParser.GetProgram();
+	Range->Tokens = RangeScanner.GetTokenCount();
+}
+
+/* Translates the symbol ids of an expression */
+static void RemapExpression(Expression *pExpr, std::vector<int> &Map)
+{
+	/* Sanity */
+	if (pExpr == NULL) {
+		return;
+	}
+
+	switch (pExpr->GetType()) {
+		case ExprVariable: {
+			Variable *Var = (Variable*)pExpr;
+			Var->SetIdentifier(Map[Var->GetIdentifier()]);
+		} break;
+		case ExprUnary: {
+			RemapExpression(((UnaryExpression*)pExpr)->GetExpression(), Map);
+		} break;
+		case ExprBinary: {
+			RemapExpression(((BinaryExpression*)pExpr)->GetExpression1(), Map);
+			RemapExpression(((BinaryExpression*)pExpr)->GetExpression2(), Map);
+		} break;
+		case ExprCall: {
+			CallExpression *Call = (CallExpression*)pExpr;
+			Call->SetIdentifier(Map[Call->GetIdentifier()]);
+			for (size_t i = 0; i < Call->GetArgumentCount(); i++) {
+				RemapExpression(Call->GetArgument(i), Map);
+			}
+		} break;
+		default:
+			break;
+	}
+}
+
+/* Translates the symbol ids of a statement */
+static void RemapStatement(Statement *pStmt, std::vector<int> &Map)
+{
+	/* Sanity */
+	if (pStmt == NULL) {
+		return;
+	}
+
+	switch (pStmt->GetType()) {
+		case StmtSequence: {
+			Sequence *Seq = (Sequence*)pStmt;
+			for (size_t i = 0; i < Seq->GetCount(); i++) {
+				RemapStatement(Seq->GetStatement(i), Map);
+			}
+		} break;
+		case StmtNamespace: {
+			Namespace *Space = (Namespace*)pStmt;
+			Space->SetIdentifier(Map[Space->GetIdentifier()]);
+			RemapStatement(Space->GetBody(), Map);
+		} break;
+		case StmtImport: {
+			Import *Imp = (Import*)pStmt;
+			Imp->SetIdentifier(Map[Imp->GetIdentifier()]);
+		} break;
+		case StmtObject: {
+			Object *Obj = (Object*)pStmt;
+			Obj->SetIdentifier(Map[Obj->GetIdentifier()]);
+			RemapStatement(Obj->GetBody(), Map);
+		} break;
+		case StmtFunction: {
+			Function *Func = (Function*)pStmt;
+			Func->SetIdentifier(Map[Func->GetIdentifier()]);
+			for (size_t i = 0; i < Func->GetParameterCount(); i++) {
+				RemapStatement(Func->GetParameter(i), Map);
+			}
+			RemapStatement(Func->GetBody(), Map);
+		} break;
+		case StmtDeclaration: {
+			Declaration *Decl = (Declaration*)pStmt;
+			Decl->SetIdentifiers(Map[Decl->GetOfType()], Map[Decl->GetIdentifier()]);
+			RemapExpression(Decl->GetExpression(), Map);
+		} break;
+		case StmtAssign: {
+			Assignment *Ass = (Assignment*)pStmt;
+			Ass->SetIdentifier(Map[Ass->GetIdentifier()]);
+			RemapExpression(Ass->GetExpression(), Map);
+		} break;
+		case StmtCall: {
+			RemapExpression(((Call*)pStmt)->GetCall(), Map);
+		} break;
+		default:
+			break;
+	}
+}
+
+/* Translates the symbol ids of a parsed range */
+static void RemapRange(ParseRange_t *Range, void *Context)
+{
+	(void)Context;
+	RemapStatement(Range->Program, *Range->Map);
+}
+
+/* Takes ranges from the queue untill it is empty */
+static void RunQueue(RangeQueue_t *Queue)
+{
+	size_t Index;
+	while ((Index = Queue->Next.fetch_add(1)) < Queue->Ranges->size()) {
+		Queue->Work(&(*Queue->Ranges)[Index], Queue->Context);
+	}
+}
+
+/* Runs Work for every range on up to Threads threads, the 
+ * calling thread only waits so its message handler is untouched */
+static void RunRanges(std::vector<ParseRange_t> &Ranges, int Threads,
+	void (*Work)(ParseRange_t *Range, void *Context), void *Context)
+{
+	/* Variables */
+	std::vector<std::thread> Workers;
+	RangeQueue_t Queue;
+
+	Queue.Ranges = &Ranges;
+	Queue.Next = 0;
+	Queue.Work = Work;
+	Queue.Context = Context;
+
+	for (int i = 0; i < Threads && i < (int)Ranges.size(); i++) {
+		Workers.push_back(std::thread(RunQueue, &Queue));
+	}
+	for (size_t i = 0; i < Workers.size(); i++) {
+		Workers[i].join();
+	}
+}
+
+/* Parses the source of the scanner in ranges of top-level 
+ * declarations on worker threads. Returns 0 when the program
+ * was parsed, and -1 when the source has to be parsed in order
+ * instead; it is too small, can't be split or a range had 
+ * messages. Nothing is changed in that case */
+int Parser::ParseParallel(int Threads)
+{
+	/* Variables */
+	SymbolTable *Symbols = m_pScanner->GetSymbols();
+	size_t Length = m_pScanner->GetLength();
+	std::vector<ParseRange_t> Ranges;
+	std::vector<SplitSpace_t> Spaces;
+	std::vector<Cut_t> Cuts;
+	size_t Target, Start = 0, Last = 0;
+	int Inside = -1;
+	int Failed = 0;
+
+	/* Sanity, the scanner must be untouched */
+	if (Threads <= 0) {
+		Threads = (int)std::thread::hardware_concurrency();
+	}
+	if (Threads <= 1 
+		|| Length < PARSER_PARALLEL_MIN_LENGTH
+		|| m_pScanner->GetPosition() != 0) {
+		return -1;
+	}
+
+	/* Cut the source into ranges of about the same size, 
+	 * the body of a namespace is cut on its own. Last is 
+	 * the end of the declaration before the current one */
+	FindDeclarationEnds(m_pScanner->GetSource(), Length, &Cuts);
+	Target = Length / ((size_t)Threads * PARSER_RANGES_PER_THREAD);
+	for (size_t i = 0; i <= Cuts.size(); i++) {
+		size_t End = (i == Cuts.size()) ? Length : Cuts[i].Offset;
+		CutType_t Type = (i == Cuts.size()) ? CutDeclaration : Cuts[i].Type;
+		ParseRange_t Range = { Start, 0, NULL, NULL, NULL, NULL, 0, 0, Inside };
+
+		if (Type == CutOpen) {
+			SplitSpace_t Space;
+			if (Last > Start) {
+				Range.Length = Last - Start;
+				Ranges.push_back(Range);
+			}
+			Space.Header = Last;
+			Space.Open = End;
+			if (ScanHeader(m_pScanner, &Space)) {
+				return -1;
+			}
+			Inside = (int)Spaces.size();
+			Spaces.push_back(Space);
+			Start = Last = End;
+		}
+		else if (Type == CutClose) {
+			Range.Length = End - Start;
+			Ranges.push_back(Range);
+			Inside = -1;
+			Start = Last = End + 1;
+		}
+		else if (End - Start >= Target || (End == Length && End > Start)) {
+			Range.Length = End - Start;
+			Ranges.push_back(Range);
+			Start = Last = End;
+		}
+		else {
+			Last = End;
+		}
+	}
+	if (Ranges.size() < 2) {
+		return -1;
+	}
+
+	/* Parse them */
+	for (size_t i = 0; i < Ranges.size(); i++) {
+		Ranges[i].Nodes = new Arena();
+		Ranges[i].Symbols = new SymbolTable();
+	}
+	RunRanges(Ranges, Threads, ParseRange, m_pScanner);
+
+	/* Symbols are interned in source order, so the ids 
+	 * come out the same as when parsed in order */
+	for (size_t i = 0; i < Ranges.size(); i++) {
+		Failed |= Ranges[i].Failed;
+	}
+	for (size_t i = 0; i < Ranges.size(); i++) {
+		if (!Failed) {
+			SymbolTable *RangeSymbols = Ranges[i].Symbols;
+
+			/* The name of a namespace comes before its body */
+			if (Ranges[i].Space != -1 && (i == 0 || Ranges[i - 1].Space != Ranges[i].Space)) {
+				SplitSpace_t *Space = &Spaces[Ranges[i].Space];
+				Space->Symbol = Symbols->Intern(Space->Name.c_str(), Space->Name.length());
+			}
+			Ranges[i].Map = new std::vector<int>(RangeSymbols->GetCount());
+			for (int Id = 0; Id < RangeSymbols->GetCount(); Id++) {
+				(*Ranges[i].Map)[Id] = Symbols->Intern(RangeSymbols->GetName(Id), RangeSymbols->GetLength(Id));
+			}
+		}
+		delete Ranges[i].Symbols;
+	}
+
+	/* Translate and join the programs in order */
+	if (!Failed) {
+		size_t First = 0;
+		RunRanges(Ranges, Threads, RemapRange, NULL);
+		for (size_t i = 0; i < Ranges.size(); i++) {
+			Sequence *Seq = (Sequence*)Ranges[i].Program;
+			int Space = Ranges[i].Space;
+
+			/* The declarations of a namespace that was cut 
+			 * are wrapped in the namespace again, its header 
+			 * and the closing '}' are tokens too */
+			if (Space != -1 && (i == 0 || Ranges[i - 1].Space != Space)) {
+				First = m_lStatements.size();
+				m_iTokenCount += Spaces[Space].Tokens + 1;
+			}
+			for (size_t j = 0; Seq != NULL && j < Seq->GetCount(); j++) {
+				m_lStatements.push_back(Seq->GetStatement(j));
+			}
+			if (Space != -1 && (i + 1 == Ranges.size() || Ranges[i + 1].Space != Space)) {
+				Namespace *Wrapper = new (m_pArena) Namespace(Spaces[Space].Symbol);
+				Wrapper->SetBody(CreateSequence(First));
+				m_lStatements.push_back(Wrapper);
+			}
+			m_lArenas.push_back(Ranges[i].Nodes);
+			m_iTokenCount += Ranges[i].Tokens;
+		}
+		m_pBase = CreateSequence(0);
+		m_iRanges = Ranges.size();
+	}
+
+	/* Cleanup */
+	for (size_t i = 0; i < Ranges.size(); i++) {
+		if (Failed) {
+			delete Ranges[i].Nodes;
+		}
+		delete Ranges[i].Map;
+	}
+	return Failed ? -1 : 0;
+}
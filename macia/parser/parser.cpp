@@ -16,80 +16,128 @@
 * along with this program.If not, see <http://www.gnu.org/licenses/>.
 *
 *
-* Macia - Parser
-* - Turns an element list into a program structure
+* - Pulls elements from the scanner into a program structure
 */
 
 /* Includes */
 #include "parser.h"
+#include "../shared/diagnostics.h"
 #include <cstdio>
 #include <cstring>
-#include <strings.h>
 
 /* Constructor
- * Takes a elem list for parsing */
-Parser::Parser(std::vector<Element*> &Elements) {
-	m_lElements = Elements;
+ * Takes the scanner to pull tokens from, it 
+ * must have been started on a source. Without 
+ * an arena the parser creates its own */
+Parser::Parser(Scanner *pScanner, Arena *pArena) {
+	m_pScanner = pScanner;
 	m_pBase = NULL;
+	m_pArena = (pArena != NULL) ? pArena : new Arena();
+	m_iOwnsArena = (pArena == NULL);
+	m_iTokenCount = 0;
+	m_iRanges = 0;
+	m_iError = 0;
 }
 
 /* Destructor
- * Cleanup list */
+ * Cleanup AST, all of it goes with the arenas */
 Parser::~Parser() {
-	m_lElements.clear();
-	
-	/* Cleanup AST */
-	if (m_pBase != NULL) {
-		delete m_pBase;
+	if (m_iOwnsArena) {
+		delete m_pArena;
 	}
+	for (size_t i = 0; i < m_lArenas.size(); i++) {
+		delete m_lArenas[i];
+	}
+}
+
+/* Reports an error at the given token */
+void Parser::ReportAt(const Token_t &Token, const char *Format, ...) {
+	va_list Arguments;
+
+	va_start(Arguments, Format);
+	ReportErrorList(m_pScanner->GetLine(Token), m_pScanner->GetColumn(Token), Format, Arguments);
+	va_end(Arguments);
 }
 
 /* This runs the actual parsing 
  * process, use GetProgram to retrieve
  * the results */
-int Parser::Parse() 
+int Parser::Parse(int Threads) 
 {
-	/* Variables */
-	int Count = 0;
+	Statement *Stmt = NULL;
+	int Result;
 
-	/* Iterate tokens */
-	for (Count = 0; Count < (int)m_lElements.size();)
-	{
-		/* Get a reference */
-		Element *elem = m_lElements[Count];
+	/* Try the declarations in parallel first, the source
+	 * is parsed here if that is not possible or it fails */
+	if (Threads != 1 && ParseParallel(Threads) == 0) {
+		return 0;
+	}
 
+	/* Parse declarations untill the end of the source */
+	while ((Result = ParseDeclaration(&Stmt)) == 1) {
+		if (Stmt != NULL) {
+			m_lStatements.push_back(Stmt);
+			Stmt = NULL;
+		}
+	}
+	m_pBase = CreateSequence(0);
+	if (Result != 0) {
+		return Result;
+	}
+
+	/* Done, unless we or the scanner stopped on an error */
+	return (m_iError != 0) ? m_iError : m_pScanner->GetError();
+}
+
+/* Parses the next top-level declaration into Parent, comments
+ * before it are skipped. Returns 1 when a declaration was parsed, 
+ * 0 at the end of the source and -1 on errors */
+int Parser::ParseDeclaration(Statement **Parent)
+{
+	/* Iterate tokens untill the declaration */
+	while (m_pScanner->Peek(0).Type != UNKNOWN)
+	{
 		/* Remember we are in the outer world 
 		 * which means we only accept outer-world identifiers */
-		switch (elem->GetType()) {
-			case Identifier: {
+		switch (m_pScanner->Peek(0).Type) {
+			case Identifier:
+			case KeywordNamespace:
+			case KeywordImport:
+			case KeywordObject:
+			case KeywordFunc:
+			case KeywordConst:
+			case KeywordLocked:
+			case KeywordReadonly: {
 
 				/* Good, this we can expect 
 				 * Which type of identifier? 
 				 * We accept only VERY few */
-				int Increase = ParseStatement(Count, &m_pBase);
-				Count += Increase;
+				Token_t First = m_pScanner->Peek(0);
+				int Line = m_pScanner->GetLine(First);
+				const char *Name = GetElementName(First.Type);
 
 				/* Sanity */
-				if (!Increase) {
+				if (!ParseStatement(Parent)) {
 					/* Print an error message */
-					printf("Invalid identifier %s at line %i\n", elem->GetName(), elem->GetLineNumber());
+					ReportAt(First, "Invalid identifier %s at line %i\n", Name, Line);
 
 					/* Bail out */
 					return -1;
 				}
-
-			} break;
+				return 1;
+			}
 
 			/* Ignore comments */
 			case CommentBlock:
 			case CommentLine: {
-				Count++;
+				m_pScanner->NextToken();
 			} break;
 
 			default: {
 				/* Print an error message */
-				printf("Invalid element %s at line %i, expected Identifier, Index %i\n", 
-					elem->GetName(), elem->GetLineNumber(), Count);
+				ReportAt(m_pScanner->Peek(0), "Invalid element %s at line %i, column %i, expected Identifier\n", 
+					GetElementName(m_pScanner->Peek(0).Type), m_pScanner->GetLine(m_pScanner->Peek(0)), 
+					m_pScanner->GetColumn(m_pScanner->Peek(0)));
 
 				/* Bail out */
 				return -1;
@@ -97,364 +145,584 @@ int Parser::Parse()
 		}
 	}
 
-	/* Done ! */
+	/* End of source */
 	return 0;
 }
 
-/* Parse elements into an AST statement */
-int Parser::ParseStatement(int Index, Statement **Parent)
+/* Moves the statements collected from the given index on 
+ * into a sequence in the arena, NULL when there are none */
+Sequence *Parser::CreateSequence(size_t First)
 {
-	/* Keep track of elements consumed */
-	Statement *Stmt = NULL;
-	int Consumed = 0;
-	int ModIndex = Index;
-	int Modifiers = 0;
+	size_t Count = m_lStatements.size() - First;
+	Statement **Statements = NULL;
 
-	/* Start out by passing modifiers */
-	ModIndex += Consumed = ParseModifiers(ModIndex, &Modifiers);
+	/* Sanity */
+	if (Count == 0) {
+		return NULL;
+	}
 
-	/* Filter out comments */
-	if (m_lElements[ModIndex]->GetType() == CommentLine
-		|| m_lElements[ModIndex]->GetType() == CommentBlock) {
-		Consumed++;
+	/* Copy them over */
+	Statements = (Statement**)m_pArena->Allocate(Count * sizeof(Statement*));
+	if (Statements == NULL) {
+		throw std::bad_alloc();
 	}
-	/* Now let's see what we can do with this 
-	 * Is it a declaration?? */
-	else if ((m_lElements[ModIndex]->GetType() == Identifier
-			&& m_lElements[ModIndex + 1]->GetType() == Identifier
-			&& m_lElements[ModIndex + 2]->GetType() == OperatorAssign)
-		|| (m_lElements[ModIndex]->GetType() == Identifier
-			&& m_lElements[ModIndex + 1]->GetType() == Identifier
-			&& m_lElements[ModIndex + 2]->GetType() == OperatorSemiColon)) {
+	memcpy(Statements, &m_lStatements[First], Count * sizeof(Statement*));
+	m_lStatements.resize(First);
+	return new (m_pArena) Sequence(Statements, Count);
+}
+
+/* Parse statements untill the end of the body, 
+ * the closing bracket is consumed too. The statements 
+ * are collected on the shared list while nested 
+ * bodies are parsed on top of them */
+void Parser::ParseBody(Statement **Body)
+{
+	/* Variables */
+	size_t First = m_lStatements.size();
+
+	/* Keep parsing statements till end of body */
+	while (m_pScanner->Peek(0).Type != RightFuncBracket) {
+		Statement *Stmt = NULL;
 		
-		/* Create a new statement */
-		Declaration *Decl = new Declaration(m_lElements[ModIndex]->GetData(), 
-			m_lElements[ModIndex + 1]->GetData());
-		int HasExpr = (m_lElements[ModIndex + 2]->GetType() == OperatorSemiColon) ? 0 : 1;
-
-		/* Modify index + consumed */
-		Consumed += 3;
-		ModIndex += 3;
-
-		/* Parse expression */
-		if (HasExpr) {
-			Expression *Expr = NULL;
-			int Used = ParseExpression(ModIndex, &Expr);
-			Decl->SetExpression(Expr);
-
-			/* Skip ';' */
-			Used++;
-
-			/* Increase by consumed elements */
-			Consumed += Used;
-			ModIndex += Used;
+		/* Sanity */
+		if (m_pScanner->Peek(0).Type == UNKNOWN) {
+			ReportAt(m_pScanner->Peek(0), "Missing '}' at the end of the body, line %i\n", 
+				m_pScanner->GetLine(m_pScanner->Peek(0)));
+			m_iError = -1;
+			break;
+		}
+		ParseStatement(&Stmt);
+		if (Stmt != NULL) {
+			m_lStatements.push_back(Stmt);
 		}
+	}
 
-		/* Set it  */
-		Stmt = Decl;
+	/* Skip the end of body */
+	*Body = CreateSequence(First);
+	if (m_pScanner->Peek(0).Type == RightFuncBracket) {
+		m_pScanner->NextToken();
 	}
-	/* Assign statement */
-	else if ((m_lElements[ModIndex]->GetType() == Identifier
-		&& m_lElements[ModIndex + 1]->GetType() == OperatorAssign)) {
+}
 
-		/* Create a new statement */
-		Assignment *Ass = new Assignment(m_lElements[ModIndex]->GetData());
-		Expression *Expr = NULL;
-		int Used = 0;
+/* Parse elements into an AST statement 
+ * returns how many elements were consumed in the process */
+int Parser::ParseStatement(Statement **Parent)
+{
+	/* Keep track of elements consumed */
+	size_t Start = m_pScanner->GetTokenCount();
+	Statement *Stmt = NULL;
+	Token_t Modified = m_pScanner->Peek(0);
+	int Modifiers = 0;
 
-		/* Modify index + consumed */
-		Consumed += 2;
-		ModIndex += 2;
+	/* Start out by passing modifiers */
+	ParseModifiers(&Modifiers);
 
-		/* Parse expression */
-		Used = ParseExpression(ModIndex, &Expr);
-		Ass->SetExpression(Expr);
+	/* Now let's see what we can do with this, 
+	 * the element type decides the statement */
+	switch (m_pScanner->Peek(0).Type) {
 
-		/* Skip ';' */
-		Used++;
+		/* Filter out comments */
+		case CommentLine:
+		case CommentBlock: {
+			m_pScanner->NextToken();
+		} break;
 
-		/* Increase by consumed elements */
-		Consumed += Used;
-		ModIndex += Used;
+		/* Namespace declaration */
+		case KeywordNamespace: {
 
-		/* Set it  */
-		Stmt = Ass;
-	}
-	else if (m_lElements[ModIndex]->GetType() == Identifier
-		&& m_lElements[ModIndex + 1]->GetType() == Identifier
-		&& (m_lElements[ModIndex + 2]->GetType() == LeftFuncBracket
-			|| m_lElements[ModIndex + 2]->GetType() == LeftParenthesis)) {
-		
-		/* Function declaration, object declaration */
-		if (!strcasecmp("object", m_lElements[ModIndex]->GetData())) {
+			/* Validate */
+			if (m_pScanner->Peek(1).Type != Identifier
+				|| m_pScanner->Peek(2).Type != LeftFuncBracket) {
+				ReportAt(m_pScanner->Peek(0), "Unsupported namespace declaration, line %u. Expected 'namespace <name> {'\n",
+					m_pScanner->GetLine(m_pScanner->Peek(0)));
+				m_pScanner->NextToken();
+				break;
+			}
 
-			/* Create a new Object and parse it's body */
-			Object *Obj = new Object(m_lElements[ModIndex + 1]->GetData());
+			/* Create a new Namespace and parse it's body */
+			m_pScanner->NextToken();
+			Namespace *Space = new (m_pArena) Namespace(m_pScanner->NextToken().Symbol);
 			Statement *Body = NULL;
-			int Used = 0;
+			m_pScanner->NextToken();
 
-			/* Consume */
-			ModIndex += 3;
-			Used = 3;
+			/* Update body */
+			ParseBody(&Body);
+			Space->SetBody(Body);
 
-			/* Keep parsing statements till end of body */
-			while (m_lElements[ModIndex]->GetType() != RightFuncBracket) {
-				/* Parse */
-				int StmtLength = ParseStatement(ModIndex, &Body);
+			/* Set it  */
+			Stmt = Space;
+		} break;
 
-				/* Update */
-				ModIndex += StmtLength;
-				Used += StmtLength;
+		/* Import of a namespace */
+		case KeywordImport: {
+
+			/* Validate */
+			if (m_pScanner->Peek(1).Type != Identifier
+				|| m_pScanner->Peek(2).Type != OperatorSemiColon) {
+				ReportAt(m_pScanner->Peek(0), "Unsupported import, line %u. Expected 'import <name>;'\n",
+					m_pScanner->GetLine(m_pScanner->Peek(0)));
+				m_pScanner->NextToken();
+				break;
 			}
 
-			/* Skip the end of body */
-			Used++;
+			/* Create the import, and skip ';' */
+			m_pScanner->NextToken();
+			Stmt = new (m_pArena) Import(m_pScanner->NextToken().Symbol);
+			m_pScanner->NextToken();
+		} break;
+
+		/* Object declaration */
+		case KeywordObject: {
+
+			/* Validate */
+			if (m_pScanner->Peek(1).Type != Identifier
+				|| m_pScanner->Peek(2).Type != LeftFuncBracket) {
+				ReportAt(m_pScanner->Peek(0), "Unsupported object declaration, line %u. Expected 'object <name> {'\n",
+					m_pScanner->GetLine(m_pScanner->Peek(0)));
+				m_pScanner->NextToken();
+				break;
+			}
+
+			/* Create a new Object and parse it's body */
+			m_pScanner->NextToken();
+			Object *Obj = new (m_pArena) Object(m_pScanner->NextToken().Symbol);
+			Statement *Body = NULL;
+			m_pScanner->NextToken();
 
 			/* Update body */
+			ParseBody(&Body);
 			Obj->SetBody(Body);
 
-			/* Increase */
-			Consumed += Used;
-
 			/* Set it  */
 			Stmt = Obj;
-		}
-		else if (!strcasecmp("func", m_lElements[ModIndex]->GetData())) {
+		} break;
+
+		/* Function declaration */
+		case KeywordFunc: {
+
+			/* Validate */
+			if (m_pScanner->Peek(1).Type != Identifier
+				|| m_pScanner->Peek(2).Type != LeftParenthesis) {
+				ReportAt(m_pScanner->Peek(0), "Unsupported function declaration, line %u. Expected 'func <name>('\n",
+					m_pScanner->GetLine(m_pScanner->Peek(0)));
+				m_pScanner->NextToken();
+				break;
+			}
 
 			/* Create a new Object and parse it's body */
-			Function *Func = new Function(m_lElements[ModIndex + 1]->GetData());
+			m_pScanner->NextToken();
+			Function *Func = new (m_pArena) Function(m_pScanner->NextToken().Symbol);
 			Statement *Body = NULL;
-			int Used = 0;
-
-			/* Consume */
-			ModIndex += 3;
-			Used = 3;
+			m_pScanner->NextToken();
 
 			/* Keep parsing arguments */
-			while (m_lElements[ModIndex]->GetType() != RightParenthesis) {
-				/* Update */
-				ModIndex += 1;
-				Used += 1;
-			}
+			ParseParameters(Func);
 
 			/* Skip the end of arugments */
-			ModIndex++;
-			Used++;
+			m_pScanner->NextToken();
 
 			/* Validate */
-			if (m_lElements[ModIndex]->GetType() != LeftFuncBracket) {
+			if (m_pScanner->Peek(0).Type != LeftFuncBracket) {
 				/* ERROR */
-				printf("Unsupported start of function: <%s>, line %u. Expected '{' \n",
-					m_lElements[ModIndex]->GetName(), m_lElements[ModIndex]->GetLineNumber());
+				ReportAt(m_pScanner->Peek(0), "Unsupported start of function: <%s>, line %u. Expected '{' \n",
+					GetElementName(m_pScanner->Peek(0).Type), m_pScanner->GetLine(m_pScanner->Peek(0)));
 			}
 			
 			/* Skip this too */
-			ModIndex++;
-			Used++;
+			m_pScanner->NextToken();
+
+			/* Update body */
+			ParseBody(&Body);
+			Func->SetBody(Body);
+			Func->SetModifiers(Modifiers);
+
+			/* Set it  */
+			Stmt = Func;
+		} break;
+
+		/* Declarations and assignments */
+		case Identifier: {
+
+			/* Is it a declaration?? */
+			if (m_pScanner->Peek(1).Type == Identifier
+				&& (m_pScanner->Peek(2).Type == OperatorAssign
+					|| m_pScanner->Peek(2).Type == OperatorSemiColon)) {
+
+				/* Create a new statement */
+				int OfType = m_pScanner->NextToken().Symbol;
+				Declaration *Decl = new (m_pArena) Declaration(OfType, m_pScanner->NextToken().Symbol);
+				Decl->SetModifiers(Modifiers);
+
+				/* Parse expression */
+				if (m_pScanner->NextToken().Type == OperatorAssign) {
+					Expression *Expr = NULL;
+					ParseExpression(&Expr);
+					Decl->SetExpression(Expr);
 
-			/* Keep parsing statements till end of body */
-			while (m_lElements[ModIndex]->GetType() != RightFuncBracket) {
-				/* Parse */
-				int StmtLength = ParseStatement(ModIndex, &Body);
+					/* Skip ';' */
+					m_pScanner->NextToken();
+				}
 
-				/* Update */
-				ModIndex += StmtLength;
-				Used += StmtLength;
+				/* Set it  */
+				Stmt = Decl;
+				break;
 			}
+			
+			/* Call statement */
+			if (m_pScanner->Peek(1).Type == LeftParenthesis) {
+				Token_t Token = m_pScanner->Peek(0);
+				Expression *Expr = NULL;
+
+				/* Parse expression, it must be just the call */
+				ParseExpression(&Expr);
+				if (Expr == NULL || Expr->GetType() != ExprCall) {
+					ReportAt(Token, "Only function calls can be used as statements, line %u\n",
+						m_pScanner->GetLine(Token));
+					m_iError = -1;
+				}
+				else {
+					Stmt = new (m_pArena) Call((CallExpression*)Expr);
+				}
 
-			/* Skip this too */
-			Used++;
+				/* Skip ';' */
+				m_pScanner->NextToken();
+				break;
+			}
 
-			/* Update body */
-			Func->SetBody(Body);
+			/* Assign statement */
+			if (m_pScanner->Peek(1).Type == OperatorAssign) {
 
-			/* Increase */
-			Consumed += Used;
+				/* Create a new statement */
+				Assignment *Ass = new (m_pArena) Assignment(m_pScanner->NextToken().Symbol);
+				Expression *Expr = NULL;
 
-			/* Set it  */
-			Stmt = Func;
-		}
+				/* Skip '=' */
+				m_pScanner->NextToken();
+
+				/* Parse expression */
+				ParseExpression(&Expr);
+				Ass->SetExpression(Expr);
+
+				/* Skip ';' */
+				m_pScanner->NextToken();
+
+				/* Set it  */
+				Stmt = Ass;
+				break;
+			}
+		} /* Fall-through */
+
+		default: {
+			/* Invalid - ERROR - ERRROR */
+			Token_t Token = m_pScanner->NextToken();
+			ReportAt(Token, "Unsupported start of statement <%s: %.*s>, line %u\n",
+				GetElementName(Token.Type), (int)Token.Length, 
+				m_pScanner->GetText(Token), m_pScanner->GetLine(Token));
+		} break;
 	}
-	else {
-		/* Invalid - ERROR - ERRROR */
-		printf("Unsupported start of statement <%s: %s>, line %u\n",
-			m_lElements[ModIndex]->GetName(), m_lElements[ModIndex]->GetData(), m_lElements[ModIndex]->GetLineNumber());
-		Consumed++;
+
+	/* Only declarations and functions keep their modifiers */
+	if (Modifiers != 0 && Stmt != NULL
+		&& Stmt->GetType() != StmtDeclaration && Stmt->GetType() != StmtFunction) {
+		ReportAt(Modified, "Modifiers can only be given to declarations and functions, line %u\n",
+			m_pScanner->GetLine(Modified));
+		m_iError = -1;
 	}
 
-	/* Add it? */
-	if (Stmt != NULL) {
-		if (*Parent == NULL) {
-			*Parent = Stmt;
+	/* Hand it over */
+	*Parent = Stmt;
+ 
+	/* Done! */
+	return (int)(m_pScanner->GetTokenCount() - Start);
+}
+
+/* Parse the argument list of a function declaration, 
+ * '<type> <name>' pairs seperated by ','. The closing 
+ * parenthesis is left for the caller */
+void Parser::ParseParameters(Function *Func)
+{
+	/* Variables */
+	std::vector<Declaration*> Parameters;
+	Declaration **Array = NULL;
+
+	while (m_pScanner->Peek(0).Type != RightParenthesis
+		&& m_pScanner->Peek(0).Type != UNKNOWN) {
+
+		/* Sanity */
+		if (m_pScanner->Peek(0).Type != Identifier
+			|| m_pScanner->Peek(1).Type != Identifier
+			|| (m_pScanner->Peek(2).Type != OperatorComma 
+				&& m_pScanner->Peek(2).Type != RightParenthesis)) {
+			ReportAt(m_pScanner->Peek(0), "Unsupported function argument <%s>, line %u. Expected '<type> <name>'\n",
+				GetElementName(m_pScanner->Peek(0).Type), m_pScanner->GetLine(m_pScanner->Peek(0)));
+			m_iError = -1;
+
+			/* Skip the rest of them */
+			while (m_pScanner->Peek(0).Type != RightParenthesis
+				&& m_pScanner->Peek(0).Type != UNKNOWN) {
+				m_pScanner->NextToken();
+			}
+			break;
 		}
-		else {
-			/* Create a sequence and add us in */
-			Sequence *Seq = new Sequence(*Parent, Stmt);
-			*Parent = Seq;
+
+		/* Create the declaration */
+		int OfType = m_pScanner->NextToken().Symbol;
+		Parameters.push_back(new (m_pArena) Declaration(OfType, m_pScanner->NextToken().Symbol));
+
+		/* Skip ',' */
+		if (m_pScanner->Peek(0).Type == OperatorComma) {
+			m_pScanner->NextToken();
 		}
 	}
- 
-	/* Done! */
-	return Consumed;
+
+	/* Move them into the arena */
+	if (Parameters.size() != 0) {
+		Array = (Declaration**)m_pArena->Allocate(Parameters.size() * sizeof(Declaration*));
+		if (Array == NULL) {
+			throw std::bad_alloc();
+		}
+		memcpy(Array, &Parameters[0], Parameters.size() * sizeof(Declaration*));
+		Func->SetParameters(Array, Parameters.size());
+	}
 }
 
-/* Parse statement modifers */
-int Parser::ParseModifiers(int Index, int *Modifiers)
+/* Parse statement modifers, they are 
+ * recorded in the mask of modifiers */
+int Parser::ParseModifiers(int *Modifiers)
 {
 	/* Keep track of elements consumed */
 	int Consumed = 0;
-	int ModIndex = Index;
+	*Modifiers = 0;
 
 	/* Determine what kind of statement this is
 	 * Start out by checking decl */
-	while (m_lElements[ModIndex]->GetType() == Identifier) {
-		if (!strcasecmp("const", m_lElements[ModIndex]->GetData())) {
-			ModIndex++;
-			Consumed++;
-		}
-		else if (!strcasecmp("locked", m_lElements[ModIndex]->GetData())) {
-			ModIndex++;
-			Consumed++;
+	while (1) {
+
+		/* Done at the first that is not a modifier */
+		switch (m_pScanner->Peek(0).Type) {
+			case KeywordConst: *Modifiers |= ModifierConst; break;
+			case KeywordLocked: *Modifiers |= ModifierLocked; break;
+			case KeywordReadonly: *Modifiers |= ModifierReadonly; break;
+			default: return Consumed;
 		}
-		else
-			break;
+		m_pScanner->NextToken();
+		Consumed++;
 	}
+}
 
-	/* Done! */
-	return Consumed;
+/* Gets the binding strength of a binary operator, 
+ * 0 for elements that are not binary operators */
+static int GetPrecedence(ElementType_t Type, ExpressionBinaryOperator_t *Operator)
+{
+	switch (Type) {
+		case OperatorMultiply: *Operator = ExprOperatorMultiply; return 2;
+		case OperatorDivide: *Operator = ExprOperatorDivide; return 2;
+		case OperatorRemainder: *Operator = ExprOperatorRemainder; return 2;
+		case OperatorAdd: *Operator = ExprOperatorAdd; return 1;
+		case OperatorSubtract: *Operator = ExprOperatorSubtract; return 1;
+		default: return 0;
+	}
 }
 
-/* Parse an AST expression from the given index 
+/* Parse an AST expression from the current token 
  * returns how many elements were consumed in the process */
-int Parser::ParseExpression(int Index, Expression **Parent)
+int Parser::ParseExpression(Expression **Parent)
 {
 	/* Keep track of elements consumed */
-	Expression *Expr = NULL;
-	int Consumed = 0;
-	int ModIndex = Index;
+	size_t Start = m_pScanner->GetTokenCount();
+
+	/* Parse the whole expression */
+	*Parent = ParseBinary(1);
+
+	/* It must end here, skip whatever is left of it */
+	if (m_pScanner->Peek(0).Type != OperatorSemiColon
+		&& m_pScanner->Peek(0).Type != RightParenthesis
+		&& m_pScanner->Peek(0).Type != UNKNOWN) {
+		ReportAt(m_pScanner->Peek(0), "Unexpected element of type %s in expression, line %u\n",
+			GetElementName(m_pScanner->Peek(0).Type), m_pScanner->GetLine(m_pScanner->Peek(0)));
+		m_iError = -1;
+
+		while (m_pScanner->Peek(0).Type != OperatorSemiColon
+			&& m_pScanner->Peek(0).Type != RightFuncBracket
+			&& m_pScanner->Peek(0).Type != UNKNOWN) {
+			m_pScanner->NextToken();
+		}
+	}
 
-	/* Iterate untill end of expression */
-	while (m_lElements[ModIndex]->GetType() != OperatorSemiColon
-		&& m_lElements[ModIndex]->GetType() != RightParenthesis) {
+	/* Done ! */
+	return (int)(m_pScanner->GetTokenCount() - Start);
+}
 
-		/* Used elements */
-		int Used = 0;
+/* Parses binary operators by precedence climbing, operators 
+ * binding at least MinPrecedence are taken, and the right hand
+ * only takes stronger ones so the tree is left associative */
+Expression *Parser::ParseBinary(int MinPrecedence)
+{
+	/* Start out with the left hand */
+	Expression *Expr = ParseUnary();
 
-		/* Now, let's check... */
-		if (m_lElements[ModIndex]->GetType() == LeftParenthesis) {
+	/* Take operators as long as they bind strong enough */
+	while (1) {
+		ExpressionBinaryOperator_t Operator;
+		int Precedence = GetPrecedence(m_pScanner->Peek(0).Type, &Operator);
+		BinaryExpression *Binary = NULL;
 
-			/* Consume the left paranthesis */
-			Used++;
+		if (Precedence == 0 || Precedence < MinPrecedence) {
+			break;
+		}
+		m_pScanner->NextToken();
 
-			/* Parse sub-expression in expression */
-			Used += ParseExpression(ModIndex + 1, &Expr);
+		/* Ok, create a new expression, the 
+		 * existing one is the left hand */
+		Binary = new (m_pArena) BinaryExpression(Operator);
+		Binary->SetExpression1(Expr);
+		Binary->SetExpression2(ParseBinary(Precedence + 1));
 
-			/* Skip the right parenthesis */
-			Used++;
-		}
-		else if (m_lElements[ModIndex]->GetType() == StringLiteral) {
+		/* Update */
+		Expr = Binary;
+	}
+	return Expr;
+}
 
-			/* Create a new string value object */
-			StringValue *StrVal = new StringValue(m_lElements[ModIndex]->GetData());
+/* Parses an operand, unary operators and
+ * parenthesized sub-expressions included */
+Expression *Parser::ParseUnary()
+{
+	/* Now, let's check... */
+	const Token_t &Current = m_pScanner->Peek(0);
+	ExpressionBinaryOperator_t Operator;
 
-			/* Save it */
-			Expr = StrVal;
-			Used++;
-		}
-		else if (m_lElements[ModIndex]->GetType() == DigitLiteral) {
+	if (Current.Type == OperatorSubtract) {
 
-			/* Create a new digit value object */
-			IntValue *IntVal = new IntValue(m_lElements[ModIndex]->GetData());
+		/* Negation, literals are negated right away */
+		Expression *Operand = NULL;
+		m_pScanner->NextToken();
+		Operand = ParseUnary();
 
-			/* Save it */
-			Expr = IntVal;
-			Used++;
+		if (Operand != NULL && Operand->GetType() == ExprInteger) {
+			long long Value = ((IntValue*)Operand)->GetValue();
+			return new (m_pArena) IntValue((long long)(0ULL - (unsigned long long)Value));
 		}
-		else if (m_lElements[ModIndex]->GetType() == Identifier
-			&& m_lElements[ModIndex + 1]->GetType() == LeftParenthesis) {
-			/* Function calls in expressions 
-			 * not really supported atm */
-			printf("Functions calls in expressions are currently unsupported, line %u\n",
-				m_lElements[ModIndex]->GetLineNumber());
+		if (Operand != NULL && Operand->GetType() == ExprFloat) {
+			double Value = ((FloatValue*)Operand)->GetValue();
+			return new (m_pArena) FloatValue(-Value);
 		}
-		else if (m_lElements[ModIndex]->GetType() == Identifier) {
+		return new (m_pArena) UnaryExpression(ExprOperatorNegate, Operand);
+	}
+	else if (Current.Type == LeftParenthesis) {
 
-			/* Create a new variable value object */
-			Variable *Var = new Variable(m_lElements[ModIndex]->GetData());
-			
-			/* Save it */
-			Expr = Var;
-			Used++;
-		}
-		/* Now we check for operators!! 
-		 * operators are allowed, we just need to be careful */
-		else if (m_lElements[ModIndex]->GetType() == OperatorAdd
-			|| m_lElements[ModIndex]->GetType() == OperatorSubtract
-			|| m_lElements[ModIndex]->GetType() == OperatorDivide
-			|| m_lElements[ModIndex]->GetType() == OperatorMultiply) {
-
-			/* Do the sanity check, no + operators to start with */
-			if (Expr == NULL
-				&& m_lElements[ModIndex]->GetType() != OperatorSubtract) {
-				printf("Expression cannot be started with element of type %s, line %u\n",
-					m_lElements[ModIndex]->GetName(), m_lElements[ModIndex]->GetLineNumber());
-			}
+		/* Consume the left paranthesis */
+		Token_t Token = m_pScanner->NextToken();
+		Expression *Expr = NULL;
+
+		/* Parse sub-expression in expression */
+		Expr = ParseBinary(1);
 
-			/* Determine correct expr-operator */
-			ExpressionBinaryOperator_t ExprOperator;
-			BinaryExpression *Binary = NULL;
-			Expression *Expr2 = NULL;
-
-			/* Switch.. */
-			if (m_lElements[ModIndex]->GetType() == OperatorAdd)
-				ExprOperator = ExprOperatorAdd;
-			else if (m_lElements[ModIndex]->GetType() == OperatorSubtract)
-				ExprOperator = ExprOperatorSubtract;
-			else if (m_lElements[ModIndex]->GetType() == OperatorDivide)
-				ExprOperator = ExprOperatorDivide;
-			else if (m_lElements[ModIndex]->GetType() == OperatorMultiply)
-				ExprOperator = ExprOperatorMultiply;
-            else {
-                // @todo
-                printf("Expressions");
-                return 0;
-            }
-
-			/* Ok, create a new expression */
-			Binary = new BinaryExpression(ExprOperator);
-
-			/* Take the already existing expression, set it as left hand */
-			Binary->SetExpression1(Expr);
-
-			/* Skip this element */
-			Used++;
-
-			/* Parse the next expression */
-			Used += ParseExpression(ModIndex + 1, &Expr2);
-
-			/* Set second expression */
-			Binary->SetExpression2(Expr2);
-
-			/* Update */
-			Expr = Binary;
+		/* Skip the right parenthesis */
+		if (m_pScanner->Peek(0).Type != RightParenthesis) {
+			ReportAt(Token, "Missing ')' for the '(' at line %u\n", m_pScanner->GetLine(Token));
+			m_iError = -1;
 		}
 		else {
-			/* ERROR - ERRROR - ABBOOOOORT */
-			printf("Element of type %s in expressions are currently unsupported, line %u\n",
-				m_lElements[ModIndex]->GetName(), m_lElements[ModIndex]->GetLineNumber());
-
-			/* Skip */
-			Used++;
+			m_pScanner->NextToken();
 		}
+		return Expr;
+	}
+	else if (Current.Type == StringLiteral) {
 
-		/* Consumeeee */
-		Consumed += Used;
-		ModIndex += Used;
+		/* Create a new string value object */
+		Token_t Token = m_pScanner->NextToken();
+		return new (m_pArena) StringValue(m_pArena->CopyText(m_pScanner->GetText(Token), Token.Length));
 	}
+	else if (Current.Type == DigitLiteral) {
 
-	/* Update parent */
-	*Parent = Expr;
+		/* Create a new digit value object */
+		return new (m_pArena) IntValue(m_pScanner->NextToken().Value.Integer);
+	}
+	else if (Current.Type == FloatLiteral) {
 
-	/* Done ! */
-	return Consumed;
-}
\ No newline at end of file
+		/* Create a new float value object */
+		return new (m_pArena) FloatValue(m_pScanner->NextToken().Value.Float);
+	}
+	else if (Current.Type == Identifier
+		&& m_pScanner->Peek(1).Type == LeftParenthesis) {
+
+		/* Function call */
+		return ParseCall();
+	}
+	else if (Current.Type == Identifier) {
+
+		/* Create a new variable value object */
+		return new (m_pArena) Variable(m_pScanner->NextToken().Symbol);
+	}
+	else if (GetPrecedence(Current.Type, &Operator) != 0) {
+
+		/* Do the sanity check, no binary operators to start with */
+		Token_t Token = m_pScanner->NextToken();
+		ReportAt(Token, "Expression cannot be started with element of type %s, line %u\n",
+			GetElementName(Token.Type), m_pScanner->GetLine(Token));
+		m_iError = -1;
+		return ParseUnary();
+	}
+	else if (Current.Type == OperatorSemiColon
+		|| Current.Type == RightParenthesis
+		|| Current.Type == UNKNOWN) {
+
+		/* The operand is missing, leave the end for the caller */
+		ReportAt(Current, "Missing operand before element of type %s, line %u\n",
+			GetElementName(Current.Type), m_pScanner->GetLine(Current));
+		m_iError = -1;
+		return NULL;
+	}
+
+	/* ERROR - ERRROR - ABBOOOOORT */
+	ReportAt(Current, "Element of type %s in expressions are currently unsupported, line %u\n",
+		GetElementName(Current.Type), m_pScanner->GetLine(Current));
+
+	/* Skip */
+	m_pScanner->NextToken();
+	return NULL;
+}
+
+/* Parses a function call, the name and its argument list.
+ * The arguments are collected on the shared list while 
+ * nested calls are parsed on top of them */
+Expression *Parser::ParseCall()
+{
+	/* Variables */
+	int Identifier = m_pScanner->NextToken().Symbol;
+	Token_t Open = m_pScanner->NextToken();
+	size_t First = m_lArguments.size();
+	Expression **Arguments = NULL;
+	size_t Count;
+
+	/* Arguments seperated by ',' */
+	while (m_pScanner->Peek(0).Type != RightParenthesis) {
+		m_lArguments.push_back(ParseBinary(1));
+		if (m_pScanner->Peek(0).Type == OperatorComma) {
+			m_pScanner->NextToken();
+		}
+		else if (m_pScanner->Peek(0).Type != RightParenthesis) {
+			ReportAt(Open, "Missing ')' for the call at line %u\n", m_pScanner->GetLine(Open));
+			m_iError = -1;
+			break;
+		}
+	}
+
+	/* Skip the right parenthesis */
+	if (m_pScanner->Peek(0).Type == RightParenthesis) {
+		m_pScanner->NextToken();
+	}
+
+	/* Move the arguments into the arena */
+	Count = m_lArguments.size() - First;
+	if (Count != 0) {
+		Arguments = (Expression**)m_pArena->Allocate(Count * sizeof(Expression*));
+		if (Arguments == NULL) {
+			throw std::bad_alloc();
+		}
+		memcpy(Arguments, &m_lArguments[First], Count * sizeof(Expression*));
+		m_lArguments.resize(First);
+	}
+	return new (m_pArena) CallExpression(Identifier, Arguments, Count);
+}
@@ -16,42 +16,107 @@
 * along with this program.If not, see <http://www.gnu.org/licenses/>.
 *
 *
-* Macia - Parser
-* - Turns an element list into a program structure
+* - Pulls elements from the scanner into a program structure
 */
 #pragma once
 
 /* Includes */
-#include "../shared/element.h"
+#include "../lexer/scanner.h"
 #include "statement.h"
 #include <vector>
 
+/* Sources smaller than this are always parsed on the 
+ * calling thread, threads wouldn't pay off */
+#define PARSER_PARALLEL_MIN_LENGTH	65536
+
+/* Number of ranges handed out per thread, more 
+ * than one so uneven ranges still balance out */
+#define PARSER_RANGES_PER_THREAD	4
+
+/* The modifiers that can be given before a 
+ * statement, they are collected into a mask */
+typedef enum {
+	ModifierConst		= 0x1,
+	ModifierLocked		= 0x2,
+	ModifierReadonly	= 0x4
+} StatementModifier_t;
+
+/* A range of top-level declarations that is 
+ * parsed on its own, into its own arena and with 
+ * its own symbol table. Map translates the ids of
+ * that table to the shared one. Space is the top-level
+ * namespace the declarations are in, or -1 */
+typedef struct {
+	size_t Start;
+	size_t Length;
+	Arena *Nodes;
+	SymbolTable *Symbols;
+	Statement *Program;
+	std::vector<int> *Map;
+	size_t Tokens;
+	int Failed;
+	int Space;
+} ParseRange_t;
+
 /* The class
- * Takes a element-list and parses it
- * into a program-structure list of expressions
- * and statements */
+ * Pulls tokens from a scanner and parses 
+ * them into a program-structure list of expressions
+ * and statements, only a few tokens of lookahead 
+ * are ever kept. The nodes are allocated in an arena,
+ * either the one given or one the parser owns, and 
+ * are released together with it */
 class Parser
 {
 public:
-	Parser(std::vector<Element*> &Elements);
+	Parser(Scanner *pScanner, Arena *pArena = NULL);
 	~Parser();
 
 	/* This runs the actual parsing 
 	 * process, use GetProgram to retrieve
-	 * the results */
-	int Parse();
+	 * the results. Large sources are split at their
+	 * top-level declarations and parsed on up to 
+	 * Threads threads, 0 uses one per core. The
+	 * result and the messages are the same as when 
+	 * parsed on a single thread */
+	int Parse(int Threads = 1);
+
+	/* Parses the next top-level declaration into Parent, for 
+	 * callers that keep declarations apart. Returns 1 when one 
+	 * was parsed, 0 at the end of the source and -1 on errors */
+	int ParseDeclaration(Statement **Parent);
+
+	/* Gets */
+	int GetError() { return m_iError; }
+	size_t GetTokenCount() { return m_iTokenCount + m_pScanner->GetTokenCount(); }
+	size_t GetRangeCount() { return m_iRanges; }
 
 	/* Retrieve the program AST */
 	Statement *GetProgram() { return m_pBase; }
+	Arena *GetArena() { return m_pArena; }
 
 private:
 	/* Private - Functions */
-	int ParseExpression(int Index, Expression **Parent);
-	int ParseStatement(int Index, Statement **Parent);
-	int ParseModifiers(int Index, int *Modifiers);
+	int ParseExpression(Expression **Parent);
+	Expression *ParseBinary(int MinPrecedence);
+	Expression *ParseUnary();
+	Expression *ParseCall();
+	int ParseStatement(Statement **Parent);
+	int ParseModifiers(int *Modifiers);
+	void ParseParameters(Function *Func);
+	void ParseBody(Statement **Body);
+	Sequence *CreateSequence(size_t First);
+	int ParseParallel(int Threads);
+	void ReportAt(const Token_t &Token, const char *Format, ...);
 
 	/* Private - Data */
-	std::vector<Element*> m_lElements;
+	Scanner *m_pScanner;
 	Statement *m_pBase;
+	std::vector<Statement*> m_lStatements;
+	std::vector<Expression*> m_lArguments;
+	Arena *m_pArena;
+	std::vector<Arena*> m_lArenas;
+	size_t m_iTokenCount;
+	size_t m_iRanges;
+	int m_iOwnsArena;
+	int m_iError;
 };
-
@@ -32,6 +32,8 @@ typedef enum
 {
 	StmtDeclaration,
 
+	StmtNamespace,
+	StmtImport,
 	StmtObject,
 	StmtFunction,
 
@@ -39,7 +41,7 @@ typedef enum
 	StmtCall,
 
 	/* This is the sequence
-	 * it chains together actions */
+	 * it lists actions in order */
 	StmtSequence
 
 } StatementType_t;
@@ -50,7 +52,17 @@ class Statement
 {
 public:
 	Statement(StatementType_t Type) { m_eType = Type; }
-	virtual ~Statement() {}
+
+	/* Statements live in the arena of the parse 
+	 * and are released with it, never one by one */
+	static void *operator new(size_t Size, Arena *pArena) {
+		void *Memory = pArena->Allocate(Size);
+		if (Memory == NULL) {
+			throw std::bad_alloc();
+		}
+		return Memory;
+	}
+	static void operator delete(void *, Arena *) { }
 
 	/* Type of expression */
 	StatementType_t GetType() { return m_eType; }
@@ -65,13 +77,17 @@ private:
 class Declaration : public Statement
 {
 public:
-	Declaration(const char *pOfType, const char *pIdentifier) : Statement(StmtDeclaration) {
-		m_pIdentifier = strdup(pIdentifier);
-		m_pOfType = strdup(pOfType);
+	Declaration(int OfType, int Identifier) : Statement(StmtDeclaration) {
+		m_iIdentifier = Identifier;
+		m_iOfType = OfType;
+		m_iModifiers = 0;
 		m_pExpression = NULL;
 	}
-	~Declaration() {
-		free((void*)m_pIdentifier);
+
+	/* Update the mask of StatementModifier_t 
+	 * that were given before the declaration */
+	void SetModifiers(int Modifiers) {
+		m_iModifiers = Modifiers;
 	}
 
 	/* Update expression */
@@ -79,14 +95,23 @@ public:
 		m_pExpression = pExpression;
 	}
 
-	/* Gets */
-	const char *GetOfType() { return m_pOfType; }
-	const char *GetIdentifier() { return m_pIdentifier; }
+	/* Update identifiers, when the symbols 
+	 * move to another symbol table */
+	void SetIdentifiers(int OfType, int Identifier) {
+		m_iOfType = OfType;
+		m_iIdentifier = Identifier;
+	}
+
+	/* Gets, identifiers are symbol ids */
+	int GetOfType() { return m_iOfType; }
+	int GetIdentifier() { return m_iIdentifier; }
+	int GetModifiers() { return m_iModifiers; }
 	Expression *GetExpression() { return m_pExpression; }
 
 private:
-	const char *m_pOfType;
-	const char *m_pIdentifier;
+	int m_iOfType;
+	int m_iIdentifier;
+	int m_iModifiers;
 	Expression *m_pExpression;
 };
 
@@ -95,55 +120,111 @@ private:
 class Assignment : public Statement
 {
 public:
-	Assignment(const char *pIdentifier) : Statement(StmtAssign) {
-		m_pIdentifier = strdup(pIdentifier);
+	Assignment(int Identifier) : Statement(StmtAssign) {
+		m_iIdentifier = Identifier;
 		m_pExpression = NULL;
 	}
-	~Assignment() {
-		free((void*)m_pIdentifier);
-	}
 
 	/* Update expression */
 	void SetExpression(Expression *pExpression) {
 		m_pExpression = pExpression;
 	}
 
-	/* Gets */
-	const char *GetIdentifier() { return m_pIdentifier; }
+	/* Update identifier, when the symbol 
+	 * moves to another symbol table */
+	void SetIdentifier(int Identifier) {
+		m_iIdentifier = Identifier;
+	}
+
+	/* Gets, identifiers are symbol ids */
+	int GetIdentifier() { return m_iIdentifier; }
 	Expression *GetExpression() { return m_pExpression; }
 
 private:
-	const char *m_pIdentifier;
+	int m_iIdentifier;
 	Expression *m_pExpression;
 };
 
+/* The namespace class
+ * This describes a Macia-Namespace, it is 
+ * compiled into a module of its own */
+class Namespace : public Statement
+{
+public:
+	Namespace(int Identifier) : Statement(StmtNamespace) {
+		m_iIdentifier = Identifier;
+		m_pBody = NULL;
+	}
+
+	/* Update body - statement */
+	void SetBody(Statement *pStmt) {
+		m_pBody = pStmt;
+	}
+
+	/* Update identifier, when the symbol 
+	 * moves to another symbol table */
+	void SetIdentifier(int Identifier) {
+		m_iIdentifier = Identifier;
+	}
+
+	/* Gets, identifiers are symbol ids */
+	int GetIdentifier() { return m_iIdentifier; }
+	Statement *GetBody() { return m_pBody; }
+
+private:
+	int m_iIdentifier;
+	Statement *m_pBody;
+};
+
+/* The import class
+ * This describes the import of a namespace */
+class Import : public Statement
+{
+public:
+	Import(int Identifier) : Statement(StmtImport) {
+		m_iIdentifier = Identifier;
+	}
+
+	/* Update identifier, when the symbol 
+	 * moves to another symbol table */
+	void SetIdentifier(int Identifier) {
+		m_iIdentifier = Identifier;
+	}
+
+	/* Gets, identifiers are symbol ids */
+	int GetIdentifier() { return m_iIdentifier; }
+
+private:
+	int m_iIdentifier;
+};
+
 /* The object class
  * This describes an Macia-Object */
 class Object : public Statement
 {
 public:
-	Object(const char *pIdentifier) : Statement(StmtObject) {
-		m_pIdentifier = strdup(pIdentifier);
+	Object(int Identifier) : Statement(StmtObject) {
+		m_iIdentifier = Identifier;
 		m_pBody = NULL;
 	}
-	~Object() {
-		free((void*)m_pIdentifier);
-		if (m_pBody != NULL) {
-			delete m_pBody;
-		}
-	}
 
 	/* Update body - statement */
 	void SetBody(Statement *pStmt) {
 		m_pBody = pStmt;
 	}
 
-	/* Gets */
-	const char *GetIdentifier() { return m_pIdentifier; }
+	/* Update identifier, when the symbol 
+	 * moves to another symbol table */
+	void SetIdentifier(int Identifier) {
+		m_iIdentifier = Identifier;
+	}
+
+	/* Gets, identifiers are symbol ids */
+	int GetIdentifier() { return m_iIdentifier; }
 	Statement *GetBody() { return m_pBody; }
 
 private:
-	const char *m_pIdentifier;
+	int m_iIdentifier;
 	Statement *m_pBody;
 };
 
@@ -152,57 +233,88 @@ private:
 class Function : public Statement
 {
 public:
-	Function(const char *pIdentifier) : Statement(StmtFunction) {
-		m_pIdentifier = strdup(pIdentifier);
+	Function(int Identifier) : Statement(StmtFunction) {
+		m_iIdentifier = Identifier;
+		m_iModifiers = 0;
+		m_pParameters = NULL;
+		m_iParameterCount = 0;
 		m_pBody = NULL;
 	}
-	~Function() {
-		free((void*)m_pIdentifier);
-		if (m_pBody != NULL) {
-			delete m_pBody;
-		}
+
+	/* Update the mask of StatementModifier_t 
+	 * that were given before the function */
+	void SetModifiers(int Modifiers) {
+		m_iModifiers = Modifiers;
 	}
 
-	/* Update arguments, variable list */
+	/* Update arguments, variable list 
+	 * the declarations are kept in the arena */
+	void SetParameters(Declaration **Parameters, size_t Count) {
+		m_pParameters = Parameters;
+		m_iParameterCount = Count;
+	}
 
 	/* Update body - statement */
 	void SetBody(Statement *pStmt) {
 		m_pBody = pStmt;
 	}
 
-	/* Gets */
-	const char *GetIdentifier() { return m_pIdentifier; }
+	/* Update identifier, when the symbol 
+	 * moves to another symbol table */
+	void SetIdentifier(int Identifier) {
+		m_iIdentifier = Identifier;
+	}
+
+	/* Gets, identifiers are symbol ids */
+	int GetIdentifier() { return m_iIdentifier; }
+	int GetModifiers() { return m_iModifiers; }
 	Statement *GetBody() { return m_pBody; }
+	size_t GetParameterCount() { return m_iParameterCount; }
+	Declaration *GetParameter(size_t Index) { return m_pParameters[Index]; }
 
 private:
-	const char *m_pIdentifier;
+	int m_iIdentifier;
+	int m_iModifiers;
+	Declaration **m_pParameters;
+	size_t m_iParameterCount;
 	Statement *m_pBody;
 };
 
+/* The call class
+ * This describes a function call whose
+ * result is not used */
+class Call : public Statement
+{
+public:
+	Call(CallExpression *pCall) : Statement(StmtCall) {
+		m_pCall = pCall;
+	}
+
+	/* Gets */
+	CallExpression *GetCall() { return m_pCall; }
+
+private:
+	CallExpression *m_pCall;
+};
+
 /* The sequence class
- * This describes an statement sequence */
+ * This describes an statement sequence, the 
+ * statements of a body kept in source order 
+ * as one contiguous array */
 class Sequence : public Statement
 {
 public:
-	Sequence(Statement *Stmt1, Statement *Stmt2) 
+	Sequence(Statement **Statements, size_t Count) 
 		: Statement(StmtSequence) {
-		m_pStmt1 = Stmt1;
-		m_pStmt2 = Stmt2;
-	}
-	~Sequence() {
-		if (m_pStmt1 != NULL) {
-			delete m_pStmt1;
-		}
-		if (m_pStmt2 != NULL) {
-			delete m_pStmt2;
-		}
+		m_pStatements = Statements;
+		m_iCount = Count;
 	}
 
 	/* Gets */
-	Statement *GetStatement1() { return m_pStmt1; }
-	Statement *GetStatement2() { return m_pStmt2; }
+	size_t GetCount() { return m_iCount; }
+	Statement *GetStatement(size_t Index) { return m_pStatements[Index]; }
 
 private:
-	Statement *m_pStmt1;
-	Statement *m_pStmt2;
-};
\ No newline at end of file
+	Statement **m_pStatements;
+	size_t m_iCount;
+};
@@ -0,0 +1,125 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Arena (Shared)
+* - Bump allocator for memory that is released all at once
+*/
+
+/* Includes */
+#include "arena.h"
+#include <cstdlib>
+#include <cstring>
+
+/* Allocations are rounded up to this, it
+ * is enough for any type the AST holds */
+#define ARENA_ALIGNMENT		16
+#define ARENA_ALIGN(Size)	(((Size) + (ARENA_ALIGNMENT - 1)) & ~((size_t)ARENA_ALIGNMENT - 1))
+
+/* Size of the block header, the data follows it */
+#define ARENA_HEADER_SIZE	ARENA_ALIGN(sizeof(ArenaBlock_t))
+
+/* Constructor
+ * Nothing is allocated before the first allocation */
+Arena::Arena(size_t BlockSize) {
+	m_pBlocks = NULL;
+	m_pCursor = NULL;
+	m_iLeft = 0;
+	m_iBlockSize = ARENA_ALIGN(BlockSize);
+	m_iSize = 0;
+}
+
+/* Destructor
+ * Releases all blocks in one go */
+Arena::~Arena() {
+	while (m_pBlocks != NULL) {
+		ArenaBlock_t *Link = m_pBlocks->Link;
+		free(m_pBlocks);
+		m_pBlocks = Link;
+	}
+}
+
+/* Allocates a block with room for Size bytes of data */
+Arena::ArenaBlock_t *Arena::NewBlock(size_t Size) {
+	ArenaBlock_t *Block = (ArenaBlock_t*)malloc(ARENA_HEADER_SIZE + Size);
+	if (Block != NULL) {
+		m_iSize += ARENA_HEADER_SIZE + Size;
+	}
+	return Block;
+}
+
+/* Allocates memory aligned for any type, 
+ * returns NULL when out of memory */
+void *Arena::Allocate(size_t Size) {
+
+	/* Variables */
+	ArenaBlock_t *Block;
+	void *Memory;
+
+	/* Keep the cursor aligned */
+	Size = ARENA_ALIGN((Size == 0) ? 1 : Size);
+
+	/* Fast path, it fits the current block */
+	if (Size <= m_iLeft) {
+		Memory = m_pCursor;
+		m_pCursor += Size;
+		m_iLeft -= Size;
+		return Memory;
+	}
+
+	/* Large allocations get a block of their own, it is 
+	 * linked behind the current one which stays in use */
+	if (Size > m_iBlockSize / 4) {
+		Block = NewBlock(Size);
+		if (Block == NULL) {
+			return NULL;
+		}
+		if (m_pBlocks != NULL) {
+			Block->Link = m_pBlocks->Link;
+			m_pBlocks->Link = Block;
+		}
+		else {
+			Block->Link = NULL;
+			m_pBlocks = Block;
+		}
+		return (char*)Block + ARENA_HEADER_SIZE;
+	}
+
+	/* Start a new block */
+	Block = NewBlock(m_iBlockSize);
+	if (Block == NULL) {
+		return NULL;
+	}
+	Block->Link = m_pBlocks;
+	m_pBlocks = Block;
+
+	Memory = (char*)Block + ARENA_HEADER_SIZE;
+	m_pCursor = (char*)Memory + Size;
+	m_iLeft = m_iBlockSize - Size;
+	return Memory;
+}
+
+/* Creates a null-terminated copy of a text view,
+ * returns NULL when out of memory */
+char *Arena::CopyText(const char *pText, size_t Length) {
+	char *pCopy = (char*)Allocate(Length + 1);
+	if (pCopy != NULL) {
+		memcpy(pCopy, pText, Length);
+		pCopy[Length] = '\0';
+	}
+	return pCopy;
+}
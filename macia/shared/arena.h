@@ -0,0 +1,69 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Arena (Shared)
+* - Bump allocator for memory that is released all at once
+*/
+#pragma once
+
+/* Includes */
+#include <cstddef>
+
+/* Default size of the blocks allocations are cut from */
+#define ARENA_BLOCK_SIZE	16384
+
+/* The arena
+ * Allocations are cut from large blocks by moving a cursor, 
+ * and are never freed one by one. All of it is released when
+ * the arena is destroyed. Allocations that are large compared
+ * to the block size get a block of their own, so they don't 
+ * waste what is left of the current one. Nothing allocated 
+ * here has its destructor run */
+class Arena
+{
+public:
+	Arena(size_t BlockSize = ARENA_BLOCK_SIZE);
+	~Arena();
+
+	/* Allocates memory aligned for any type, 
+	 * returns NULL when out of memory */
+	void *Allocate(size_t Size);
+
+	/* Creates a null-terminated copy of a text view,
+	 * the view itself need not be terminated */
+	char *CopyText(const char *pText, size_t Length);
+
+	/* Gets */
+	size_t GetSize() { return m_iSize; }
+
+private:
+	/* Private - Definitions */
+	typedef struct ArenaBlock {
+		struct ArenaBlock *Link;
+	} ArenaBlock_t;
+
+	/* Private - Functions */
+	ArenaBlock_t *NewBlock(size_t Size);
+
+	/* Private - Data */
+	ArenaBlock_t *m_pBlocks;
+	char *m_pCursor;
+	size_t m_iLeft;
+	size_t m_iBlockSize;
+	size_t m_iSize;
+};
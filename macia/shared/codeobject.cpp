@@ -25,13 +25,14 @@
 #include "codeobject.h"
 
 /* Constructor 
- * Initialize and setup vars */
-CodeObject::CodeObject(CodeType_t pType, const char *pIdentifier,
+ * Initialize and setup vars, the path must be
+ * allocated by malloc and is freed with us */
+CodeObject::CodeObject(CodeType_t pType, int pSymbol,
 	const char *pPath, int pScopeId) {
 
 	/* Store */
 	m_eType = pType;
-	m_pIdentifier = strdup(pIdentifier);
+	m_iSymbol = pSymbol;
 	m_pPath = pPath;
 	m_iScopeId = pScopeId;
 
@@ -39,17 +40,15 @@ CodeObject::CodeObject(CodeType_t pType, const char *pIdentifier,
 	m_iFunctionsDefined = 0;
 	m_iVariablesDefined = 0;
 	m_iOffset = 0;
-
-	/* Clear out */
-	m_lByteCode.clear();
+	m_iArgumentCount = 0;
+	m_iModule = -1;
 }
 
 /* Destructor 
- * Cleanup the name variables */
+ * The path is owned by the object, 
+ * the code goes with the writer */
 CodeObject::~CodeObject() {
-	m_lByteCode.clear();
-	if (m_pIdentifier != NULL)
-		free(m_pIdentifier);
+	free((void*)m_pPath);
 }
 
 /* State Tracking
@@ -26,6 +26,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <vector>
+#include "../generator/bytecodewriter.h"
 
 /* The code type
  * Identifies the type of the code object */
@@ -35,16 +36,21 @@ typedef enum {
 	CTObject,
 	CTFunction,
 	CTVariable,
-	CTString
+	CTString,
+	CTNamespace
 
 } CodeType_t;
 
+/* Set in the serialized type of objects that live in an
+ * imported module, they are bound when first used */
+#define CT_IMPORTED		0x80
+
 /* The code object
  * Represents everything that is serializable to IL */
 class CodeObject
 {
 public:
-	CodeObject(CodeType_t pType, const char *pIdentifier,
+	CodeObject(CodeType_t pType, int pSymbol,
 		const char *pPath, int pScopeId);
 	~CodeObject();
 
@@ -55,24 +61,31 @@ public:
 	int AllocateVariableOffset();
 	void SetOffset(int Offset) { m_iOffset = Offset; }
 
-	/* Add Code */
-	void AddCode(unsigned char Opcode) { m_lByteCode.push_back(Opcode); }
+	/* Functions take a fixed number of arguments, 
+	 * they are the first variables of the function */
+	void SetArgumentCount(int Count) { m_iArgumentCount = Count; }
+
+	/* Objects of imported modules have no code here, 
+	 * this is the index of the import, -1 for our own */
+	void SetModule(int Module) { m_iModule = Module; }
 
-	/* Gets */
-	std::vector<unsigned char> &GetCode() { return m_lByteCode; }
+	/* Gets, code is written through the writer */
+	BytecodeWriter &GetCode() { return m_Code; }
 	CodeType_t GetType() { return m_eType; }
 	const char *GetPath() { return m_pPath; }
-	char *GetIdentifier() { return m_pIdentifier; }
+	int GetSymbol() { return m_iSymbol; }
 	int GetScopeId() { return m_iScopeId; }
 	int GetOffset() { return m_iOffset; }
+	int GetArgumentCount() { return m_iArgumentCount; }
+	int GetModule() { return m_iModule; }
 
 private:
 	/* Private - ByteCode */
-	std::vector<unsigned char> m_lByteCode;
+	BytecodeWriter m_Code;
 
 	/* Private - Data */
 	CodeType_t m_eType;
-	char *m_pIdentifier;
+	int m_iSymbol;
 	const char *m_pPath;
 	int m_iScopeId;
 
@@ -80,4 +93,6 @@ private:
 	int m_iFunctionsDefined;
 	int m_iVariablesDefined;
 	int m_iOffset;
+	int m_iArgumentCount;
+	int m_iModule;
 };
@@ -23,418 +23,469 @@
 
 /* Includes */
 #include "datapool.h"
-#include <strings.h>
 #include <cstdio>
 
+/* Initial number of index slots, must be a power of two */
+#define DATAPOOL_INIT_SLOTS		256
+
+/* The path strings are stored under */
+#define DATAPOOL_STRING_PREFIX	"StringPool."
+
+/* Mixes a scope and a symbol into the hash of the symbol index */
+static unsigned int HashSymbol(int ScopeId, int Symbol) {
+	unsigned int Hash = ((unsigned int)(ScopeId + 1) * 2654435761u) ^ ((unsigned int)Symbol * 2246822519u);
+	return Hash ^ (Hash >> 15);
+}
+
+/* FNV-1a over a number of bytes, continued from the given 
+ * hash so a path can be hashed in pieces */
+static unsigned int HashBytes(unsigned int Hash, const char *pData, size_t Length) {
+	for (size_t i = 0; i < Length; i++) {
+		Hash ^= (unsigned char)pData[i];
+		Hash *= 16777619u;
+	}
+	return Hash;
+}
+
+/* FNV-1a over the path */
+static unsigned int HashPath(const char *pPath) {
+	return HashBytes(2166136261u, pPath, strlen(pPath));
+}
+
 /* Constructor 
  * Initialize the data pool etc */
-DataPool::DataPool() {
+DataPool::DataPool(SymbolTable *Symbols) {
 
 	/* Initialize */
-	m_iIdGen = 0;
-
-	/* Clear out to be sure */
-	m_sTable.clear();
+	m_pSymbols = Symbols;
+
+	/* Setup the initial index slots */
+	m_iSlotCount = DATAPOOL_INIT_SLOTS;
+	m_pSymbolSlots = (int*)malloc(m_iSlotCount * sizeof(int));
+	m_pPathSlots = (int*)malloc(m_iSlotCount * sizeof(int));
+	memset(m_pSymbolSlots, 0xFF, m_iSlotCount * sizeof(int));
+	memset(m_pPathSlots, 0xFF, m_iSlotCount * sizeof(int));
 }
 
 /* Destructor 
  * - Handles cleanup */
 DataPool::~DataPool() {
+	for (size_t i = 0; i < m_lObjects.size(); i++) {
+		delete m_lObjects[i];
+	}
+	for (size_t i = 0; i < m_lImports.size(); i++) {
+		delete m_lImports[i];
+	}
+	free(m_pSymbolSlots);
+	free(m_pPathSlots);
+}
 
+/* Locates a symbol in the given scope, returns the
+ * id, or -1 with Slot set to the free slot */
+int DataPool::FindSymbol(int Symbol, int ScopeId, size_t *Slot) {
+	size_t Mask = m_iSlotCount - 1;
+	size_t Index = HashSymbol(ScopeId, Symbol) & Mask;
+
+	/* Linear probing */
+	while (m_pSymbolSlots[Index] != -1) {
+		CodeObject *Obj = m_lObjects[m_pSymbolSlots[Index]];
+		if (Obj->GetSymbol() == Symbol && Obj->GetScopeId() == ScopeId) {
+			return m_pSymbolSlots[Index];
+		}
+		Index = (Index + 1) & Mask;
+	}
+
+	*Slot = Index;
+	return -1;
 }
 
-/* Checks for dublicates path */
-int DataPool::CheckDublicate(const char *pIdentifier, const char *pPath) {
-	
-	/* Iterate our code objects */
-	for (std::map<int, CodeObject*>::iterator Itr = m_sTable.begin();
-		Itr != m_sTable.end(); ++Itr)
-	{
-		/* Get dataobject */
-		CodeObject *Obj = Itr->second;
+/* Locates a path, returns the id, or 
+ * -1 with Slot set to the free slot */
+int DataPool::FindPath(const char *pPath, size_t *Slot) {
+	size_t Mask = m_iSlotCount - 1;
+	size_t Index = HashPath(pPath) & Mask;
 
-		/* Compare path */
-		if (!strcasecmp(Obj->GetPath(), pPath)) {
+	/* Linear probing */
+	while (m_pPathSlots[Index] != -1) {
+		if (!strcmp(m_lObjects[m_pPathSlots[Index]]->GetPath(), pPath)) {
+			return m_pPathSlots[Index];
+		}
+		Index = (Index + 1) & Mask;
+	}
 
-			/* So, it exists */
-			printf("Dublicate objects with name %s\n", pIdentifier);
+	*Slot = Index;
+	return -1;
+}
 
-			/* Err, bail out */
-			return -1;
+/* Locates a string of the string pool by the full literal, 
+ * returns the id, or -1 with Slot set to the free slot */
+int DataPool::FindString(const char *pString, size_t Length, size_t *Slot) {
+	size_t Prefix = sizeof(DATAPOOL_STRING_PREFIX) - 1;
+	size_t Mask = m_iSlotCount - 1;
+	size_t Index = HashBytes(HashBytes(2166136261u, DATAPOOL_STRING_PREFIX, Prefix), 
+		pString, Length) & Mask;
+
+	/* Linear probing */
+	while (m_pPathSlots[Index] != -1) {
+		CodeObject *Obj = m_lObjects[m_pPathSlots[Index]];
+		if (Obj->GetType() == CTString 
+			&& strlen(Obj->GetPath()) == Prefix + Length
+			&& !memcmp(Obj->GetPath() + Prefix, pString, Length)) {
+			return m_pPathSlots[Index];
 		}
+		Index = (Index + 1) & Mask;
+	}
+
+	*Slot = Index;
+	return -1;
+}
+
+/* Doubles the slots and reinserts all code objects */
+void DataPool::Rehash() {
+	free(m_pSymbolSlots);
+	free(m_pPathSlots);
+	m_iSlotCount *= 2;
+	m_pSymbolSlots = (int*)malloc(m_iSlotCount * sizeof(int));
+	m_pPathSlots = (int*)malloc(m_iSlotCount * sizeof(int));
+	memset(m_pSymbolSlots, 0xFF, m_iSlotCount * sizeof(int));
+	memset(m_pPathSlots, 0xFF, m_iSlotCount * sizeof(int));
+
+	for (size_t i = 0; i < m_lObjects.size(); i++) {
+		Index((int)i);
+	}
+}
+
+/* Adds a code object to the indices, strings have 
+ * no symbol and are only found by their path */
+void DataPool::Index(int Id) {
+	CodeObject *Obj = m_lObjects[Id];
+	size_t Slot = 0;
+
+	if (Obj->GetSymbol() != -1
+		&& FindSymbol(Obj->GetSymbol(), Obj->GetScopeId(), &Slot) == -1) {
+		m_pSymbolSlots[Slot] = Id;
+	}
+	if (FindPath(Obj->GetPath(), &Slot) == -1) {
+		m_pPathSlots[Slot] = Id;
+	}
+}
+
+/* Stores a new code object and returns its id, 
+ * ids are dense and index the object list */
+int DataPool::Insert(CodeObject *Obj) {
+	int Id = (int)m_lObjects.size();
+
+	/* Keep the load below one half */
+	m_lObjects.push_back(Obj);
+	if (m_lObjects.size() * 2 > m_iSlotCount) {
+		Rehash();
+	}
+	else {
+		Index(Id);
+	}
+	return Id;
+}
+
+/* Checks for dublicates path, the path is
+ * unique when the symbol is unique in the scope */
+int DataPool::CheckDublicate(const char *pPath, int Symbol) {
+
+	/* Variables */
+	size_t Slot = 0;
+
+	if (FindPath(pPath, &Slot) != -1) {
+
+		/* So, it exists */
+		printf("Dublicate objects with name %s\n", m_pSymbols->GetName(Symbol));
+
+		/* Err, bail out */
+		return -1;
 	}
 
 	/* Yay! */
 	return 0;
 }
 
+/* Joins a scope path and a name, the path is 
+ * sized to fit so nothing is cut off */
+static char *JoinPath(const char *Scope, const char *Name) {
+	size_t ScopeLength = strlen(Scope);
+	size_t NameLength = strlen(Name);
+	char *Path = (char*)malloc(ScopeLength + 1 + NameLength + 1);
+
+	if (Path != NULL) {
+		memcpy(Path, Scope, ScopeLength);
+		Path[ScopeLength] = '.';
+		memcpy(Path + ScopeLength + 1, Name, NameLength + 1);
+	}
+	return Path;
+}
+
 /* Calculates and creates a path for the given
  * identifier, so it lets us easily check for dubs */
-char *DataPool::CreatePath(int ScopeId, const char *Identifier) {
-
-	/* Static storage */
-	char Buffer[256];
-
-	/* Iterate our code objects */
-	for (std::map<int, CodeObject*>::iterator Itr = m_sTable.begin();
-		Itr != m_sTable.end(); ++Itr)
-	{
-		/* Get dataobject */
-		CodeObject *Obj = Itr->second;
-		int Id = Itr->first;
-		
-		/* Have we found the mothership? */
-		if (Id == ScopeId) {
-
-			/* Yes, calculate a new path 
-			 * Clear out temp storage */
-			memset(&Buffer[0], 0, sizeof(Buffer));
-
-			/* Now combine efforts here */
-			sprintf(&Buffer[0], "%s.%s", Obj->GetPath(), Identifier);
-
-			/* Done, why thank you very much */
-			return strdup(&Buffer[0]);
-		}
+char *DataPool::CreatePath(int ScopeId, int Symbol) {
+
+	/* Top level? */
+	if (ScopeId < 0 || ScopeId >= (int)m_lObjects.size()) {
+		return strdup(m_pSymbols->GetName(Symbol));
 	}
 
-	/* Uh, in the rare case there is none */
-	return strdup(Identifier);
+	/* Now combine efforts here */
+	return JoinPath(m_lObjects[ScopeId]->GetPath(), m_pSymbols->GetName(Symbol));
 }
 
-/* Create a new object and return
- * the id for the current scope */
-int DataPool::CreateObject(const char *pIdentifier) {
+/* Create a new namespace and return the id
+ * namespaces only exist at the top level */
+int DataPool::CreateNamespace(int Symbol) {
 
-	/* Variables */
-	CodeObject *dObj = NULL;
-	int Id = 0;
-
-	/* Should calculate path here but we don't 
-	 * need to support nested objects for now */
+	/* Calculate path */
+	char *Path = CreatePath(-1, Symbol);
 
 	/* Step 1. Does it exist? */
-	if (CheckDublicate(pIdentifier, pIdentifier))
+	if (CheckDublicate(Path, Symbol)) {
+		free(Path);
 		return -1;
+	}
 
-	/* Allocate id */
-	Id = m_iIdGen++;
+	/* Create a new namespace */
+	return Insert(new CodeObject(CTNamespace, Symbol, Path, -1));
+}
 
-	/* Create a new object */
-	dObj = new CodeObject(CTObject, pIdentifier, pIdentifier, -1);
+/* Create a new object for the given scope
+ * and return the id for the current scope */
+int DataPool::CreateObject(int Symbol, int ScopeId) {
 
-	/* Insert */
-	m_sTable[Id] = dObj;
+	/* Calculate path based on scope */
+	char *Path = CreatePath(ScopeId, Symbol);
 
-	/* Done! */
-	return Id;
+	/* Step 1. Does it exist? */
+	if (CheckDublicate(Path, Symbol)) {
+		free(Path);
+		return -1;
+	}
+
+	/* Create a new object, objects are either 
+	 * at the top level or in a namespace */
+	return Insert(new CodeObject(CTObject, Symbol, Path, ScopeId));
 }
 
 /* Create a new function for the given scope
  * and return the id for the current scope */
-int DataPool::CreateFunction(const char *pIdentifier, int ScopeId) {
+int DataPool::CreateFunction(int Symbol, int ScopeId) {
 
 	/* Variables */
-	CodeObject *OwnerObj = NULL;
 	CodeObject *dObj = NULL;
 	char *Path = NULL;
-	int Id = 0;
 
-	/* Calculate path first based on scope */
-	Path = CreatePath(ScopeId, pIdentifier);
+	/* Calculate path based on scope */
+	Path = CreatePath(ScopeId, Symbol);
 
 	/* Step 1. Does it exist? */
-	if (CheckDublicate(pIdentifier, Path))
+	if (CheckDublicate(Path, Symbol)) {
+		free(Path);
 		return -1;
-
-	/* Lookup Owner */
-	if (ScopeId != -1)
-		OwnerObj = m_sTable[ScopeId];
-
-	/* Allocate id */
-	Id = m_iIdGen++;
+	}
 
 	/* Create a new object */
-	dObj = new CodeObject(CTFunction, pIdentifier, Path, ScopeId);
+	dObj = new CodeObject(CTFunction, Symbol, Path, ScopeId);
 
 	/* Allocate us in the owner of this function
 	 * we must know where to be put */
-	if (OwnerObj != NULL)
-		dObj->SetOffset(OwnerObj->AllocateFunctionOffset());
+	if (ScopeId != -1)
+		dObj->SetOffset(m_lObjects[ScopeId]->AllocateFunctionOffset());
 
 	/* Insert */
-	m_sTable[Id] = dObj;
-
-	/* Done! */
-	return Id;
+	return Insert(dObj);
 }
 
 /* Create a new variable for the given scope
  * and return the id of the variable */
-int DataPool::DefineVariable(const char *pIdentifier, int ScopeId) {
+int DataPool::DefineVariable(int Symbol, int ScopeId) {
 
 	/* Variables */
-	CodeObject *OwnerObj = NULL;
 	CodeObject *dObj = NULL;
 	char *Path = NULL;
-	int Id = 0;
 
-	/* Calculate path first based on scope */
-	Path = CreatePath(ScopeId, pIdentifier);
+	/* Calculate path based on scope */
+	Path = CreatePath(ScopeId, Symbol);
 
 	/* Step 1. Does it exist? */
-	if (CheckDublicate(pIdentifier, Path))
+	if (CheckDublicate(Path, Symbol)) {
+		free(Path);
 		return -1;
-
-	/* Lookup Owner */
-	if (ScopeId != -1)
-		OwnerObj = m_sTable[ScopeId];
-
-	/* Allocate id */
-	Id = m_iIdGen++;
+	}
 
 	/* Create a new object */
-	dObj = new CodeObject(CTVariable, pIdentifier, Path, ScopeId);
+	dObj = new CodeObject(CTVariable, Symbol, Path, ScopeId);
 
 	/* Allocate us in the owner of this variable
 	 * we must know where to be put */
-	if (OwnerObj != NULL)
-		dObj->SetOffset(OwnerObj->AllocateVariableOffset());
+	if (ScopeId != -1)
+		dObj->SetOffset(m_lObjects[ScopeId]->AllocateVariableOffset());
 
 	/* Insert */
-	m_sTable[Id] = dObj;
-
-	/* Done! */
-	return Id;
+	return Insert(dObj);
 }
 
 /* Creates a new string in the string pool
  * and returns the id given to it */
 int DataPool::DefineString(const char *pString) {
 
-	/* Create Path */
-	char Buffer[1024];
-	CodeObject *dObj = NULL;
+	/* Variables */
+	size_t Prefix = sizeof(DATAPOOL_STRING_PREFIX) - 1;
+	size_t Length = strlen(pString);
+	size_t Slot = 0;
+	char *Path = NULL;
 	int Id = 0;
 
-	/* Clear out buffer */
-	memset(&Buffer[0], 0, sizeof(Buffer));
-
-	/* Format the string */
-	sprintf(&Buffer[0], "StringPool.%s", pString);
-
-	/* Check dublicates */
-	for (std::map<int, CodeObject*>::iterator Itr = m_sTable.begin();
-		Itr != m_sTable.end(); ++Itr)
-	{
-		/* Get dataobject */
-		CodeObject *Obj = Itr->second;
-
-		/* Compare path */
-		if (Obj->GetType() == CTString 
-			&& !strcmp(Obj->GetPath(), &Buffer[0])) {
-			/* Yay! String pool optimizations */
-			return Itr->first;
-		}
+	/* Yay! String pool optimizations, the 
+	 * whole literal is compared */
+	Id = FindString(pString, Length, &Slot);
+	if (Id != -1) {
+		return Id;
 	}
 
-	/* Allocate id */
-	Id = m_iIdGen++;
+	/* Create Path */
+	Path = (char*)malloc(Prefix + Length + 1);
+	memcpy(Path, DATAPOOL_STRING_PREFIX, Prefix);
+	memcpy(Path + Prefix, pString, Length + 1);
 
 	/* Create a new object */
-	dObj = new CodeObject(CTString, NULL, strdup(&Buffer[0]), -1);
-
-	/* Insert */
-	m_sTable[Id] = dObj;
-
-	/* Done! */
-	return Id;
+	return Insert(new CodeObject(CTString, -1, Path, -1));
 }
 
 /* Retrieve a variable Id from the given 
- * scope and identifier */
-int DataPool::LookupSymbol(const char *pIdentifier, int ScopeId) {
-
-	/* Iterate our code objects */
-	for (std::map<int, CodeObject*>::iterator Itr = m_sTable.begin();
-		Itr != m_sTable.end(); ++Itr)
-	{
-		/* Get dataobject */
-		CodeObject *Obj = Itr->second;
-
-		/* Compare path */
-		if (Obj->GetIdentifier() != NULL
-			&& !strcasecmp(Obj->GetIdentifier(), pIdentifier)
-			&& Obj->GetScopeId() == ScopeId) {
-			
-			/* Yay! Found! */
-			return Itr->first;
-		}
-	}
-
-	/* Err - Not found - Bail */
-	return -1;
+ * scope and symbol */
+int DataPool::LookupSymbol(int Symbol, int ScopeId) {
+	size_t Slot = 0;
+	return FindSymbol(Symbol, ScopeId, &Slot);
 }
 
-/* Retrieves a code object from the given 
- * identifier path */
-CodeObject *DataPool::LookupObject(const char *pPath) {
-
-	/* Iterate our code objects */
-	for (std::map<int, CodeObject*>::iterator Itr = m_sTable.begin();
-		Itr != m_sTable.end(); ++Itr)
-	{
-		/* Get dataobject */
-		CodeObject *Obj = Itr->second;
-
-		/* Compare path */
-		if (!strcasecmp(Obj->GetPath(), pPath)) {
+/* Retrieve a code object Id from the given symbol, 
+ * the scope and then the scopes around it are searched */
+int DataPool::ResolveSymbol(int Symbol, int ScopeId) {
 
-			/* Yay! Found! */
-			return Obj;
+	/* Walk outwards */
+	while (1) {
+		int Id = LookupSymbol(Symbol, ScopeId);
+		if (Id != -1) {
+			return Id;
 		}
+		if (ScopeId == -1) {
+			return ResolveImport(Symbol);
+		}
+		ScopeId = m_lObjects[ScopeId]->GetScopeId();
 	}
-
-	/* Err - Not found - Bail */
-	return NULL;
 }
 
-/* Appends bytecode to a code-object
- * this redirects the bytecode to the id given */
-int DataPool::AddOpcode(int ScopeId, Opcode_t Opcode) {
-
-	/* Iterate our code objects */
-	for (std::map<int, CodeObject*>::iterator Itr = m_sTable.begin();
-		Itr != m_sTable.end(); ++Itr)
-	{
-		/* Get dataobject */
-		CodeObject *Obj = Itr->second;
-
-		/* Compare path */
-		if (Itr->first == ScopeId) {
+/* Imports a namespace, the path is the module file 
+ * or NULL when the namespace is compiled with us.
+ * Returns 0 on success */
+int DataPool::AddImport(int Symbol, const char *pPath) {
 
-			/* Yay! Found! Add code */
-			Obj->AddCode(Opcode & 0xFF);
-
-			/* Done! */
+	/* Importing twice is harmless */
+	for (size_t i = 0; i < m_lImports.size(); i++) {
+		if (m_lImports[i]->GetSymbol() == Symbol) {
 			return 0;
 		}
 	}
 
-	/* Err - Not found - Bail */
-	return -1;
+	/* Nothing is read untill a symbol is looked up */
+	m_lImports.push_back(new Module(Symbol, (pPath != NULL) ? pPath : ""));
+	return 0;
 }
 
-/* Appends bytecode to a code-object
- * this redirects the bytecode to the id given */
-int DataPool::AddCode8(int ScopeId, char Value) {
+/* Looks up a symbol in the imported namespaces in the order 
+ * they were imported. Modules are loaded on the first lookup
+ * that reaches them, and the exports that are used become 
+ * code objects in the namespace of the module */
+int DataPool::ResolveImport(int Symbol) {
+
+	for (size_t i = 0; i < m_lImports.size(); i++) {
+		Module *Import = m_lImports[i];
+		ModuleExport_t *Export = NULL;
+		CodeObject *dObj = NULL;
+		int SpaceId = LookupSymbol(Import->GetSymbol(), -1);
+		int Id;
+
+		/* Compiled with us, or used before */
+		if (SpaceId != -1) {
+			Id = LookupSymbol(Symbol, SpaceId);
+			if (Id != -1) {
+				return Id;
+			}
+
+			/* Our own namespaces have no module */
+			if (m_lObjects[SpaceId]->GetModule() == -1) {
+				continue;
+			}
+		}
 
-	/* Iterate our code objects */
-	for (std::map<int, CodeObject*>::iterator Itr = m_sTable.begin();
-		Itr != m_sTable.end(); ++Itr)
-	{
-		/* Get dataobject */
-		CodeObject *Obj = Itr->second;
+		/* Search the export table */
+		Export = Import->FindExport(m_pSymbols->GetName(Symbol));
+		if (Export == NULL) {
+			continue;
+		}
 
-		/* Compare path */
-		if (Itr->first == ScopeId) {
+		/* The namespace of the module is created 
+		 * with the first symbol we use from it */
+		if (SpaceId == -1) {
+			SpaceId = CreateNamespace(Import->GetSymbol());
+			if (SpaceId == -1) {
+				return -1;
+			}
+			m_lObjects[SpaceId]->SetModule((int)i);
+		}
 
-			/* Yay! Found! Add code */
-			Obj->AddCode(Value);
+		/* Create the imported object, its path is spelled 
+		 * like the export so the module can be linked by it */
+		dObj = new CodeObject(Export->Type, Symbol, JoinPath(m_lObjects[SpaceId]->GetPath(), Export->Name), SpaceId);
+		dObj->SetArgumentCount(Export->ArgumentCount);
+		dObj->SetModule((int)i);
 
-			/* Done! */
-			return 0;
-		}
+		/* Insert */
+		return Insert(dObj);
 	}
 
 	/* Err - Not found - Bail */
 	return -1;
 }
 
-/* Appends bytecode to a code-object
- * this redirects the bytecode to the id given */
-int DataPool::AddCode16(int ScopeId, short Value) {
-
-	/* Iterate our code objects */
-	for (std::map<int, CodeObject*>::iterator Itr = m_sTable.begin();
-		Itr != m_sTable.end(); ++Itr)
-	{
-		/* Get dataobject */
-		CodeObject *Obj = Itr->second;
-
-		/* Compare path */
-		if (Itr->first == ScopeId) {
+/* Retrieves a code object from the given 
+ * identifier path, every component is resolved
+ * by symbol in the scope of the previous one, 
+ * so the spelling of the path doesn't matter */
+CodeObject *DataPool::LookupObject(const char *pPath) {
 
-			/* Yay! Found! Add code */
-			Obj->AddCode(Value & 0xFF);
-			Obj->AddCode((Value >> 8) & 0xFF);
+	/* Variables */
+	const char *Component = pPath;
+	size_t Slot = 0;
+	int ScopeId = FindPath(pPath, &Slot);
 
-			/* Done! */
-			return 0;
-		}
+	/* Spelled like the declaration? */
+	if (ScopeId != -1) {
+		return m_lObjects[ScopeId];
 	}
 
-	/* Err - Not found - Bail */
-	return -1;
-}
+	while (1) {
+		const char *End = strchr(Component, '.');
+		size_t Length = (End != NULL) ? (size_t)(End - Component) : strlen(Component);
+		int Symbol = m_pSymbols->Lookup(Component, Length);
 
-/* Appends bytecode to a code-object
- * this redirects the bytecode to the id given */
-int DataPool::AddCode32(int ScopeId, int Value) {
-	
-	/* Iterate our code objects */
-	for (std::map<int, CodeObject*>::iterator Itr = m_sTable.begin();
-		Itr != m_sTable.end(); ++Itr)
-	{
-		/* Get dataobject */
-		CodeObject *Obj = Itr->second;
-
-		/* Compare path */
-		if (Itr->first == ScopeId) {
-
-			/* Yay! Found! Add code */
-			Obj->AddCode(Value & 0xFF);
-			Obj->AddCode((Value >> 8) & 0xFF);
-			Obj->AddCode((Value >> 16) & 0xFF);
-			Obj->AddCode((Value >> 24) & 0xFF);
-
-			/* Done! */
-			return 0;
+		/* Unknown names can't be in the table */
+		if (Symbol == -1) {
+			return NULL;
 		}
-	}
 
-	/* Err - Not found - Bail */
-	return -1;
-}
+		ScopeId = LookupSymbol(Symbol, ScopeId);
+		if (ScopeId == -1) {
+			return NULL;
+		}
 
-/* Appends bytecode to a code-object
- * this redirects the bytecode to the id given */
-int DataPool::AddCode64(int ScopeId, long long Value) {
-
-	/* Iterate our code objects */
-	for (std::map<int, CodeObject*>::iterator Itr = m_sTable.begin();
-		Itr != m_sTable.end(); ++Itr)
-	{
-		/* Get dataobject */
-		CodeObject *Obj = Itr->second;
-
-		/* Compare path */
-		if (Itr->first == ScopeId) {
-
-			/* Yay! Found! Add code */
-			Obj->AddCode(Value & 0xFF);
-			Obj->AddCode((Value >> 8) & 0xFF);
-			Obj->AddCode((Value >> 16) & 0xFF);
-			Obj->AddCode((Value >> 24) & 0xFF);
-			Obj->AddCode((Value >> 32) & 0xFF);
-			Obj->AddCode((Value >> 40) & 0xFF);
-			Obj->AddCode((Value >> 48) & 0xFF);
-
-			/* Done! */
-			return 0;
+		/* Last component? */
+		if (End == NULL) {
+			return m_lObjects[ScopeId];
 		}
+		Component = End + 1;
 	}
-
-	/* Err - Not found - Bail */
-	return -1;
-}
\ No newline at end of file
+}
@@ -25,40 +25,58 @@
 /* Includes */
 #include <cstring>
 #include <cstdlib>
-#include <map>
+#include <vector>
 
 /* System Includes */
 #include "../generator/opcodes.h"
 #include "../parser/parser.h"
+#include "symboltable.h"
 #include "codeobject.h"
+#include "module.h"
 
 /* The data pool 
- * Contains all the static data for a program */
+ * Contains all the static data for a program. The code
+ * objects are stored by id, and found by scope and symbol
+ * or by their path through two hash indices */
 class DataPool
 {
 public:
-	DataPool();
+	DataPool(SymbolTable *Symbols);
 	~DataPool();
 
-	/* Create a new object and return
-	 * the id for the current scope */
-	int CreateObject(const char *pIdentifier);
+	/* Create a new namespace and return the id
+	 * namespaces only exist at the top level */
+	int CreateNamespace(int Symbol);
+
+	/* Create a new object for the given scope
+	 * and return the id for the current scope */
+	int CreateObject(int Symbol, int ScopeId);
 
 	/* Create a new function for the given scope 
 	 * and return the id for the current scope */
-	int CreateFunction(const char *pIdentifier, int ScopeId);
+	int CreateFunction(int Symbol, int ScopeId);
 
 	/* Create a new variable for the given scope
 	 * and return the id of the variable */
-	int DefineVariable(const char *pIdentifier, int ScopeId);
+	int DefineVariable(int Symbol, int ScopeId);
 
 	/* Creates a new string in the string pool
 	 * and returns the id given to it */
 	int DefineString(const char *pString);
 
 	/* Retrieve a code object Id from the given 
-	 * identifier and scope */
-	int LookupSymbol(const char *pIdentifier, int ScopeId);
+	 * symbol and scope */
+	int LookupSymbol(int Symbol, int ScopeId);
+
+	/* Retrieve a code object Id from the given symbol, 
+	 * the scope and then the scopes around it are searched,
+	 * and last the imported namespaces */
+	int ResolveSymbol(int Symbol, int ScopeId);
+
+	/* Imports a namespace, the path is the module file 
+	 * or NULL when the namespace is compiled with us.
+	 * Returns 0 on success */
+	int AddImport(int Symbol, const char *pPath);
 
 	/* Retrieves a code object from the given 
 	 * identifier path */
@@ -68,23 +86,35 @@ public:
 	 * an object, returned as bytes */
 	int CalculateObjectSize(int ObjectId);
 
-	/* Appends bytecode to a code-object 
-	 * this redirects the bytecode to the id given */
-	int AddOpcode(int ScopeId, Opcode_t Opcode);
-	int AddCode8(int ScopeId, char Value);
-	int AddCode16(int ScopeId, short Value);
-	int AddCode32(int ScopeId, int Value);
-	int AddCode64(int ScopeId, long long Value);
+	/* Gets the code of a code-object, instructions
+	 * are appended to it through the writer */
+	BytecodeWriter &GetCode(int ScopeId) { return m_lObjects[ScopeId]->GetCode(); }
 
-	/* Gets */
-	std::map<int, CodeObject*> &GetTable() { return m_sTable; }
+	/* Gets, ids run from 0 to the count */
+	int GetCount() { return (int)m_lObjects.size(); }
+	CodeObject *GetObject(int Id) { return m_lObjects[Id]; }
+	SymbolTable *GetSymbols() { return m_pSymbols; }
 
 private:
 	/* Private - Functions */
-	int CheckDublicate(const char *pIdentifier, const char *pPath);
-	char *CreatePath(int ScopeId, const char *Identifier);
+	int FindSymbol(int Symbol, int ScopeId, size_t *Slot);
+	int FindPath(const char *pPath, size_t *Slot);
+	int FindString(const char *pString, size_t Length, size_t *Slot);
+	void Rehash();
+	void Index(int Id);
+	int Insert(CodeObject *Obj);
+	int CheckDublicate(const char *pPath, int Symbol);
+	char *CreatePath(int ScopeId, int Symbol);
+	int ResolveImport(int Symbol);
 
 	/* Private - Data */
-	std::map<int, CodeObject*> m_sTable;
-	int m_iIdGen;
+	std::vector<CodeObject*> m_lObjects;
+	std::vector<Module*> m_lImports;
+	SymbolTable *m_pSymbols;
+
+	/* The indices, open addressed slots 
+	 * holding ids or -1 when empty */
+	int *m_pSymbolSlots;
+	int *m_pPathSlots;
+	size_t m_iSlotCount;
 };
\ No newline at end of file
@@ -0,0 +1,76 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Diagnostics (Shared)
+* - Routes error messages to the console or to a collector
+*/
+
+/* Includes */
+#include "diagnostics.h"
+#include <cstdio>
+
+/* Longest message a handler receives, 
+ * longer messages are cut */
+#define DIAGNOSTICS_MESSAGE_SIZE	512
+
+/* The handler is per thread, so front-ends 
+ * running in parallel collect their own messages */
+static thread_local DiagnosticHandler_t __Handler = NULL;
+static thread_local void *__HandlerContext = NULL;
+
+/* Installs a handler for the messages reported by the
+ * calling thread, NULL restores printing to the console */
+void SetDiagnosticHandler(DiagnosticHandler_t Handler, void *Context)
+{
+	__Handler = Handler;
+	__HandlerContext = Context;
+}
+
+/* Reports an error message at a position of the source,
+ * without a handler it goes straight to the console */
+void ReportErrorList(int Line, int Column, const char *Format, va_list Arguments)
+{
+	char Message[DIAGNOSTICS_MESSAGE_SIZE];
+
+	if (__Handler == NULL) {
+		vprintf(Format, Arguments);
+	}
+	else {
+		vsnprintf(&Message[0], sizeof(Message), Format, Arguments);
+		__Handler(__HandlerContext, Line, Column, &Message[0]);
+	}
+}
+
+void ReportErrorAt(int Line, int Column, const char *Format, ...)
+{
+	va_list Arguments;
+
+	va_start(Arguments, Format);
+	ReportErrorList(Line, Column, Format, Arguments);
+	va_end(Arguments);
+}
+
+/* Reports an error message, printf style */
+void ReportError(const char *Format, ...)
+{
+	va_list Arguments;
+
+	va_start(Arguments, Format);
+	ReportErrorList(0, 0, Format, Arguments);
+	va_end(Arguments);
+}
@@ -0,0 +1,41 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Diagnostics (Shared)
+* - Routes error messages to the console or to a collector
+*/
+#pragma once
+
+/* Includes */
+#include <cstdarg>
+
+/* Receives every formatted error message, the message 
+ * ends with a newline. Line and Column are where in the 
+ * source it happened, both are 0 when it is not known */
+typedef void (*DiagnosticHandler_t)(void *Context, int Line, int Column, const char *Message);
+
+/* Installs a handler for the messages reported by the
+ * calling thread, NULL restores printing to the console */
+void SetDiagnosticHandler(DiagnosticHandler_t Handler, void *Context);
+
+/* Reports an error message, printf style */
+void ReportError(const char *Format, ...);
+
+/* Reports an error message at a position of the source */
+void ReportErrorAt(int Line, int Column, const char *Format, ...);
+void ReportErrorList(int Line, int Column, const char *Format, va_list Arguments);
@@ -30,6 +30,7 @@ const char *__ElementTypeNames[] = {
 	"Operator - SUB",
 	"Operator - MUL",
 	"Operator - DIV",
+	"Operator - REM",
 
 	"Left Parenthesis",
 	"Right Parenthesis",
@@ -41,31 +42,28 @@ const char *__ElementTypeNames[] = {
 	"Operator - ASSIGN",
 
 	"Operator - SEMICOLON",
+	"Operator - COMMA",
 	"Identifier",
 	"StringLiteral",
 	"DigitLiteral",
+	"FloatLiteral",
 
 	"Comment Line",
-	"Comment Block"
-};
-
-/* Constructor */
-Element::Element(ElementType_t Type, int Line, long Character) {
-	m_eType = Type;
-	m_iLinePosition = Line;
-	m_iCharPosition = Character;
-}
+	"Comment Block",
 
-/* Destructor
- * Cleanup data as well */
-Element::~Element() {
-	if (m_pData != NULL) {
-		free((void*)m_pData);
-	}
-}
+	"Keyword - OBJECT",
+	"Keyword - FUNC",
+	"Keyword - CONST",
+	"Keyword - LOCKED",
+	"Keyword - NAMESPACE",
+	"Keyword - IMPORT",
+	"Keyword - READONLY",
+	"Keyword - GET",
+	"Keyword - SET"
+};
 
 /* Converts the type into
  * a printable name */
-const char *Element::GetName() {
-	return __ElementTypeNames[(int)m_eType];
-}
\ No newline at end of file
+const char *GetElementName(ElementType_t Type) {
+	return __ElementTypeNames[(int)Type];
+}
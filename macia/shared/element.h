@@ -20,9 +20,6 @@
 */
 #pragma once
 
-/* Includes */
-#include <cstdlib>
-
 typedef enum
 {
 	/* Wtf? */
@@ -33,6 +30,7 @@ typedef enum
 	OperatorSubtract,
 	OperatorMultiply,
 	OperatorDivide,
+	OperatorRemainder,
 
 	/* Brackets */
 	LeftParenthesis,
@@ -47,44 +45,29 @@ typedef enum
 
 	/* Special */
 	OperatorSemiColon,
+	OperatorComma,
 	Identifier,
 	StringLiteral,
 	DigitLiteral,
+	FloatLiteral,
 
 	/* Comments */
 	CommentLine,
-	CommentBlock
-
-} ElementType_t;
-
-/* This class represents an element 
- * in a file, this could be string, 
- * digit, operator etc any of the above */
-class Element
-{
-public:
-	/* Store information */
-	Element(ElementType_t Type, int Line, long Character);
-
-	/* Destructor 
-	 * Cleanup data as well */
-	~Element();
+	CommentBlock,
 
-	/* Modify data for element */
-	void SetData(const char *Data) { m_pData = Data; }
+	/* Keywords */
+	KeywordObject,
+	KeywordFunc,
+	KeywordConst,
+	KeywordLocked,
+	KeywordNamespace,
+	KeywordImport,
+	KeywordReadonly,
+	KeywordGet,
+	KeywordSet
 
-	/* Get(s) */
-	ElementType_t GetType() { return m_eType; }
-	const char *GetData() { return m_pData; }
-	int GetLineNumber() { return m_iLinePosition; }
-	long GetCharacterPosition() { return m_iCharPosition; }
-	const char *GetName();
-
-private:
-	/* Private - Information */
-	ElementType_t m_eType;
-	const char *m_pData;
+} ElementType_t;
 
-	long m_iCharPosition;
-	int m_iLinePosition;
-};
\ No newline at end of file
+/* Converts the type into
+ * a printable name */
+const char *GetElementName(ElementType_t Type);
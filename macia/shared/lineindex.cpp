@@ -0,0 +1,108 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+* Macia - Line Index (Shared)
+* - Maps byte offsets to line and column numbers
+*/
+
+/* Includes */
+#include "lineindex.h"
+#include <cstdlib>
+
+/* Initial number of lines */
+#define LINEINDEX_INIT_SIZE 256
+
+/* Constructor
+ * Nothing is allocated before the second line */
+LineIndex::LineIndex() {
+	m_pStarts = NULL;
+	m_iCount = 1;
+	m_iCapacity = 0;
+	m_iFirstLine = 1;
+	m_iFirstColumn = 1;
+}
+
+/* Destructor
+ * Cleans up the offsets */
+LineIndex::~LineIndex() {
+	free(m_pStarts);
+}
+
+/* Forgets all lines but the first, the 
+ * allocation is kept for reuse */
+void LineIndex::Clear(int FirstLine, int FirstColumn) {
+	m_iCount = 1;
+	m_iFirstLine = FirstLine;
+	m_iFirstColumn = FirstColumn;
+}
+
+/* Records the start of the next line, offsets
+ * must be added in increasing order. Returns 0 on success */
+int LineIndex::Add(size_t Offset) {
+
+	/* Size-check! The first line is implicit */
+	if (m_iCount == m_iCapacity || m_pStarts == NULL) {
+		size_t Capacity = (m_pStarts == NULL) ? LINEINDEX_INIT_SIZE : (m_iCapacity * 2);
+		unsigned int *Starts = (unsigned int*)realloc(m_pStarts, Capacity * sizeof(unsigned int));
+		if (Starts == NULL) {
+			return -1;
+		}
+		Starts[0] = 0;
+		m_pStarts = Starts;
+		m_iCapacity = Capacity;
+	}
+
+	m_pStarts[m_iCount++] = (unsigned int)Offset;
+	return 0;
+}
+
+/* Finds the index of the line containing the 
+ * offset, the last line whose start is not past it */
+size_t LineIndex::FindLine(size_t Offset) {
+	size_t Low = 0;
+	size_t High = m_iCount;
+
+	/* Only the implicit line */
+	if (m_pStarts == NULL) {
+		return 0;
+	}
+
+	while (High - Low > 1) {
+		size_t Middle = Low + ((High - Low) / 2);
+		if (m_pStarts[Middle] <= Offset) {
+			Low = Middle;
+		}
+		else {
+			High = Middle;
+		}
+	}
+	return Low;
+}
+
+/* Numbers the line containing the offset */
+int LineIndex::GetLine(size_t Offset) {
+	return (int)FindLine(Offset) + m_iFirstLine;
+}
+
+/* Calculates the column from the start of the line */
+int LineIndex::GetColumn(size_t Offset) {
+	size_t Line = FindLine(Offset);
+	if (Line == 0) {
+		return (int)Offset + m_iFirstColumn;
+	}
+	return (int)(Offset - m_pStarts[Line]) + 1;
+}
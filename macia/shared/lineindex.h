@@ -0,0 +1,60 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+* Macia - Line Index (Shared)
+* - Maps byte offsets to line and column numbers
+*/
+#pragma once
+
+/* Includes */
+#include <cstddef>
+
+/* The line index
+ * Holds the offset every line starts at, in order. The 
+ * scanner records them as it passes newlines, and positions
+ * are only looked up (by binary search) when reporting */
+class LineIndex
+{
+public:
+	LineIndex();
+	~LineIndex();
+
+	/* Forgets all lines but the first, which starts at 0. 
+	 * To index a part of a text, the first line can be numbered
+	 * FirstLine and start at column FirstColumn */
+	void Clear(int FirstLine = 1, int FirstColumn = 1);
+
+	/* Records the start of the next line, offsets
+	 * must be added in increasing order. Returns 0 on success */
+	int Add(size_t Offset);
+
+	/* Gets, lines and columns start at 1 */
+	int GetLine(size_t Offset);
+	int GetColumn(size_t Offset);
+	size_t GetCount() { return m_iCount; }
+
+private:
+	/* Private - Functions */
+	size_t FindLine(size_t Offset);
+
+	/* Private - Data */
+	unsigned int *m_pStarts;
+	int m_iFirstLine;
+	int m_iFirstColumn;
+	size_t m_iCount;
+	size_t m_iCapacity;
+};
@@ -0,0 +1,216 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Module (Shared)
+* - A precompiled namespace on disk with its export table
+*/
+
+/* Includes */
+#include "module.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/* Reads a little-endian value */
+static unsigned int ReadValue(const unsigned char *pData, int Bytes) {
+	unsigned int Value = 0;
+	for (int i = Bytes - 1; i >= 0; i--) {
+		Value = (Value << 8) | pData[i];
+	}
+	return Value;
+}
+
+/* Folds a name to lower-case, the key of the exports */
+static std::string FoldName(const char *pName) {
+	std::string Folded(pName);
+	for (size_t i = 0; i < Folded.length(); i++) {
+		if (Folded[i] >= 'A' && Folded[i] <= 'Z') {
+			Folded[i] = (char)(Folded[i] + ('a' - 'A'));
+		}
+	}
+	return Folded;
+}
+
+/* Appends a little-endian value */
+static void WriteValue(std::vector<unsigned char> &Buffer, unsigned int Value, int Bytes) {
+	for (int i = 0; i < Bytes; i++) {
+		Buffer.push_back((Value >> (i * 8)) & 0xFF);
+	}
+}
+
+/* Constructor
+ * Stores the path, nothing is read before the first lookup */
+Module::Module(int Symbol, const char *pPath) {
+	m_iSymbol = Symbol;
+	m_pPath = strdup(pPath);
+	m_iLoaded = 0;
+	m_iFailed = 0;
+}
+
+/* Destructor
+ * Cleans up the export table */
+Module::~Module() {
+	for (size_t i = 0; i < m_lExports.size(); i++) {
+		free(m_lExports[i].Name);
+	}
+	free(m_pPath);
+}
+
+/* Reads the export table on first use, a failed 
+ * load is not retried. Returns 0 on success */
+int Module::Load() {
+
+	/* Variables */
+	unsigned char Header[MODULE_HEADER_SIZE];
+	unsigned char *Table = NULL;
+	unsigned int Count, Size, Offset = 0;
+	FILE *Source = NULL;
+
+	/* Sanity */
+	if (m_iLoaded || m_iFailed) {
+		return m_iLoaded ? 0 : -1;
+	}
+	m_iFailed = 1;
+
+	/* Read the header and the export table, the 
+	 * code and the data are left on disk */
+	Source = fopen(m_pPath, "rb");
+	if (Source == NULL) {
+		printf("Unable to open module %s\n", m_pPath);
+		return -1;
+	}
+
+	if (fread(&Header[0], 1, sizeof(Header), Source) != sizeof(Header)
+		|| Header[0] != MODULE_VERSION || memcmp(&Header[1], "MOD", 3)) {
+		printf("Invalid module %s\n", m_pPath);
+		fclose(Source);
+		return -1;
+	}
+
+	Count = ReadValue(&Header[4], 4);
+	Size = ReadValue(&Header[8], 4);
+	Table = (unsigned char*)malloc(Size + 1);
+	if (Table == NULL || fread(Table, 1, Size, Source) != Size) {
+		printf("Invalid module %s\n", m_pPath);
+		free(Table);
+		fclose(Source);
+		return -1;
+	}
+	fclose(Source);
+
+	/* Unpack the entries */
+	for (unsigned int i = 0; i < Count; i++) {
+		ModuleExport_t Export;
+		unsigned int Length;
+
+		if (Offset + 8 > Size) {
+			break;
+		}
+		Export.Id = (int)ReadValue(&Table[Offset], 4);
+		Export.Type = (CodeType_t)Table[Offset + 4];
+		Export.ArgumentCount = Table[Offset + 5];
+		Length = ReadValue(&Table[Offset + 6], 2);
+		Offset += 8;
+
+		if (Offset + Length > Size) {
+			break;
+		}
+		Export.Name = (char*)malloc(Length + 1);
+		if (Export.Name == NULL) {
+			break;
+		}
+		memcpy(Export.Name, &Table[Offset], Length);
+		Export.Name[Length] = '\0';
+		Offset += Length;
+		m_sExports.insert(std::make_pair(FoldName(Export.Name), m_lExports.size()));
+		m_lExports.push_back(Export);
+	}
+	free(Table);
+
+	/* Truncated tables are rejected */
+	if (m_lExports.size() != Count) {
+		printf("Invalid export table in module %s\n", m_pPath);
+		return -1;
+	}
+
+	m_iFailed = 0;
+	m_iLoaded = 1;
+	return 0;
+}
+
+/* Finds an export by its name, case-insensitive
+ * like every identifier. Loads the module if needed */
+ModuleExport_t *Module::FindExport(const char *pName) {
+
+	/* Make sure we have the table */
+	if (Load()) {
+		return NULL;
+	}
+
+	std::unordered_map<std::string, size_t>::iterator Export = m_sExports.find(FoldName(pName));
+	return (Export == m_sExports.end()) ? NULL : &m_lExports[Export->second];
+}
+
+/* Writes a module file from the exports and the
+ * serialized code and data. Returns 0 on success */
+int SaveModule(const char *pPath, std::vector<ModuleExport_t> &Exports,
+	std::vector<unsigned char> &Code, std::vector<unsigned char> &Data) {
+
+	/* Variables */
+	std::vector<unsigned char> Header;
+	std::vector<unsigned char> Table;
+	FILE *Destination = NULL;
+	int Result = 0;
+
+	/* Build the export table */
+	for (size_t i = 0; i < Exports.size(); i++) {
+		size_t Length = strlen(Exports[i].Name);
+
+		WriteValue(Table, (unsigned int)Exports[i].Id, 4);
+		WriteValue(Table, (unsigned int)Exports[i].Type, 1);
+		WriteValue(Table, (unsigned int)Exports[i].ArgumentCount, 1);
+		WriteValue(Table, (unsigned int)Length, 2);
+		Table.insert(Table.end(), Exports[i].Name, Exports[i].Name + Length);
+	}
+
+	/* Setup header */
+	Header.push_back(MODULE_VERSION);
+	Header.push_back('M');
+	Header.push_back('O');
+	Header.push_back('D');
+	WriteValue(Header, (unsigned int)Exports.size(), 4);
+	WriteValue(Header, (unsigned int)Table.size(), 4);
+	WriteValue(Header, (unsigned int)Code.size(), 4);
+	WriteValue(Header, (unsigned int)Data.size(), 4);
+
+	/* Write it all */
+	Destination = fopen(pPath, "wb");
+	if (Destination == NULL) {
+		return -1;
+	}
+
+	if (fwrite(&Header[0], 1, Header.size(), Destination) != Header.size()
+		|| (Table.size() != 0 && fwrite(&Table[0], 1, Table.size(), Destination) != Table.size())
+		|| (Code.size() != 0 && fwrite(&Code[0], 1, Code.size(), Destination) != Code.size())
+		|| (Data.size() != 0 && fwrite(&Data[0], 1, Data.size(), Destination) != Data.size())) {
+		Result = -1;
+	}
+
+	fclose(Destination);
+	return Result;
+}
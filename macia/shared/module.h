@@ -0,0 +1,90 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Module (Shared)
+* - A precompiled namespace on disk with its export table
+*/
+#pragma once
+
+/* Includes */
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "codeobject.h"
+
+/* The module file layout, all values are little-endian
+ * [0]  version, [1..3] 'M' 'O' 'D'
+ * [4]  number of exports
+ * [8]  size of the export table
+ * [12] size of the code
+ * [16] size of the data
+ * The export table follows, then the code and the data in
+ * the same format as a program. Every export is its id in
+ * the module, the type, the number of arguments and the 
+ * length of the name (16 bits) followed by the name */
+#define MODULE_VERSION			0x01
+#define MODULE_HEADER_SIZE		20
+#define MODULE_EXTENSION		".mm"
+
+/* An entry in the export table, the name
+ * is the path relative to the namespace */
+typedef struct {
+	char *Name;
+	int Id;
+	CodeType_t Type;
+	int ArgumentCount;
+} ModuleExport_t;
+
+/* The module class
+ * Represents an imported module, nothing but the
+ * header and the export table is ever read, and only
+ * when a symbol is first looked up in it */
+class Module
+{
+public:
+	Module(int Symbol, const char *pPath);
+	~Module();
+
+	/* Reads the export table on first use, a failed 
+	 * load is not retried. Returns 0 on success */
+	int Load();
+
+	/* Finds an export by its name, case-insensitive
+	 * like every identifier. Loads the module if needed */
+	ModuleExport_t *FindExport(const char *pName);
+
+	/* Gets */
+	int GetSymbol() { return m_iSymbol; }
+	const char *GetPath() { return m_pPath; }
+	int IsLoaded() { return m_iLoaded; }
+
+private:
+	/* Private - Data */
+	std::vector<ModuleExport_t> m_lExports;
+	std::unordered_map<std::string, size_t> m_sExports;
+	int m_iSymbol;
+	char *m_pPath;
+	int m_iLoaded;
+	int m_iFailed;
+};
+
+/* Writes a module file from the exports and the
+ * serialized code and data. Returns 0 on success */
+int SaveModule(const char *pPath, std::vector<ModuleExport_t> &Exports,
+	std::vector<unsigned char> &Code, std::vector<unsigned char> &Data);
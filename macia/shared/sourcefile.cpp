@@ -0,0 +1,139 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Source File (Shared)
+* - Maps a source file read-only into memory
+*/
+
+/* Includes */
+#include "sourcefile.h"
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOURCEFILE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* Constructor
+ * Stores the path, nothing is mapped before Open */
+SourceFile::SourceFile(const char *pPath) {
+	m_pPath = pPath;
+	m_pData = NULL;
+	m_iLength = 0;
+	m_iMapped = 0;
+}
+
+/* Destructor
+ * Releases the mapping or the buffer */
+SourceFile::~SourceFile() {
+	if (m_pData == NULL) {
+		return;
+	}
+
+#ifdef SOURCEFILE_MMAP
+	if (m_iMapped) {
+		munmap((void*)m_pData, m_iLength);
+		return;
+	}
+#endif
+	free((void*)m_pData);
+}
+
+/* Maps the file into memory,
+ * returns 0 on success */
+int SourceFile::Open() {
+
+#ifdef SOURCEFILE_MMAP
+	/* Variables */
+	struct stat Stats;
+	void *Mapping;
+	int Fd;
+
+	/* Open the file and get the size */
+	Fd = open(m_pPath, O_RDONLY);
+	if (Fd < 0) {
+		return -1;
+	}
+
+	if (fstat(Fd, &Stats) < 0) {
+		close(Fd);
+		return -1;
+	}
+
+	/* Empty files can't be mapped, but are valid */
+	m_iLength = (size_t)Stats.st_size;
+	if (m_iLength == 0) {
+		close(Fd);
+		return 0;
+	}
+
+	/* Map it read-only, the mapping outlives the descriptor */
+	Mapping = mmap(NULL, m_iLength, PROT_READ, MAP_PRIVATE, Fd, 0);
+	close(Fd);
+	if (Mapping == MAP_FAILED) {
+		m_iLength = 0;
+		return -1;
+	}
+
+	m_pData = (const char*)Mapping;
+	m_iMapped = 1;
+	return 0;
+#else
+	/* Variables */
+	FILE *Source = NULL;
+	char *Buffer = NULL;
+	long Size = 0;
+
+	/* No mapping support, read it in one go */
+	Source = fopen(m_pPath, "rb");
+	if (Source == NULL) {
+		return -1;
+	}
+
+	fseek(Source, 0, SEEK_END);
+	Size = ftell(Source);
+	fseek(Source, 0, SEEK_SET);
+	if (Size < 0) {
+		fclose(Source);
+		return -1;
+	}
+
+	/* Empty files are valid */
+	if (Size == 0) {
+		fclose(Source);
+		return 0;
+	}
+
+	Buffer = (char*)malloc((size_t)Size);
+	if (Buffer == NULL
+		|| fread(Buffer, 1, (size_t)Size, Source) != (size_t)Size) {
+		free(Buffer);
+		fclose(Source);
+		return -1;
+	}
+
+	fclose(Source);
+	m_pData = Buffer;
+	m_iLength = (size_t)Size;
+	return 0;
+#endif
+}
@@ -16,38 +16,37 @@
 * along with this program.If not, see <http://www.gnu.org/licenses/>.
 *
 *
-* Macia - Stringbuffer (Shared)
+* Macia - Source File (Shared)
+* - Maps a source file read-only into memory
 */
+#pragma once
 
-#ifndef _STRINGBUFFER_H_
-#define _STRINGBUFFER_H_
-
-/* Includes
- * - Library */
+/* Includes */
 #include <cstddef>
 
-/* The structure for the
- * stringbuffer, includes functions */
-typedef struct _StringBuffer {
-
-	/* Number of characters appended */
-	size_t Count;
-
-	/* Length of Characters */
-	size_t Capacity;
-
-	/* Array of char * pointers added w/ append() */
-	char *Characters;
-
-	/* Functions */
-	void(*Append) (struct _StringBuffer *Sb, char c);
-	const char * (*ToString) (struct _StringBuffer *Sb);
-	void(*Dispose) (struct _StringBuffer **Sb);
-
-} StringBuffer_t;
-
-/* Only quasi-public function 
- * remainder wrapped in StringBuffer struct members */
-StringBuffer_t *GetStringBuffer();
-
-#endif
\ No newline at end of file
+/* The source file class
+ * Keeps a source file resident in memory for as
+ * long as the instance lives, so the scanner can
+ * reference the text without copying it */
+class SourceFile
+{
+public:
+	SourceFile(const char *pPath);
+	~SourceFile();
+
+	/* Maps the file into memory,
+	 * returns 0 on success */
+	int Open();
+
+	/* Gets */
+	const char *GetPath() { return m_pPath; }
+	const char *GetData() { return m_pData; }
+	size_t GetLength() { return m_iLength; }
+
+private:
+	/* Private - Data */
+	const char *m_pPath;
+	const char *m_pData;
+	size_t m_iLength;
+	int m_iMapped;
+};
@@ -0,0 +1,122 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+* Macia - String Builder (Shared)
+* - Scratch buffer for building text with inline storage
+*/
+
+/* Includes */
+#include "stringbuilder.h"
+#include <cstdlib>
+#include <cstring>
+
+/* Constructor
+ * Starts out in the inline storage */
+StringBuilder::StringBuilder() {
+	m_pData = &m_aInline[0];
+	m_iLength = 0;
+	m_iCapacity = STRINGBUILDER_INLINE_SIZE;
+	m_pData[0] = '\0';
+}
+
+/* Destructor
+ * Cleans up the heap storage if any */
+StringBuilder::~StringBuilder() {
+	if (!IsInline()) {
+		free(m_pData);
+	}
+}
+
+/* Makes room for the given number of characters plus the
+ * terminator, at least doubling. Nothing is zero-filled, 
+ * only the used part is moved */
+int StringBuilder::Grow(size_t Required) {
+	size_t Capacity = m_iCapacity * 2;
+	char *Data;
+
+	while (Capacity < Required + 1) {
+		Capacity *= 2;
+	}
+
+	if (IsInline()) {
+		Data = (char*)malloc(Capacity);
+		if (Data != NULL) {
+			memcpy(Data, m_pData, m_iLength + 1);
+		}
+	}
+	else {
+		Data = (char*)realloc(m_pData, Capacity);
+	}
+
+	if (Data == NULL) {
+		return -1;
+	}
+	m_pData = Data;
+	m_iCapacity = Capacity;
+	return 0;
+}
+
+/* Appends a single character */
+int StringBuilder::Append(char Character) {
+	
+	/* Size-check! */
+	if (m_iLength + 1 >= m_iCapacity && Grow(m_iLength + 1)) {
+		return -1;
+	}
+
+	m_pData[m_iLength++] = Character;
+	m_pData[m_iLength] = '\0';
+	return 0;
+}
+
+/* Appends a range of characters */
+int StringBuilder::Append(const char *pText, size_t Length) {
+
+	/* Size-check! */
+	if (m_iLength + Length >= m_iCapacity && Grow(m_iLength + Length)) {
+		return -1;
+	}
+
+	memcpy(&m_pData[m_iLength], pText, Length);
+	m_iLength += Length;
+	m_pData[m_iLength] = '\0';
+	return 0;
+}
+
+/* Hands over the text, heap storage is given away without 
+ * copying while inline text is copied into an allocation 
+ * of its own size. The caller frees it, and the builder is reset */
+char *StringBuilder::Take() {
+	char *Text;
+
+	if (IsInline()) {
+		Text = (char*)malloc(m_iLength + 1);
+		if (Text != NULL) {
+			memcpy(Text, m_pData, m_iLength + 1);
+		}
+	}
+	else {
+		/* The builder goes back to the inline storage */
+		Text = m_pData;
+		m_pData = &m_aInline[0];
+		m_iCapacity = STRINGBUILDER_INLINE_SIZE;
+	}
+
+	m_iLength = 0;
+	m_pData[0] = '\0';
+	return Text;
+}
@@ -0,0 +1,66 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+* Macia - String Builder (Shared)
+* - Scratch buffer for building text with inline storage
+*/
+#pragma once
+
+/* Includes */
+#include <cstddef>
+
+/* Number of characters that fit without allocating */
+#define STRINGBUILDER_INLINE_SIZE	32
+
+/* The string builder
+ * Meant to be kept around and reset between uses. Short text 
+ * lives in the inline storage, longer text moves to a heap 
+ * buffer that grows geometrically and is kept across resets. 
+ * The text is always null-terminated */
+class StringBuilder
+{
+public:
+	StringBuilder();
+	~StringBuilder();
+
+	/* Empties the builder, storage is kept */
+	void Reset() { m_iLength = 0; m_pData[0] = '\0'; }
+
+	/* Appends characters, returns 0 on success */
+	int Append(char Character);
+	int Append(const char *pText, size_t Length);
+
+	/* Hands over the text, heap storage is given away without 
+	 * copying while inline text is copied into an allocation 
+	 * of its own size. The caller frees it, and the builder is reset */
+	char *Take();
+
+	/* Gets */
+	const char *GetData() { return m_pData; }
+	size_t GetLength() { return m_iLength; }
+	int IsInline() { return m_pData == &m_aInline[0]; }
+
+private:
+	/* Private - Functions */
+	int Grow(size_t Required);
+
+	/* Private - Data */
+	char m_aInline[STRINGBUILDER_INLINE_SIZE];
+	char *m_pData;
+	size_t m_iLength;
+	size_t m_iCapacity;
+};
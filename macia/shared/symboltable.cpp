@@ -0,0 +1,185 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Symbol Table (Shared)
+* - Interns identifiers into dense integer ids
+*/
+
+/* Includes */
+#include "symboltable.h"
+#include <cstdlib>
+#include <cstring>
+
+/* Initial number of hash slots, must be a power of two */
+#define SYMBOLTABLE_INIT_SLOTS		256
+
+/* Size of the blocks the symbol text is stored in */
+#define SYMBOLTABLE_BLOCK_SIZE		4096
+
+/* Folds a single ASCII character to lower-case */
+static inline char FoldCharacter(char Character) {
+	return (Character >= 'A' && Character <= 'Z') ? (char)(Character + ('a' - 'A')) : Character;
+}
+
+/* FNV-1a over the folded text */
+static unsigned int HashText(const char *pText, size_t Length) {
+	unsigned int Hash = 2166136261u;
+	for (size_t i = 0; i < Length; i++) {
+		Hash ^= (unsigned char)FoldCharacter(pText[i]);
+		Hash *= 16777619u;
+	}
+	return Hash;
+}
+
+/* Constructor
+ * Setup the initial hash slots */
+SymbolTable::SymbolTable() {
+	m_iSlotCount = SYMBOLTABLE_INIT_SLOTS;
+	m_pSlots = (int*)malloc(m_iSlotCount * sizeof(int));
+	memset(m_pSlots, 0xFF, m_iSlotCount * sizeof(int));
+	m_pBlockCurrent = NULL;
+	m_iBlockLeft = 0;
+}
+
+/* Destructor
+ * Cleanup slots and the text blocks */
+SymbolTable::~SymbolTable() {
+	for (size_t i = 0; i < m_lBlocks.size(); i++) {
+		free(m_lBlocks[i]);
+	}
+	free(m_pSlots);
+}
+
+/* Allocates text storage from the current block, 
+ * symbols are never freed individually */
+char *SymbolTable::AllocateText(size_t Length) {
+	char *Text;
+
+	/* Long names get a block of their own */
+	if (Length > m_iBlockLeft) {
+		size_t BlockSize = (Length > SYMBOLTABLE_BLOCK_SIZE) ? Length : SYMBOLTABLE_BLOCK_SIZE;
+		m_pBlockCurrent = (char*)malloc(BlockSize);
+		m_iBlockLeft = BlockSize;
+		m_lBlocks.push_back(m_pBlockCurrent);
+	}
+
+	Text = m_pBlockCurrent;
+	m_pBlockCurrent += Length;
+	m_iBlockLeft -= Length;
+	return Text;
+}
+
+/* Locates the slot for the given text, returns the 
+ * symbol id, or -1 with Slot set to the free slot */
+int SymbolTable::Find(const char *pText, size_t Length, unsigned int Hash, size_t *Slot) {
+	size_t Mask = m_iSlotCount - 1;
+	size_t Index = Hash & Mask;
+
+	/* Linear probing */
+	while (m_pSlots[Index] != -1) {
+		SymbolEntry_t *Entry = &m_lSymbols[m_pSlots[Index]];
+		if (Entry->Hash == Hash && Entry->Length == Length) {
+			size_t i = 0;
+			while (i < Length && Entry->Folded[i] == FoldCharacter(pText[i])) {
+				i++;
+			}
+			if (i == Length) {
+				return m_pSlots[Index];
+			}
+		}
+		Index = (Index + 1) & Mask;
+	}
+
+	*Slot = Index;
+	return -1;
+}
+
+/* Doubles the slots and reinserts all symbols */
+void SymbolTable::Rehash() {
+	size_t Mask;
+
+	free(m_pSlots);
+	m_iSlotCount *= 2;
+	m_pSlots = (int*)malloc(m_iSlotCount * sizeof(int));
+	memset(m_pSlots, 0xFF, m_iSlotCount * sizeof(int));
+
+	Mask = m_iSlotCount - 1;
+	for (size_t i = 0; i < m_lSymbols.size(); i++) {
+		size_t Index = m_lSymbols[i].Hash & Mask;
+		while (m_pSlots[Index] != -1) {
+			Index = (Index + 1) & Mask;
+		}
+		m_pSlots[Index] = (int)i;
+	}
+}
+
+/* Looks up the text without interning it,
+ * returns -1 if it is unknown */
+int SymbolTable::Lookup(const char *pText, size_t Length) {
+	size_t Slot;
+	return Find(pText, Length, HashText(pText, Length), &Slot);
+}
+
+/* Interns the given text and returns its id, 
+ * the same id is returned regardless of case */
+int SymbolTable::Intern(const char *pText, size_t Length) {
+
+	/* Variables */
+	SymbolEntry_t Entry;
+	unsigned int Hash = HashText(pText, Length);
+	size_t Slot = 0;
+	char *Folded, *Name;
+	int Id;
+
+	/* Already known? */
+	Id = Find(pText, Length, Hash, &Slot);
+	if (Id != -1) {
+		return Id;
+	}
+
+	/* Keep the load below one half */
+	if ((m_lSymbols.size() + 1) * 2 > m_iSlotCount) {
+		Rehash();
+		Find(pText, Length, Hash, &Slot);
+	}
+
+	/* Store both the folded text and the spelling */
+	Folded = AllocateText((Length + 1) * 2);
+	Name = Folded + Length + 1;
+	for (size_t i = 0; i < Length; i++) {
+		Folded[i] = FoldCharacter(pText[i]);
+	}
+	Folded[Length] = '\0';
+	memcpy(Name, pText, Length);
+	Name[Length] = '\0';
+
+	/* Insert */
+	Entry.Folded = Folded;
+	Entry.Name = Name;
+	Entry.Length = Length;
+	Entry.Hash = Hash;
+	Id = (int)m_lSymbols.size();
+	m_lSymbols.push_back(Entry);
+	m_pSlots[Slot] = Id;
+	return Id;
+}
+
+/* Interns a null-terminated string */
+int SymbolTable::Intern(const char *pText) {
+	return Intern(pText, strlen(pText));
+}
@@ -0,0 +1,76 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Symbol Table (Shared)
+* - Interns identifiers into dense integer ids
+*/
+#pragma once
+
+/* Includes */
+#include <cstddef>
+#include <vector>
+
+/* The symbol entry
+ * Names are compared case-insensitive, so the folded
+ * text is the key, while the first spelling seen is
+ * kept for output */
+typedef struct {
+	const char *Folded;
+	const char *Name;
+	size_t Length;
+	unsigned int Hash;
+} SymbolEntry_t;
+
+/* The symbol table
+ * Shared by the scanner, parser and data pool. Every 
+ * identifier is folded and hashed once, after that 
+ * symbols are compared by id */
+class SymbolTable
+{
+public:
+	SymbolTable();
+	~SymbolTable();
+
+	/* Interns the given text and returns its id, 
+	 * the same id is returned regardless of case */
+	int Intern(const char *pText, size_t Length);
+	int Intern(const char *pText);
+
+	/* Looks up the text without interning it,
+	 * returns -1 if it is unknown */
+	int Lookup(const char *pText, size_t Length);
+
+	/* Gets */
+	const char *GetName(int Id) { return m_lSymbols[Id].Name; }
+	size_t GetLength(int Id) { return m_lSymbols[Id].Length; }
+	int GetCount() { return (int)m_lSymbols.size(); }
+
+private:
+	/* Private - Functions */
+	int Find(const char *pText, size_t Length, unsigned int Hash, size_t *Slot);
+	char *AllocateText(size_t Length);
+	void Rehash();
+
+	/* Private - Data */
+	std::vector<SymbolEntry_t> m_lSymbols;
+	std::vector<char*> m_lBlocks;
+	int *m_pSlots;
+	size_t m_iSlotCount;
+	char *m_pBlockCurrent;
+	size_t m_iBlockLeft;
+};
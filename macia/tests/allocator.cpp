@@ -0,0 +1,149 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Register Allocator Tests
+* - Generated code must run like the AST evaluates for 
+* - every size of the register file
+*/
+
+/* Includes */
+#include "testing.h"
+#include "../generator/registerallocator.h"
+
+/* Generates, runs and evaluates a program, 
+ * the two logs must be the same */
+static void CheckProgram(const char *pName, const std::string &Text, int Registers) {
+
+	/* Variables */
+	SymbolTable Symbols;
+	TestSource Source(&Symbols, Text.c_str());
+	std::vector<unsigned char> Code, Data;
+	std::string Executed, Evaluated;
+
+	TEST_CHECK(Source.GetProgram() != NULL, "%s: did not parse", pName);
+	if (Source.GetProgram() == NULL) {
+		return;
+	}
+	TEST_CHECK(TestGenerate(Source.GetProgram(), &Symbols, Registers, &Code, &Data) == 0,
+		"%s: did not generate with %i registers", pName, Registers);
+	TEST_CHECK(TestExecute(Code, Data, &Executed) == 0, 
+		"%s: did not run with %i registers", pName, Registers);
+	TEST_CHECK(TestEvaluate(Source.GetProgram(), &Symbols, &Evaluated) == 0, "%s: did not evaluate", pName);
+	TEST_CHECK(Executed == Evaluated, "%s with %i registers:\n%s\nran as\n%s\nexpected\n%s", 
+		pName, Registers, Text.c_str(), Executed.c_str(), Evaluated.c_str());
+}
+
+/* Builds an expression that nests to the right, every 
+ * operand stays live until the innermost one is done */
+static std::string DeepExpression(int Depth) {
+	static const char *Operands[] = { "p0", "m0", "p1", "7", "m1" };
+	static const char Operators[] = "+-*+";
+	std::string Out;
+
+	for (int i = 0; i < Depth; i++) {
+		Out += Operands[i % 5];
+		Out += " ";
+		Out += Operators[i % 4];
+		Out += " (";
+	}
+	Out += "F0(p1, p0)";
+	for (int i = 0; i < Depth; i++) {
+		Out += ")";
+	}
+	return Out;
+}
+
+int main() {
+
+	/* Variables */
+	static const int Sizes[] = { 2, 3, 4, 5, 8, 256 };
+	std::string Deep = 
+		"object Program {\n"
+		"    int m0;\n"
+		"    int m1;\n"
+		"    func F0(int p0, int p1) {\n"
+		"        m0 = m0 + p0 * 3 - p1;\n"
+		"    }\n"
+		"    func F1(int p0, int p1) {\n"
+		"        int d = " + DeepExpression(40) + ";\n"
+		"        m1 = d;\n"
+		"    }\n"
+		"    func Main() {\n"
+		"        F1(5, 9);\n"
+		"        F1(m1, m0);\n"
+		"    }\n"
+		"}\n";
+
+	/* A value that was loaded from a variable can't 
+	 * be reloaded from it once a call has written it */
+	const char *pHome = 
+		"object Program {\n"
+		"    int m0;\n"
+		"    int m1;\n"
+		"    func F0(int p0) {\n"
+		"        m0 = m0 * 2 + p0;\n"
+		"        m1 = m1 - 1;\n"
+		"    }\n"
+		"    func Main() {\n"
+		"        m0 = 3;\n"
+		"        int a = m0 + m1 * (m0 - F0(m0) + m0 * (m1 + F0(m1))) + m0;\n"
+		"        int b = a;\n"
+		"        a = a + (b - F0(a)) * (a + b);\n"
+		"    }\n"
+		"}\n";
+
+	/* Arguments that have to swap registers */
+	const char *pCycles = 
+		"object Program {\n"
+		"    int m0;\n"
+		"    func F0(int p0, int p1) {\n"
+		"        m0 = m0 * 10 + p0 - p1;\n"
+		"    }\n"
+		"    func F1(int p0, int p1, int p2) {\n"
+		"        int q = F0(p1, p0) + F0(p0, p0);\n"
+		"        int r = F0(F0(p1, p0), F0(p0, p1)) + p2;\n"
+		"        int s = F1b(p2, p0, p1);\n"
+		"    }\n"
+		"    func F1b(int p0, int p1, int p2) {\n"
+		"        m0 = m0 + p0 * 100 + p1 * 10 + p2;\n"
+		"    }\n"
+		"    func Main() {\n"
+		"        int a = 1;\n"
+		"        int b = 2;\n"
+		"        F1(a, b, 3);\n"
+		"        F1(b, a + b, a);\n"
+		"    }\n"
+		"}\n";
+
+	for (size_t i = 0; i < sizeof(Sizes) / sizeof(Sizes[0]); i++) {
+		int Registers = Sizes[i];
+		int Arguments = (Registers < 4) ? Registers : 4;
+
+		CheckProgram("deep", Deep, Registers);
+		CheckProgram("home", pHome, Registers);
+		if (Registers >= 3) {
+			CheckProgram("cycles", pCycles, Registers);
+		}
+		for (unsigned int Seed = 1; Seed <= 60; Seed++) {
+			CheckProgram("random", TestRandomProgram(Seed * 7919u, 5, Arguments), Registers);
+		}
+	}
+
+	printf("allocator: %i failures\n", TestFailures);
+	return (TestFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Document Tests
+* - A document that is edited must end up like one 
+* - that is opened with the same text
+*/
+
+/* Includes */
+#include "testing.h"
+#include "../parser/document.h"
+
+/* Writes everything a client sees of a document */
+static std::string DumpDocument(Document *pDocument, SymbolTable *Symbols) {
+	std::string Out;
+	char Buffer[64];
+
+	for (size_t i = 0; i < pDocument->GetDeclarationCount(); i++) {
+		DocumentDeclaration_t &Declaration = pDocument->GetDeclaration(i);
+		snprintf(&Buffer[0], sizeof(Buffer), "[%u] start %u scanned %u line %i: ", (unsigned int)i,
+			(unsigned int)Declaration.Start, (unsigned int)Declaration.Scanned, Declaration.Line);
+		Out += &Buffer[0];
+		TestDump(Declaration.Program, Symbols, &Out);
+		Out += "\n";
+		for (size_t j = 0; j < Declaration.Diagnostics->size(); j++) {
+			DocumentDiagnostic_t &Diagnostic = (*Declaration.Diagnostics)[j];
+			snprintf(&Buffer[0], sizeof(Buffer), "    %i:%i ", Diagnostic.Line, Diagnostic.Column);
+			Out += &Buffer[0];
+			Out += Diagnostic.Message;
+			Out += "\n";
+		}
+	}
+	return Out;
+}
+
+/* A small generator of pseudo random numbers */
+static unsigned int Random(unsigned int *State, unsigned int Range) {
+	*State = *State * 1103515245u + 12345u;
+	return ((*State >> 8) & 0xFFFFFF) % Range;
+}
+
+/* Makes random edits to a document, after every 
+ * one it must be the same as a fresh one */
+static void CheckEdits(const char *pName, const char *pText, unsigned int Seed, int Edits) {
+
+	/* Variables */
+	static const char *Insertions[] = {
+		"", " ", "\n", "\n\n", "}", "{", ";", "\"", "/*", "*/", "// note\n",
+		"/* block\n comment */", "\"text\"", "int x = 1 + 2 * y;", "func G() { }",
+		"object A { int a; }\n", "import Sys;\n", "namespace N { object B { func F(int p) { p = p * 2; } } }\n",
+		"func", "object", "12", "3.25", "x", "(", ")"
+	};
+	unsigned int State = Seed;
+	SymbolTable Symbols;
+	Document Edited(&Symbols);
+
+	TEST_CHECK(Edited.Open(pText, strlen(pText)) == 0, "%s: did not open", pName);
+	for (int i = 0; i < Edits; i++) {
+		std::string Before(Edited.GetText(), Edited.GetLength());
+		size_t Offset = Random(&State, (unsigned int)Before.length() + 1);
+		size_t Removed = Random(&State, 4) == 0 ? 0 : Random(&State, 12);
+		std::string Inserted;
+		Document Fresh(&Symbols);
+
+		if (Removed > Before.length() - Offset) {
+			Removed = Before.length() - Offset;
+		}
+
+		/* Mostly typing, sometimes a piece of the text itself */
+		if (Random(&State, 5) == 0 && !Before.empty()) {
+			size_t From = Random(&State, (unsigned int)Before.length());
+			Inserted = Before.substr(From, Random(&State, 40));
+		}
+		else {
+			Inserted = Insertions[Random(&State, sizeof(Insertions) / sizeof(Insertions[0]))];
+		}
+
+		TEST_CHECK(Edited.Change(Offset, Removed, Inserted.c_str(), Inserted.length()) == 0,
+			"%s: edit %i failed", pName, i);
+		Fresh.Open(Edited.GetText(), Edited.GetLength());
+
+		std::string After(Edited.GetText(), Edited.GetLength());
+		std::string Expected = Before.substr(0, Offset) + Inserted + Before.substr(Offset + Removed);
+		TEST_CHECK(After == Expected, "%s: edit %i left the wrong text", pName, i);
+
+		std::string Incremental = DumpDocument(&Edited, &Symbols);
+		std::string Complete = DumpDocument(&Fresh, &Symbols);
+		TEST_CHECK(Incremental == Complete, "%s seed %u edit %i, replacing %u bytes at %u with '%s' of\n%s\ngave\n%s\nexpected\n%s",
+			pName, Seed, i, (unsigned int)Removed, (unsigned int)Offset, Inserted.c_str(), 
+			Before.c_str(), Incremental.c_str(), Complete.c_str());
+		if (Incremental != Complete) {
+			return;
+		}
+	}
+}
+
+int main() {
+
+	/* Variables */
+	const char *pSource = 
+		"/* A document with a bit of everything */\n"
+		"import System;\n"
+		"\n"
+		"namespace Test {\n"
+		"    readonly string MyVar = \"Hey\";\n"
+		"\n"
+		"    object Program {\n"
+		"        string teststr = \"This Is Public\";\n"
+		"\n"
+		"        // The entry point\n"
+		"        func Main() {\n"
+		"            int test = 0;\n"
+		"            int newint = 122352;\n"
+		"            test = 1252352 * (25 + 57) / 2 + newint * 2;\n"
+		"            Sec(test, 3.5);\n"
+		"        }\n"
+		"\n"
+		"        func Sec(int a, float b) { }\n"
+		"    }\n"
+		"}\n"
+		"\n"
+		"object Other {\n"
+		"    int counter = 1;\n"
+		"    func Tick() { counter = counter + 1; }\n"
+		"}\n"
+		"\n"
+		"// Trailing comment\n"
+		"object Last { }\n";
+
+	for (unsigned int Seed = 1; Seed <= 40; Seed++) {
+		CheckEdits("source", pSource, Seed, 150);
+	}
+	CheckEdits("empty", "", 1234, 200);
+
+	/* Typing a program one byte at a time */
+	{
+		SymbolTable Symbols;
+		Document Typed(&Symbols), Fresh(&Symbols);
+		Typed.Open("", 0);
+		for (size_t i = 0; pSource[i] != '\0'; i++) {
+			Typed.Change(i, 0, &pSource[i], 1);
+		}
+		Fresh.Open(pSource, strlen(pSource));
+		TEST_CHECK(DumpDocument(&Typed, &Symbols) == DumpDocument(&Fresh, &Symbols), 
+			"typing: the document differs\n%s\nexpected\n%s", 
+			DumpDocument(&Typed, &Symbols).c_str(), DumpDocument(&Fresh, &Symbols).c_str());
+	}
+
+	/* Messages are at the token that failed, not 
+	 * at the start of the declaration */
+	{
+		const char *pBroken = "object A {\n  func F() {\n    int x = 1;\n    x = ) 2;\n  }\n}\n";
+		SymbolTable Symbols;
+		Document Broken(&Symbols);
+		Broken.Open(pBroken, strlen(pBroken));
+		TEST_CHECK(Broken.GetDeclarationCount() == 1 && Broken.GetDiagnosticCount() != 0, 
+			"position: expected a message");
+		if (Broken.GetDiagnosticCount() != 0) {
+			DocumentDiagnostic_t &First = (*Broken.GetDeclaration(0).Diagnostics)[0];
+			TEST_CHECK(First.Line == 4 && First.Column == 9, "position: reported at %i:%i, expected 4:9", 
+				First.Line, First.Column);
+		}
+
+		/* Still there after a line is added above it */
+		Broken.Change(0, 0, "\n", 1);
+		if (Broken.GetDiagnosticCount() != 0) {
+			DocumentDiagnostic_t &First = (*Broken.GetDeclaration(0).Diagnostics)[0];
+			TEST_CHECK(First.Line == 5 && First.Column == 9, "position: reported at %i:%i after the edit, expected 5:9", 
+				First.Line, First.Column);
+		}
+	}
+
+	printf("document: %i failures\n", TestFailures);
+	return (TestFailures == 0) ? 0 : 1;
+}
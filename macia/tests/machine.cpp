@@ -0,0 +1,397 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Test Machine
+* - Executes the code and data image of a generated program
+*/
+
+/* Includes */
+#include "testing.h"
+#include <cstring>
+#include <map>
+
+/* Maximum depth of calls */
+#define MACHINE_MAX_DEPTH	64
+
+/* Strings are named by their text in the pool */
+#define MACHINE_STRING_PREFIX	"StringPool."
+
+/* An object of the data image */
+typedef struct {
+	int Type;
+	std::string Path;
+	std::string Scope;
+	std::string Name;
+} MachineObject_t;
+
+/* The state of a running program */
+typedef struct {
+	std::map<int, MachineObject_t> Objects;
+	std::map<int, std::pair<size_t, size_t> > Functions;
+	std::map<int, TestValue_t> Members;
+	const std::vector<unsigned char> *Code;
+	long long Calls;
+	std::string *Log;
+} Machine_t;
+
+/* Reads a little endian value of the image */
+template<typename T>
+static int Read(const std::vector<unsigned char> &Image, size_t Offset, T *Value) {
+	if (Offset + sizeof(T) > Image.size()) {
+		return -1;
+	}
+	memcpy(Value, &Image[Offset], sizeof(T));
+	return 0;
+}
+
+/* The number of operand bytes of every opcode, 
+ * -1 for those that are never generated */
+static int OperandLength(int Opcode) {
+	switch (Opcode) {
+		case OpNew: 
+		case OpInvoke: 
+		case OpStoreAR:
+		case OpLoadRA:
+		case OpStoreRI: return 5;
+		case OpStoreI: 
+		case OpLoadA: return 8;
+		case OpStore: 
+		case OpAdd: 
+		case OpSub: 
+		case OpMul: 
+		case OpDiv: 
+		case OpRem: return 2;
+		case OpStoreIW: 
+		case OpStoreF: return 12;
+		case OpStoreRIW: 
+		case OpStoreRF: return 9;
+		case OpInvokeR: return 6;
+		default: return -1;
+	}
+}
+
+/* Reads a variable, members that were never 
+ * written are zero and strings are their text */
+static int ReadVariable(Machine_t *State, std::map<int, TestValue_t> &Locals, 
+	int Id, TestValue_t *Value) {
+	std::map<int, MachineObject_t>::iterator Object = State->Objects.find(Id);
+
+	if (Object == State->Objects.end()) {
+		return -1;
+	}
+	if (Locals.find(Id) != Locals.end()) {
+		*Value = Locals[Id];
+		return 0;
+	}
+	if (Object->second.Type == CTString) {
+		*Value = TestInteger(0);
+		Value->Type = ValueString;
+		Value->Text = Object->second.Name;
+		return 0;
+	}
+	if (Object->second.Type != CTVariable) {
+		return -1;
+	}
+	*Value = (State->Members.find(Id) != State->Members.end()) ? State->Members[Id] : TestInteger(0);
+	return 0;
+}
+
+/* Runs a function, the arguments become its first variables */
+static int Run(Machine_t *State, int FunctionId, const std::vector<TestValue_t> &Arguments, int Depth) {
+
+	/* Variables */
+	std::map<int, std::pair<size_t, size_t> >::iterator Function = State->Functions.find(FunctionId);
+	std::vector<TestValue_t> Registers(256);
+	std::vector<int> Written(256, 0);
+	std::map<int, TestValue_t> Locals;
+	std::vector<int> LocalIds;
+	const std::vector<unsigned char> &Code = *State->Code;
+	const std::string &Path = State->Objects[FunctionId].Path;
+
+	if (Function == State->Functions.end() || Depth > MACHINE_MAX_DEPTH) {
+		return -1;
+	}
+
+	/* The variables of the function are local, 
+	 * the arguments are the first of them */
+	for (std::map<int, MachineObject_t>::iterator i = State->Objects.begin(); i != State->Objects.end(); i++) {
+		if (i->second.Type == CTVariable && i->second.Scope == Path) {
+			LocalIds.push_back(i->first);
+		}
+	}
+	if (Arguments.size() > LocalIds.size()) {
+		return -1;
+	}
+	for (size_t i = 0; i < Arguments.size(); i++) {
+		Locals[LocalIds[i]] = Arguments[i];
+	}
+
+	/* Execute */
+	for (size_t Offset = Function->second.first; Offset < Function->second.second; ) {
+		int Opcode = Code[Offset];
+		int Length = OperandLength(Opcode);
+		unsigned char A = 0, B = 0;
+		unsigned int X = 0, Y = 0;
+		int Immediate = 0;
+		long long Wide = 0;
+		double Float = 0.0;
+		TestValue_t Value;
+
+		if (Length < 0 || Offset + 1 + Length > Function->second.second) {
+			printf("machine: bad opcode 0x%x in %s\n", Opcode, Path.c_str());
+			return -1;
+		}
+		Offset++;
+
+		switch (Opcode) {
+			case OpNew: {
+				Read(Code, Offset, &A);
+				Registers[A] = TestInteger(0);
+				Registers[A].Type = ValueObject;
+				Written[A] = 1;
+			} break;
+			case OpInvoke: {
+				Read(Code, Offset + 1, &X);
+				if (State->Functions.find((int)X) != State->Functions.end()
+					&& Run(State, (int)X, std::vector<TestValue_t>(), Depth + 1)) {
+					return -1;
+				}
+			} break;
+			case OpInvokeR: {
+				std::vector<TestValue_t> Values;
+				Read(Code, Offset, &A);
+				Read(Code, Offset + 1, &X);
+				Read(Code, Offset + 5, &B);
+				for (int i = 0; i < B; i++) {
+					if (A + i > 255 || !Written[A + i]) {
+						printf("machine: argument $%i is not set in %s\n", A + i, Path.c_str());
+						return -1;
+					}
+					Values.push_back(Registers[A + i]);
+				}
+				if (Run(State, (int)X, Values, Depth + 1)) {
+					return -1;
+				}
+				State->Calls++;
+				Registers[A] = TestCallResult(State->Calls);
+				Written[A] = 1;
+			} break;
+			case OpStore: {
+				Read(Code, Offset, &A);
+				Read(Code, Offset + 1, &B);
+				if (!Written[B]) {
+					printf("machine: $%i is not set in %s\n", B, Path.c_str());
+					return -1;
+				}
+				Registers[A] = Registers[B];
+				Written[A] = 1;
+			} break;
+			case OpStoreAR: {
+				Read(Code, Offset, &X);
+				Read(Code, Offset + 4, &A);
+				if (!Written[A]) {
+					printf("machine: $%i is not set in %s\n", A, Path.c_str());
+					return -1;
+				}
+				Value = Registers[A];
+			} break;
+			case OpStoreI: {
+				Read(Code, Offset, &X);
+				Read(Code, Offset + 4, &Immediate);
+				Value = TestInteger(Immediate);
+			} break;
+			case OpStoreIW: {
+				Read(Code, Offset, &X);
+				Read(Code, Offset + 4, &Wide);
+				Value = TestInteger(Wide);
+			} break;
+			case OpStoreF: {
+				Read(Code, Offset, &X);
+				Read(Code, Offset + 4, &Float);
+				Value = TestInteger(0);
+				Value.Type = ValueFloat;
+				Value.Float = Float;
+			} break;
+			case OpStoreRI: {
+				Read(Code, Offset, &A);
+				Read(Code, Offset + 1, &Immediate);
+				Registers[A] = TestInteger(Immediate);
+				Written[A] = 1;
+			} break;
+			case OpStoreRIW: {
+				Read(Code, Offset, &A);
+				Read(Code, Offset + 1, &Wide);
+				Registers[A] = TestInteger(Wide);
+				Written[A] = 1;
+			} break;
+			case OpStoreRF: {
+				Read(Code, Offset, &A);
+				Read(Code, Offset + 1, &Float);
+				Registers[A] = TestInteger(0);
+				Registers[A].Type = ValueFloat;
+				Registers[A].Float = Float;
+				Written[A] = 1;
+			} break;
+			case OpLoadA: {
+				Read(Code, Offset, &X);
+				Read(Code, Offset + 4, &Y);
+				if (ReadVariable(State, Locals, (int)Y, &Value)) {
+					printf("machine: #%u can't be read in %s\n", Y, Path.c_str());
+					return -1;
+				}
+			} break;
+			case OpLoadRA: {
+				Read(Code, Offset, &A);
+				Read(Code, Offset + 1, &Y);
+				if (ReadVariable(State, Locals, (int)Y, &Registers[A])) {
+					printf("machine: #%u can't be read in %s\n", Y, Path.c_str());
+					return -1;
+				}
+				Written[A] = 1;
+			} break;
+			default: {
+				static const char Operators[] = { '+', '/', '-', '%', '*' };
+				Read(Code, Offset, &A);
+				Read(Code, Offset + 1, &B);
+				if (!Written[A] || !Written[B]
+					|| TestArithmetic(Operators[(Opcode - OpAdd) / 2], Registers[A], Registers[B], &Registers[A])) {
+					printf("machine: bad operands $%i, $%i in %s\n", A, B, Path.c_str());
+					return -1;
+				}
+			} break;
+		}
+
+		/* Writes to a variable */
+		if (Opcode == OpStoreAR || Opcode == OpStoreI || Opcode == OpStoreIW 
+			|| Opcode == OpStoreF || Opcode == OpLoadA) {
+			if (State->Objects.find((int)X) == State->Objects.end()
+				|| State->Objects[(int)X].Type != CTVariable) {
+				printf("machine: #%u can't be written in %s\n", X, Path.c_str());
+				return -1;
+			}
+			if (State->Objects[(int)X].Scope == Path) {
+				Locals[(int)X] = Value;
+			}
+			else {
+				State->Members[(int)X] = Value;
+			}
+		}
+		Offset += Length;
+	}
+
+	/* Log the variables, hidden ones are left out */
+	if (Path.compare(0, 2, "__") != 0) {
+		std::map<std::string, std::string> Sorted;
+		for (std::map<int, TestValue_t>::iterator i = Locals.begin(); i != Locals.end(); i++) {
+			const std::string &Name = State->Objects[i->first].Name;
+			if (Name.compare(0, 2, "__") != 0) {
+				Sorted[Name] = TestFormat(i->second);
+			}
+		}
+		*State->Log += Path + ":";
+		for (std::map<std::string, std::string>::iterator i = Sorted.begin(); i != Sorted.end(); i++) {
+			*State->Log += " " + i->first + "=" + i->second;
+		}
+		*State->Log += "\n";
+	}
+	return 0;
+}
+
+/* Runs a generated program from its entry point, 
+ * every function logs its variables when it returns 
+ * and the members are logged last. Returns 0 on success */
+int TestExecute(const std::vector<unsigned char> &Code, 
+	const std::vector<unsigned char> &Data, std::string *Log) {
+
+	/* Variables */
+	Machine_t State;
+	size_t Offset = 0;
+	int Entry = -1;
+
+	/* The objects */
+	while (Offset < Data.size()) {
+		unsigned int Id = 0, Length = 0;
+		unsigned char Type = 0;
+		MachineObject_t Object;
+		size_t Dot;
+
+		if (Read(Data, Offset, &Id) || Read(Data, Offset + 4, &Type) 
+			|| Read(Data, Offset + 5, &Length) || Offset + 9 + Length > Data.size()) {
+			return -1;
+		}
+		Object.Type = Type & 0x7F;
+		Object.Path.assign((const char*)&Data[Offset + 9], Length);
+		Dot = Object.Path.rfind('.');
+		Object.Scope = (Dot == std::string::npos) ? "" : Object.Path.substr(0, Dot);
+		Object.Name = (Dot == std::string::npos) ? Object.Path : Object.Path.substr(Dot + 1);
+		if (Object.Type == CTString && Object.Path.compare(0, strlen(MACHINE_STRING_PREFIX), MACHINE_STRING_PREFIX) == 0) {
+			Object.Name = Object.Path.substr(strlen(MACHINE_STRING_PREFIX));
+		}
+		State.Objects[(int)Id] = Object;
+		if (Object.Path == "__maciaentry") {
+			Entry = (int)Id;
+		}
+		Offset += 9 + Length;
+	}
+
+	/* The functions run from their label to their return */
+	Offset = 0;
+	while (Offset < Code.size()) {
+		unsigned int Id = 0;
+		size_t Start;
+
+		if (Code[Offset] != OpLabel || Read(Code, Offset + 1, &Id)) {
+			return -1;
+		}
+		Offset += 5;
+		Start = Offset;
+		while (Offset < Code.size() && Code[Offset] != OpReturn) {
+			int Length = OperandLength(Code[Offset]);
+			if (Length < 0) {
+				return -1;
+			}
+			Offset += 1 + Length;
+		}
+		if (Offset >= Code.size()) {
+			return -1;
+		}
+		State.Functions[(int)Id] = std::make_pair(Start, Offset);
+		Offset++;
+	}
+
+	/* Run it */
+	State.Code = &Code;
+	State.Calls = 0;
+	State.Log = Log;
+	Log->clear();
+	if (Entry == -1 || Run(&State, Entry, std::vector<TestValue_t>(), 0)) {
+		return -1;
+	}
+
+	/* The members */
+	std::map<std::string, std::string> Sorted;
+	for (std::map<int, TestValue_t>::iterator i = State.Members.begin(); i != State.Members.end(); i++) {
+		Sorted[State.Objects[i->first].Path] = TestFormat(i->second);
+	}
+	*Log += "members:";
+	for (std::map<std::string, std::string>::iterator i = Sorted.begin(); i != Sorted.end(); i++) {
+		*Log += " " + i->first + "=" + i->second;
+	}
+	*Log += "\n";
+	return 0;
+}
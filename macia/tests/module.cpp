@@ -0,0 +1,106 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Module Tests
+* - Namespaces saved as modules and imported again, 
+* - by names spelled like the export or not
+*/
+
+/* Includes */
+#include "testing.h"
+#include <cstring>
+
+/* Counts the imported objects of a data image with the 
+ * given path, compared case-sensitive */
+static int CountImports(const std::vector<unsigned char> &Data, const char *pPath) {
+	size_t Offset = 0;
+	int Count = 0;
+
+	while (Offset + 9 <= Data.size()) {
+		unsigned int Length = 0;
+		memcpy(&Length, &Data[Offset + 5], sizeof(Length));
+		if (Offset + 9 + Length > Data.size()) {
+			break;
+		}
+		if ((Data[Offset + 4] & 0x80) && Length == strlen(pPath)
+			&& memcmp(&Data[Offset + 9], pPath, Length) == 0) {
+			Count++;
+		}
+		Offset += 9 + Length;
+	}
+	return Count;
+}
+
+/* Compiles a program that imports the module 
+ * from the working directory */
+static int CompileImport(const char *pText, std::vector<unsigned char> *Data) {
+	SymbolTable Symbols;
+	TestSource Source(&Symbols, pText);
+	std::vector<unsigned char> Code;
+
+	if (Source.GetProgram() == NULL) {
+		return -1;
+	}
+	return TestGenerateModules(Source.GetProgram(), &Symbols, 256, ".", NULL, &Code, Data);
+}
+
+int main() {
+
+	/* Variables */
+	const char *pLibrary = 
+		"namespace Lib {\n"
+		"    func Twice(int a) { a = a * 2; }\n"
+		"    func AddThree(int a, int b, int c) { a = a + b + c; }\n"
+		"}\n"
+		"object Program { func Main() { } }\n";
+	std::vector<unsigned char> Code, Data;
+
+	/* Save the namespace as Lib.mm */
+	{
+		SymbolTable Symbols;
+		TestSource Source(&Symbols, pLibrary);
+		TEST_CHECK(Source.GetProgram() != NULL, "library: did not parse");
+		if (Source.GetProgram() == NULL) {
+			return 1;
+		}
+		TEST_CHECK(TestGenerateModules(Source.GetProgram(), &Symbols, 256, NULL, ".", &Code, &Data) == 0,
+			"library: was not saved as a module");
+	}
+
+	/* Spelled like the export */
+	TEST_CHECK(CompileImport("import Lib;\n"
+		"object Program { func Main() { int x = Twice(4); } }\n", &Data) == 0, 
+		"same spelling: did not compile");
+	TEST_CHECK(CountImports(Data, "Lib.Twice") == 1, "same spelling: Lib.Twice is not imported");
+
+	/* Spelled differently, the import keeps 
+	 * the spelling of the module */
+	TEST_CHECK(CompileImport("import Lib;\n"
+		"object Program { func Main() { int x = twice(4) + TWICE(2); addthree(1, 2, 3); } }\n", &Data) == 0,
+		"other spelling: did not compile");
+	TEST_CHECK(CountImports(Data, "Lib.Twice") == 1, "other spelling: Lib.Twice is not imported once");
+	TEST_CHECK(CountImports(Data, "Lib.AddThree") == 1, "other spelling: Lib.AddThree is not imported");
+
+	/* Names the module doesn't have */
+	TEST_CHECK(CompileImport("import Lib;\n"
+		"object Program { func Main() { int x = Thrice(4); } }\n", &Data) != 0,
+		"missing export: compiled");
+
+	printf("module: %i failures\n", TestFailures);
+	return (TestFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,210 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Optimizer Tests
+* - Constant folding against the reference evaluator, and 
+* - generating twice from the same AST
+*/
+
+/* Includes */
+#include "testing.h"
+#include "../generator/optimizer.h"
+
+/* Parses a Main with a single declaration and 
+ * gives its initializer */
+static Expression *FindInitializer(Statement *pProgram) {
+	if (pProgram == NULL || pProgram->GetType() != StmtSequence) {
+		return NULL;
+	}
+	Statement *pObject = ((Sequence*)pProgram)->GetStatement(0);
+	if (pObject->GetType() != StmtObject) {
+		return NULL;
+	}
+	Sequence *pBody = (Sequence*)((Object*)pObject)->GetBody();
+	for (size_t i = 0; i < pBody->GetCount(); i++) {
+		if (pBody->GetStatement(i)->GetType() == StmtFunction) {
+			Sequence *pMain = (Sequence*)((Function*)pBody->GetStatement(i))->GetBody();
+			return ((Declaration*)pMain->GetStatement(0))->GetExpression();
+		}
+	}
+	return NULL;
+}
+
+/* Folds the expression and checks the literal it becomes,
+ * NULL expects it to be left for the runtime */
+static void CheckFold(const char *pExpression, const char *pExpected) {
+
+	/* Variables */
+	std::string Text = std::string("object Program { func Main() { int a = ") + pExpression + "; } }";
+	SymbolTable Symbols;
+	TestSource Source(&Symbols, Text.c_str());
+	Expression *pInitializer = FindInitializer(Source.GetProgram());
+	Expression *pLeft = NULL, *pRight = NULL;
+	Arena Storage;
+	Optimizer Folder(&Storage);
+	Expression *pFolded;
+	TestValue_t Value;
+
+	TEST_CHECK(pInitializer != NULL, "%s: did not parse", pExpression);
+	if (pInitializer == NULL) {
+		return;
+	}
+	if (pInitializer->GetType() == ExprBinary) {
+		pLeft = ((BinaryExpression*)pInitializer)->GetExpression1();
+		pRight = ((BinaryExpression*)pInitializer)->GetExpression2();
+	}
+
+	Folder.Optimize(Source.GetProgram());
+	pFolded = Folder.GetFolded(pInitializer);
+
+	/* The AST is never written */
+	TEST_CHECK(FindInitializer(Source.GetProgram()) == pInitializer, "%s: the declaration was changed", pExpression);
+	if (pInitializer->GetType() == ExprBinary) {
+		TEST_CHECK(((BinaryExpression*)pInitializer)->GetExpression1() == pLeft
+			&& ((BinaryExpression*)pInitializer)->GetExpression2() == pRight, 
+			"%s: the operands were changed", pExpression);
+	}
+
+	if (pExpected == NULL) {
+		TEST_CHECK(pFolded == pInitializer, "%s: was folded", pExpression);
+		return;
+	}
+	switch (pFolded->GetType()) {
+		case ExprInteger: Value = TestInteger(((IntValue*)pFolded)->GetValue()); break;
+		case ExprFloat: {
+			Value = TestInteger(0);
+			Value.Type = ValueFloat;
+			Value.Float = ((FloatValue*)pFolded)->GetValue();
+		} break;
+		case ExprString: {
+			Value = TestInteger(0);
+			Value.Type = ValueString;
+			Value.Text = ((StringValue*)pFolded)->GetValue();
+		} break;
+		default:
+			TEST_CHECK(0, "%s: was not folded", pExpression);
+			return;
+	}
+	TEST_CHECK(TestFormat(Value) == pExpected, "%s: folded into %s, expected %s", 
+		pExpression, TestFormat(Value).c_str(), pExpected);
+}
+
+/* Generates, runs and evaluates a program, 
+ * the two logs must be the same */
+static void CheckProgram(const char *pName, const std::string &Text, int Registers) {
+
+	/* Variables */
+	SymbolTable Symbols;
+	TestSource Source(&Symbols, Text.c_str());
+	std::vector<unsigned char> Code, Data;
+	std::string Executed, Evaluated;
+
+	TEST_CHECK(Source.GetProgram() != NULL, "%s: did not parse", pName);
+	if (Source.GetProgram() == NULL) {
+		return;
+	}
+	TEST_CHECK(TestGenerate(Source.GetProgram(), &Symbols, Registers, &Code, &Data) == 0,
+		"%s: did not generate", pName);
+	TEST_CHECK(TestExecute(Code, Data, &Executed) == 0, "%s: did not run", pName);
+	TEST_CHECK(TestEvaluate(Source.GetProgram(), &Symbols, &Evaluated) == 0, "%s: did not evaluate", pName);
+	TEST_CHECK(Executed == Evaluated, "%s with %i registers:\n%s\nran as\n%s\nexpected\n%s", 
+		pName, Registers, Text.c_str(), Executed.c_str(), Evaluated.c_str());
+}
+
+/* Generates twice from the same AST, the folded 
+ * literals of the first run must not outlive it */
+static void CheckRegenerate(const char *pName, const std::string &Text) {
+
+	/* Variables */
+	SymbolTable Symbols;
+	TestSource Source(&Symbols, Text.c_str());
+	std::vector<unsigned char> Code[2], Data[2];
+
+	TEST_CHECK(Source.GetProgram() != NULL, "%s: did not parse", pName);
+	if (Source.GetProgram() == NULL) {
+		return;
+	}
+	for (int i = 0; i < 2; i++) {
+		TEST_CHECK(TestGenerate(Source.GetProgram(), &Symbols, 256, &Code[i], &Data[i]) == 0,
+			"%s: generation %i failed", pName, i);
+	}
+	TEST_CHECK(Code[0] == Code[1] && Data[0] == Data[1], "%s: the images differ", pName);
+}
+
+int main() {
+
+	/* Variables */
+	const char *pArithmetic = 
+		"object Program {\n"
+		"    int m0;\n"
+		"    func Main() {\n"
+		"        int a = 9223372036854775807 + 1;\n"
+		"        int b = -9223372036854775807 - 1 - 1;\n"
+		"        int c = (-9223372036854775807 - 1) / -1;\n"
+		"        int d = -7 / 2 + -7 % 2 * 100;\n"
+		"        int e = 7 % -3 + 4000000000 * 4000000000;\n"
+		"        int f = a + 1 / 0 + 5 % 0;\n"
+		"        int g = 2 * (3 + 4) - 6 / (1 + 1);\n"
+		"        m0 = -(g * 3) + 1;\n"
+		"    }\n"
+		"}\n";
+	const char *pStrings = 
+		"object Program {\n"
+		"    func Main() {\n"
+		"        string a = \"ab\" + \"cd\" + \"ef\";\n"
+		"        string b = a + \"gh\";\n"
+		"        float c = 1.5 * 4.0 + 2;\n"
+		"    }\n"
+		"}\n";
+
+	/* Folding of single expressions */
+	CheckFold("1 + 2 * 3", "7");
+	CheckFold("(7 - 10) * 3", "-9");
+	CheckFold("-(5 - 8)", "3");
+	CheckFold("9223372036854775807 + 1", "-9223372036854775808");
+	CheckFold("-9223372036854775807 - 1 - 1", "9223372036854775807");
+	CheckFold("(-9223372036854775807 - 1) / -1", "-9223372036854775808");
+	CheckFold("(-9223372036854775807 - 1) % -1", "0");
+	CheckFold("-7 / 2", "-3");
+	CheckFold("-7 % 2", "-1");
+	CheckFold("7 % -3", "1");
+	CheckFold("4000000000 * 4000000000", "-2446744073709551616");
+	CheckFold("\"ab\" + \"cd\"", "\"abcd\"");
+	CheckFold("1.5 * 4.0", NULL);
+	CheckFold("1 / 0", NULL);
+	CheckFold("5 % 0", NULL);
+	CheckFold("\"a\" + 1", NULL);
+
+	/* The folded programs run like the AST evaluates */
+	CheckProgram("arithmetic", pArithmetic, 256);
+	CheckProgram("arithmetic", pArithmetic, 3);
+	CheckProgram("strings", pStrings, 256);
+	for (unsigned int Seed = 1; Seed <= 50; Seed++) {
+		CheckProgram("random", TestRandomProgram(Seed, 4, 4), 256);
+	}
+
+	/* Generating again from the same AST */
+	CheckRegenerate("arithmetic", pArithmetic);
+	CheckRegenerate("strings", pStrings);
+	for (unsigned int Seed = 1; Seed <= 20; Seed++) {
+		CheckRegenerate("random", TestRandomProgram(Seed, 5, 4));
+	}
+
+	printf("optimizer: %i failures\n", TestFailures);
+	return (TestFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,144 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Parallel Parser Tests
+* - Sources parsed in ranges on worker threads must give 
+* - the same program as when they are parsed in order
+*/
+
+/* Includes */
+#include "testing.h"
+#include <cstring>
+
+/* The result of parsing a source */
+typedef struct {
+	int Result;
+	size_t Ranges;
+	size_t Tokens;
+	std::string Program;
+	std::string Symbols;
+	std::vector<unsigned char> Code;
+	std::vector<unsigned char> Data;
+} Parsed_t;
+
+/* Parses a source with the given number of threads, 
+ * and generates it when there is a Program to run */
+static void ParseWith(const std::string &Text, int Threads, int Generate, Parsed_t *Out) {
+	SymbolTable Symbols;
+	Scanner *pScanner = new Scanner(&Symbols, 0);
+	Parser *pParser;
+
+	pScanner->Begin(Text.c_str(), Text.length());
+	pParser = new Parser(pScanner);
+	Out->Result = pParser->Parse(Threads);
+	Out->Ranges = pParser->GetRangeCount();
+	Out->Tokens = pParser->GetTokenCount();
+	Out->Program.clear();
+	TestDump(pParser->GetProgram(), &Symbols, &Out->Program);
+
+	/* The ids must come out the same too */
+	Out->Symbols.clear();
+	for (int i = 0; i < Symbols.GetCount(); i++) {
+		Out->Symbols += Symbols.GetName(i);
+		Out->Symbols += " ";
+	}
+	if (Generate && Out->Result == 0) {
+		TEST_CHECK(TestGenerate(pParser->GetProgram(), &Symbols, 256, &Out->Code, &Out->Data) == 0,
+			"did not generate with %i threads", Threads);
+	}
+	delete pParser;
+	delete pScanner;
+}
+
+/* Parses in order and in parallel, the two must agree. 
+ * Returns the number of ranges of the parallel parse */
+static size_t CheckSame(const char *pName, const std::string &Text, int Generate) {
+	Parsed_t Serial, Parallel;
+
+	ParseWith(Text, 1, Generate, &Serial);
+	ParseWith(Text, 4, Generate, &Parallel);
+	TEST_CHECK(Serial.Result == Parallel.Result, "%s: the results differ, %i and %i", 
+		pName, Serial.Result, Parallel.Result);
+	TEST_CHECK(Serial.Tokens == Parallel.Tokens, "%s: %u tokens in order, %u in parallel", 
+		pName, (unsigned int)Serial.Tokens, (unsigned int)Parallel.Tokens);
+	TEST_CHECK(Serial.Symbols == Parallel.Symbols, "%s: the symbol ids differ", pName);
+	TEST_CHECK(Serial.Program == Parallel.Program, "%s: the programs differ", pName);
+	TEST_CHECK(Serial.Code == Parallel.Code && Serial.Data == Parallel.Data, 
+		"%s: the generated images differ", pName);
+	return Parallel.Ranges;
+}
+
+/* Builds objects with a few functions each */
+static std::string Objects(const char *pPrefix, int Count) {
+	std::string Out;
+	char Buffer[256];
+
+	for (int i = 0; i < Count; i++) {
+		snprintf(&Buffer[0], sizeof(Buffer), 
+			"    // Object %i\n"
+			"    object %s%i {\n"
+			"        const int Value%i = %i;\n"
+			"        func Fetch(int a, int b) { int c = a * %i + b; Value%i = c; }\n"
+			"        locked func Store() { int d = (Value%i - 3) / 2; }\n"
+			"    }\n", i, pPrefix, i, i, i, i, i, i);
+		Out += &Buffer[0];
+	}
+	return Out;
+}
+
+int main() {
+
+	/* Variables */
+	std::string Wrapped = 
+		"// The whole program is in one namespace\n"
+		"/* Its name */ namespace Big {\n"
+		+ Objects("Item", 600) +
+		"    object Program {\n"
+		"        func Main() { int x = 1 + 2; }\n"
+		"    }\n"
+		"}\n"
+		"// done\n";
+	std::string Mixed = 
+		"object Before { int a = 1; }\n"
+		"namespace First {\n"
+		+ Objects("One", 300) +
+		"}\n"
+		+ Objects("Top", 200) +
+		"namespace Second {\n"
+		"}\n"
+		"namespace Third {\n"
+		+ Objects("Three", 300) +
+		"    object Program { func Main() { } }\n"
+		"}\n";
+	std::string Nested = "namespace Outer {\n" + Objects("Outer", 300) +
+		"    namespace Inner { object Deep { func F() { } } }\n" + Objects("After", 300) + "}\n";
+	std::string Unclosed = "namespace Open {\n" + Objects("Open", 600);
+	std::string Header = "namespace Broken Name {\n" + Objects("Broken", 600) + "}\n";
+	std::string Comment = "namespace /* the name */ Odd {\n" + Objects("Odd", 600) + "}\n";
+
+	TEST_CHECK(Wrapped.length() > PARSER_PARALLEL_MIN_LENGTH, "the wrapped source is too small");
+	TEST_CHECK(CheckSame("wrapped", Wrapped, 1) > 1, "wrapped: the namespace was not cut");
+	TEST_CHECK(CheckSame("mixed", Mixed, 1) > 1, "mixed: the namespaces were not cut");
+	TEST_CHECK(CheckSame("nested", Nested, 0) > 1, "nested: the namespace was not cut");
+	CheckSame("unclosed", Unclosed, 0);
+	CheckSame("header", Header, 0);
+	CheckSame("comment", Comment, 0);
+
+	printf("parallel: %i failures\n", TestFailures);
+	return (TestFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,62 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Parser Tests
+* - Modifiers are kept on the declarations and functions 
+* - they are given to, and refused everywhere else
+*/
+
+/* Includes */
+#include "testing.h"
+
+/* Parses a source and checks its program, an expected 
+ * program of NULL means the source must not parse */
+static void CheckParse(const char *pText, const char *pExpected) {
+	SymbolTable Symbols;
+	TestSource Source(&Symbols, pText);
+	std::string Program;
+
+	if (pExpected == NULL) {
+		TEST_CHECK(Source.GetProgram() == NULL, "parsed: %s", pText);
+		return;
+	}
+	TEST_CHECK(Source.GetProgram() != NULL, "did not parse: %s", pText);
+	TestDump(Source.GetProgram(), &Symbols, &Program);
+	TEST_CHECK(Program == pExpected, "%s\n  gave     %s\n  expected %s", 
+		pText, Program.c_str(), pExpected);
+}
+
+int main() {
+
+	/* Kept on declarations and functions */
+	CheckParse("object A { const int x = 1; int y; }", 
+		"object A{const int x=1;int y=null;}");
+	CheckParse("object A { readonly locked func F() { locked int z = 2; } }", 
+		"object A{locked readonly func F(){locked int z=2;}}");
+	CheckParse("object A { const readonly const string s; func G() { } }", 
+		"object A{const readonly string s=null;func G(){null;}}");
+
+	/* Refused on everything else */
+	CheckParse("const object A { }", NULL);
+	CheckParse("locked namespace N { }", NULL);
+	CheckParse("object A { func F() { int x = 1; readonly x = 2; } }", NULL);
+	CheckParse("object A { func F() { const F(); } }", NULL);
+
+	printf("parser: %i failures\n", TestFailures);
+	return (TestFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,280 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Test Reference
+* - Evaluates the AST of a program directly, what the 
+* - generated code does is compared against it
+*/
+
+/* Includes */
+#include "testing.h"
+#include <map>
+#include <set>
+
+/* Maximum depth of calls */
+#define REFERENCE_MAX_DEPTH	64
+
+/* The state of an evaluation */
+typedef struct {
+	SymbolTable *Symbols;
+	std::string Object;
+	std::map<std::string, Function*> Functions;
+	std::set<std::string> Members;
+	std::map<std::string, TestValue_t> Values;
+	long long Calls;
+	std::string *Log;
+} Reference_t;
+
+/* The variables of a running function */
+typedef struct {
+	std::set<std::string> Declared;
+	std::map<std::string, TestValue_t> Locals;
+} Frame_t;
+
+/* Prototypes */
+static int Invoke(Reference_t *State, const std::string &Name, 
+	const std::vector<TestValue_t> &Arguments, int Depth);
+
+/* Evaluates an expression from left to right */
+static int Evaluate(Reference_t *State, Frame_t *Frame, Expression *pExpr, 
+	TestValue_t *Value, int Depth) {
+	switch (pExpr->GetType()) {
+		case ExprVariable: {
+			std::string Name = State->Symbols->GetName(((Variable*)pExpr)->GetIdentifier());
+			if (Frame->Declared.count(Name) != 0) {
+				if (Frame->Locals.find(Name) == Frame->Locals.end()) {
+					printf("reference: %s is read before it is set\n", Name.c_str());
+					return -1;
+				}
+				*Value = Frame->Locals[Name];
+				return 0;
+			}
+			if (State->Members.count(Name) != 0) {
+				*Value = (State->Values.find(Name) != State->Values.end()) ? State->Values[Name] : TestInteger(0);
+				return 0;
+			}
+			printf("reference: %s is not declared\n", Name.c_str());
+			return -1;
+		}
+		case ExprString: {
+			*Value = TestInteger(0);
+			Value->Type = ValueString;
+			Value->Text = ((StringValue*)pExpr)->GetValue();
+			return 0;
+		}
+		case ExprInteger: {
+			*Value = TestInteger(((IntValue*)pExpr)->GetValue());
+			return 0;
+		}
+		case ExprFloat: {
+			*Value = TestInteger(0);
+			Value->Type = ValueFloat;
+			Value->Float = ((FloatValue*)pExpr)->GetValue();
+			return 0;
+		}
+		case ExprUnary: {
+			TestValue_t Operand;
+			if (Evaluate(State, Frame, ((UnaryExpression*)pExpr)->GetExpression(), &Operand, Depth)) {
+				return -1;
+			}
+			return TestArithmetic('-', TestInteger(0), Operand, Value);
+		}
+		case ExprBinary: {
+			static const char Operators[] = { '+', '-', '*', '/', '%' };
+			BinaryExpression *Binary = (BinaryExpression*)pExpr;
+			TestValue_t Left, Right;
+			if (Evaluate(State, Frame, Binary->GetExpression1(), &Left, Depth)
+				|| Evaluate(State, Frame, Binary->GetExpression2(), &Right, Depth)) {
+				return -1;
+			}
+			return TestArithmetic(Operators[Binary->GetOperator()], Left, Right, Value);
+		}
+		case ExprCall: {
+			CallExpression *Call = (CallExpression*)pExpr;
+			std::vector<TestValue_t> Arguments(Call->GetArgumentCount());
+			for (size_t i = 0; i < Call->GetArgumentCount(); i++) {
+				if (Evaluate(State, Frame, Call->GetArgument(i), &Arguments[i], Depth)) {
+					return -1;
+				}
+			}
+			if (Invoke(State, State->Symbols->GetName(Call->GetIdentifier()), Arguments, Depth + 1)) {
+				return -1;
+			}
+			State->Calls++;
+			*Value = TestCallResult(State->Calls);
+			return 0;
+		}
+		default:
+			return -1;
+	}
+}
+
+/* Executes the statements of a function body */
+static int Execute(Reference_t *State, Frame_t *Frame, Statement *pStmt, int Depth) {
+	if (pStmt == NULL) {
+		return 0;
+	}
+	switch (pStmt->GetType()) {
+		case StmtSequence: {
+			Sequence *pSequence = (Sequence*)pStmt;
+			for (size_t i = 0; i < pSequence->GetCount(); i++) {
+				if (Execute(State, Frame, pSequence->GetStatement(i), Depth)) {
+					return -1;
+				}
+			}
+			return 0;
+		}
+		case StmtDeclaration: {
+			Declaration *pDeclaration = (Declaration*)pStmt;
+			std::string Name = State->Symbols->GetName(pDeclaration->GetIdentifier());
+			Frame->Declared.insert(Name);
+			if (pDeclaration->GetExpression() != NULL) {
+				TestValue_t Value;
+				if (Evaluate(State, Frame, pDeclaration->GetExpression(), &Value, Depth)) {
+					return -1;
+				}
+				Frame->Locals[Name] = Value;
+			}
+			return 0;
+		}
+		case StmtAssign: {
+			Assignment *pAssignment = (Assignment*)pStmt;
+			std::string Name = State->Symbols->GetName(pAssignment->GetIdentifier());
+			TestValue_t Value;
+			if (Evaluate(State, Frame, pAssignment->GetExpression(), &Value, Depth)) {
+				return -1;
+			}
+			if (Frame->Declared.count(Name) != 0) {
+				Frame->Locals[Name] = Value;
+			}
+			else if (State->Members.count(Name) != 0) {
+				State->Values[Name] = Value;
+			}
+			else {
+				printf("reference: %s is not declared\n", Name.c_str());
+				return -1;
+			}
+			return 0;
+		}
+		case StmtCall: {
+			TestValue_t Value;
+			return Evaluate(State, Frame, ((Call*)pStmt)->GetCall(), &Value, Depth);
+		}
+		default:
+			printf("reference: unsupported statement %i\n", (int)pStmt->GetType());
+			return -1;
+	}
+}
+
+/* Runs a function of the object, the arguments 
+ * go to its parameters in order */
+static int Invoke(Reference_t *State, const std::string &Name, 
+	const std::vector<TestValue_t> &Arguments, int Depth) {
+
+	/* Variables */
+	std::map<std::string, Function*>::iterator Target = State->Functions.find(Name);
+	Frame_t Frame;
+
+	if (Target == State->Functions.end() || Depth > REFERENCE_MAX_DEPTH
+		|| Target->second->GetParameterCount() != Arguments.size()) {
+		printf("reference: can't call %s\n", Name.c_str());
+		return -1;
+	}
+	for (size_t i = 0; i < Arguments.size(); i++) {
+		std::string Parameter = State->Symbols->GetName(Target->second->GetParameter(i)->GetIdentifier());
+		Frame.Declared.insert(Parameter);
+		Frame.Locals[Parameter] = Arguments[i];
+	}
+	if (Execute(State, &Frame, Target->second->GetBody(), Depth)) {
+		return -1;
+	}
+
+	/* Log the variables, hidden ones are left out */
+	*State->Log += State->Object + "." + Name + ":";
+	for (std::map<std::string, TestValue_t>::iterator i = Frame.Locals.begin(); i != Frame.Locals.end(); i++) {
+		if (i->first.compare(0, 2, "__") != 0) {
+			*State->Log += " " + i->first + "=" + TestFormat(i->second);
+		}
+	}
+	*State->Log += "\n";
+	return 0;
+}
+
+/* Evaluates the AST of a program with a single Program 
+ * object, the log is the same as the one of TestExecute. 
+ * Returns 0 on success */
+int TestEvaluate(Statement *pProgram, SymbolTable *Symbols, std::string *Log) {
+
+	/* Variables */
+	Reference_t State;
+	Object *pObject = NULL;
+	Sequence *pBody = NULL;
+
+	/* Find the Program object */
+	if (pProgram != NULL && pProgram->GetType() == StmtSequence) {
+		Sequence *pSequence = (Sequence*)pProgram;
+		for (size_t i = 0; i < pSequence->GetCount(); i++) {
+			Statement *pStmt = pSequence->GetStatement(i);
+			if (pStmt->GetType() == StmtObject 
+				&& strcmp(Symbols->GetName(((Object*)pStmt)->GetIdentifier()), "Program") == 0) {
+				pObject = (Object*)pStmt;
+			}
+		}
+	}
+	if (pObject == NULL || pObject->GetBody() == NULL 
+		|| pObject->GetBody()->GetType() != StmtSequence) {
+		printf("reference: there is no Program object\n");
+		return -1;
+	}
+
+	/* Its members and functions, the initializers 
+	 * of members are not run by the generated code */
+	State.Symbols = Symbols;
+	State.Object = "Program";
+	State.Calls = 0;
+	State.Log = Log;
+	pBody = (Sequence*)pObject->GetBody();
+	for (size_t i = 0; i < pBody->GetCount(); i++) {
+		Statement *pStmt = pBody->GetStatement(i);
+		if (pStmt->GetType() == StmtDeclaration) {
+			State.Members.insert(Symbols->GetName(((Declaration*)pStmt)->GetIdentifier()));
+		}
+		else if (pStmt->GetType() == StmtFunction) {
+			State.Functions[Symbols->GetName(((Function*)pStmt)->GetIdentifier())] = (Function*)pStmt;
+		}
+	}
+
+	/* The entry point runs the constructor and then 
+	 * Main, neither of them is counted as a call */
+	Log->clear();
+	if (State.Functions.find("Program") != State.Functions.end()
+		&& Invoke(&State, "Program", std::vector<TestValue_t>(), 0)) {
+		return -1;
+	}
+	if (Invoke(&State, "Main", std::vector<TestValue_t>(), 0)) {
+		return -1;
+	}
+
+	/* The members */
+	*Log += "members:";
+	for (std::map<std::string, TestValue_t>::iterator i = State.Values.begin(); i != State.Values.end(); i++) {
+		*Log += " " + State.Object + "." + i->first + "=" + TestFormat(i->second);
+	}
+	*Log += "\n";
+	return 0;
+}
@@ -0,0 +1,232 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Scanner Tests
+* - The SIMD run scanners must give the same token streams as the
+* - scalar ones. This file is built twice, test_scanner_scalar only
+* - prints the streams and test_scanner compares them with its own
+*/
+
+/* Includes */
+#include "../lexer/scanner.h"
+#include "../shared/diagnostics.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#endif
+
+/* Shifts of the inputs, they cover every alignment of
+ * the 16 and 32 byte blocks */
+#define SCANNER_TEST_SHIFTS		33
+
+/* The ends cut from the inputs, so they also stop in the
+ * middle of blocks, tokens, strings and comments */
+static const size_t __Cuts[] = { 0, 1, 2, 3, 5, 7, 8, 13, 15, 16, 17, 31, 32, 33 };
+#define SCANNER_TEST_CUTS	(int)(sizeof(__Cuts) / sizeof(__Cuts[0]))
+
+/* Mixes bytes into a FNV-1a hash */
+static void Hash(unsigned long long *Value, const void *pData, size_t Length) {
+	const unsigned char *pBytes = (const unsigned char*)pData;
+	for (size_t i = 0; i < Length; i++) {
+		*Value = (*Value ^ pBytes[i]) * 0x100000001B3ULL;
+	}
+}
+
+/* Every diagnostic is part of the stream */
+static void CollectDiagnostic(void *Context, int Line, int Column, const char *Message) {
+	unsigned long long *Value = (unsigned long long*)Context;
+	Hash(Value, &Line, sizeof(Line));
+	Hash(Value, &Column, sizeof(Column));
+	Hash(Value, Message, strlen(Message));
+}
+
+/* Builds the text every input is cut from, runs of every
+ * length with non-ASCII bytes in strings and comments */
+static std::string BuildBase() {
+	const char *pSpaces = " \t\r\n\v\f";
+	const char *pText = "abc \xc3\xa9\xff*/ /*x\x80";
+	const char *pLetters = "abcdefghijklmnopqrstuvwxyz_ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
+	std::string Out;
+	char Buffer[64];
+
+	for (int Length = 1; Length <= 70; Length++) {
+		std::string Run;
+
+		/* Identifier and whitespace runs */
+		for (int i = 0; i < Length; i++) {
+			Run += pLetters[(i + Length) % ((i == 0) ? 53 : 63)];
+		}
+		Out += Run;
+		for (int i = 0; i < (Length % 40) + 1; i++) {
+			Out += pSpaces[(i + Length) % 6];
+		}
+
+		/* Digit runs stay inside 64 bits */
+		snprintf(&Buffer[0], sizeof(Buffer), "%.*s %i.%i;\n",
+			(Length % 18) + 1, "918273645546372819", Length, Length * 7);
+		Out += &Buffer[0];
+
+		/* Strings and comments with non-ASCII bytes and closers
+		 * that fall anywhere in a block */
+		Run.clear();
+		for (int i = 0; i < Length; i++) {
+			Run += pText[i % strlen(pText)];
+		}
+		for (size_t i = 0; i < Run.length(); i++) {
+			if (Run[i] == '/' && i > 0 && Run[i - 1] == '*') {
+				Run[i] = '-';
+			}
+		}
+		Out += "\"" + Run + "\" ";
+		Out += "// " + Run + "\n";
+		Out += "/*" + Run + "\n" + Run + "*/";
+		Out += (Length & 1) ? "/** doc " + Run + "*/\n" : "/// doc " + Run + "\n";
+	}
+
+	/* The cuts end in each kind of token */
+	Out += "Tail 123456789 \"string \xc3\xa9\" /* block \xff */ Last_identifier_z 42";
+	return Out;
+}
+
+/* Builds every input */
+static void BuildInputs(std::vector<std::string> *Inputs) {
+	std::string Base = BuildBase();
+
+	for (int Shift = 0; Shift < SCANNER_TEST_SHIFTS; Shift++) {
+		std::string Shifted = std::string(Shift, ' ') + Base;
+		for (int Cut = 0; Cut < SCANNER_TEST_CUTS; Cut++) {
+			Inputs->push_back(Shifted.substr(0, Shifted.length() - __Cuts[Cut]));
+		}
+	}
+
+	/* Identifiers that run into a non-ASCII byte */
+	for (int Length = 0; Length < 70; Length++) {
+		Inputs->push_back(std::string(Length, 'x') + "\xc3\xa9 y");
+	}
+}
+
+/* Scans an input and gives its stream as a line with the
+ * index, the number of tokens and the hash of the tokens */
+static std::string Stream(const std::string &Input, size_t Index, int Flags) {
+	SymbolTable Symbols;
+	Scanner Source(&Symbols, Flags);
+	unsigned long long Value = 0xCBF29CE484222325ULL;
+	size_t Count = 0;
+	char Buffer[64];
+	int Error;
+
+	SetDiagnosticHandler(CollectDiagnostic, &Value);
+	Source.Begin(Input.c_str(), Input.length());
+	while (1) {
+		Token_t Token = Source.NextToken();
+		int Line = Source.GetLine(Token);
+		int Column = Source.GetColumn(Token);
+
+		Hash(&Value, &Token.Type, sizeof(Token.Type));
+		Hash(&Value, &Token.Symbol, sizeof(Token.Symbol));
+		Hash(&Value, &Token.Offset, sizeof(Token.Offset));
+		Hash(&Value, &Token.Length, sizeof(Token.Length));
+		Hash(&Value, &Line, sizeof(Line));
+		Hash(&Value, &Column, sizeof(Column));
+		if (Token.Type == DigitLiteral || Token.Type == FloatLiteral) {
+			Hash(&Value, &Token.Value, sizeof(Token.Value));
+		}
+		if (Token.Type == UNKNOWN) {
+			break;
+		}
+
+		/* Every token takes a character at least, a scanner
+		 * that stops moving is a difference and not a hang */
+		if (++Count > Input.length()) {
+			break;
+		}
+	}
+	SetDiagnosticHandler(NULL, NULL);
+
+	for (size_t i = 0; i < Source.GetDocComments().size(); i++) {
+		Hash(&Value, &Source.GetDocComments()[i], sizeof(CommentSpan_t));
+	}
+	Error = Source.GetError();
+	Hash(&Value, &Error, sizeof(Error));
+
+	snprintf(&Buffer[0], sizeof(Buffer), "%u %u %016llx\n",
+		(unsigned int)Index, (unsigned int)Count, Value);
+	return std::string(&Buffer[0]);
+}
+
+/* Gives the streams of every input, once with comment tokens
+ * and once with comments skipped and doc-comments recorded */
+static void Streams(std::vector<std::string> *Lines) {
+	std::vector<std::string> Inputs;
+	BuildInputs(&Inputs);
+
+	for (size_t i = 0; i < Inputs.size(); i++) {
+		Lines->push_back(Stream(Inputs[i], i, ScannerDefault));
+		Lines->push_back(Stream(Inputs[i], i,
+			ScannerSkipComments | ScannerDocComments));
+	}
+}
+
+int main(int argc, char* argv[]) {
+
+	/* Variables */
+	std::vector<std::string> Lines;
+	char Buffer[64];
+	size_t Read = 0;
+	int Failures = 0;
+	FILE *pScalar;
+
+	Streams(&Lines);
+
+	/* The scalar build only prints its streams */
+	if (argc < 2) {
+		for (size_t i = 0; i < Lines.size(); i++) {
+			fputs(Lines[i].c_str(), stdout);
+		}
+		return 0;
+	}
+
+	pScalar = popen(argv[1], "r");
+	if (pScalar == NULL) {
+		printf("scanner: could not run %s\n", argv[1]);
+		return 1;
+	}
+	while (fgets(&Buffer[0], sizeof(Buffer), pScalar) != NULL) {
+		if (Read >= Lines.size() || Lines[Read] != &Buffer[0]) {
+			printf("scanner: the streams differ, scalar %s", &Buffer[0]);
+			if (Read < Lines.size()) {
+				printf("scanner:                 simd   %s", Lines[Read].c_str());
+			}
+			Failures++;
+		}
+		Read++;
+	}
+	if (pclose(pScalar) != 0 || Read != Lines.size()) {
+		printf("scanner: the scalar build gave %u of %u streams\n",
+			(unsigned int)Read, (unsigned int)Lines.size());
+		Failures++;
+	}
+
+	printf("scanner: %u streams, %i failures\n", (unsigned int)Lines.size(), Failures);
+	return (Failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,478 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Test Support
+* - Parsing, generation and the semantics shared 
+* - by the machines
+*/
+
+/* Includes */
+#include "testing.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/* The number of failed checks */
+int TestFailures = 0;
+
+/* Scans and parses the text, it is copied as 
+ * the scanner refers to it */
+TestSource::TestSource(SymbolTable *Symbols, const char *pText) {
+	m_sText = pText;
+	m_pScanner = new Scanner(Symbols, 0);
+	m_pScanner->Begin(m_sText.c_str(), m_sText.length());
+	m_pParser = new Parser(m_pScanner);
+	m_pProgram = (m_pParser->Parse() == 0) ? m_pParser->GetProgram() : NULL;
+}
+
+TestSource::~TestSource() {
+	delete m_pParser;
+	delete m_pScanner;
+}
+
+/* The trace of the generator goes to stdout, 
+ * it is sent to /dev/null while the tests generate */
+static int Silence() {
+#if defined(__unix__) || defined(__APPLE__)
+	int Saved = -1, Null = open("/dev/null", O_WRONLY);
+	fflush(stdout);
+	if (Null != -1) {
+		Saved = dup(1);
+		dup2(Null, 1);
+		close(Null);
+	}
+	return Saved;
+#else
+	return -1;
+#endif
+}
+
+static void Restore(int Saved) {
+#if defined(__unix__) || defined(__APPLE__)
+	fflush(stdout);
+	if (Saved != -1) {
+		dup2(Saved, 1);
+		close(Saved);
+	}
+#endif
+}
+
+/* Generates code for a program with the given number of
+ * registers, the trace of the generator is silenced. The 
+ * image is the code followed by the data, returns 0 on success */
+int TestGenerate(Statement *pProgram, SymbolTable *Symbols, int Registers, 
+	std::vector<unsigned char> *Code, std::vector<unsigned char> *Data) {
+	return TestGenerateModules(pProgram, Symbols, Registers, NULL, NULL, Code, Data);
+}
+
+/* Generates like TestGenerate, imports are searched for in 
+ * Imports and the namespaces are saved as modules in Exports, 
+ * either can be NULL. Returns 0 on success */
+int TestGenerateModules(Statement *pProgram, SymbolTable *Symbols, int Registers, 
+	const char *pImports, const char *pExports,
+	std::vector<unsigned char> *Code, std::vector<unsigned char> *Data) {
+
+	/* Variables */
+	Generator *pGenerator = new Generator(pProgram, Symbols);
+	int Saved = Silence();
+	int Result = -1;
+
+	if (pImports != NULL) {
+		pGenerator->AddModulePath(pImports);
+	}
+	if (pGenerator->SetRegisterCount(Registers) == 0
+		&& pGenerator->Generate() == 0
+		&& (pExports == NULL || pGenerator->SaveModules(pExports) == 0)) {
+		*Code = pGenerator->GetCode();
+		*Data = pGenerator->GetData();
+		Result = 0;
+	}
+
+	Restore(Saved);
+	delete pGenerator;
+	return Result;
+}
+
+/* Writes an expression as text, symbols by name */
+static void DumpExpression(Expression *pExpr, SymbolTable *Symbols, std::string *Out) {
+	char Buffer[64];
+
+	if (pExpr == NULL) {
+		*Out += "null";
+		return;
+	}
+	switch (pExpr->GetType()) {
+		case ExprVariable:
+			*Out += Symbols->GetName(((Variable*)pExpr)->GetIdentifier());
+			break;
+		case ExprString:
+			*Out += "\"" + std::string(((StringValue*)pExpr)->GetValue()) + "\"";
+			break;
+		case ExprInteger:
+			snprintf(&Buffer[0], sizeof(Buffer), "%lld", ((IntValue*)pExpr)->GetValue());
+			*Out += &Buffer[0];
+			break;
+		case ExprFloat:
+			snprintf(&Buffer[0], sizeof(Buffer), "%.17g", ((FloatValue*)pExpr)->GetValue());
+			*Out += &Buffer[0];
+			break;
+		case ExprUnary:
+			*Out += "(-";
+			DumpExpression(((UnaryExpression*)pExpr)->GetExpression(), Symbols, Out);
+			*Out += ")";
+			break;
+		case ExprBinary: {
+			static const char Operators[] = "+-*/%";
+			BinaryExpression *Binary = (BinaryExpression*)pExpr;
+			*Out += "(";
+			DumpExpression(Binary->GetExpression1(), Symbols, Out);
+			*Out += Operators[Binary->GetOperator()];
+			DumpExpression(Binary->GetExpression2(), Symbols, Out);
+			*Out += ")";
+		} break;
+		case ExprCall: {
+			CallExpression *Call = (CallExpression*)pExpr;
+			*Out += Symbols->GetName(Call->GetIdentifier());
+			*Out += "(";
+			for (size_t i = 0; i < Call->GetArgumentCount(); i++) {
+				*Out += (i != 0) ? "," : "";
+				DumpExpression(Call->GetArgument(i), Symbols, Out);
+			}
+			*Out += ")";
+		} break;
+	}
+}
+
+/* Writes the modifiers of a declaration or function */
+static void DumpModifiers(int Modifiers, std::string *Out) {
+	if (Modifiers & ModifierConst) {
+		*Out += "const ";
+	}
+	if (Modifiers & ModifierLocked) {
+		*Out += "locked ";
+	}
+	if (Modifiers & ModifierReadonly) {
+		*Out += "readonly ";
+	}
+}
+
+/* Writes a statement as text, symbols by name, so 
+ * programs can be compared across symbol tables */
+void TestDump(Statement *pStmt, SymbolTable *Symbols, std::string *Out) {
+	if (pStmt == NULL) {
+		*Out += "null;";
+		return;
+	}
+	switch (pStmt->GetType()) {
+		case StmtDeclaration: {
+			Declaration *pDeclaration = (Declaration*)pStmt;
+			DumpModifiers(pDeclaration->GetModifiers(), Out);
+			*Out += Symbols->GetName(pDeclaration->GetOfType());
+			*Out += " ";
+			*Out += Symbols->GetName(pDeclaration->GetIdentifier());
+			*Out += "=";
+			DumpExpression(pDeclaration->GetExpression(), Symbols, Out);
+			*Out += ";";
+		} break;
+		case StmtNamespace:
+			*Out += "namespace ";
+			*Out += Symbols->GetName(((Namespace*)pStmt)->GetIdentifier());
+			*Out += "{";
+			TestDump(((Namespace*)pStmt)->GetBody(), Symbols, Out);
+			*Out += "}";
+			break;
+		case StmtImport:
+			*Out += "import ";
+			*Out += Symbols->GetName(((Import*)pStmt)->GetIdentifier());
+			*Out += ";";
+			break;
+		case StmtObject:
+			*Out += "object ";
+			*Out += Symbols->GetName(((Object*)pStmt)->GetIdentifier());
+			*Out += "{";
+			TestDump(((Object*)pStmt)->GetBody(), Symbols, Out);
+			*Out += "}";
+			break;
+		case StmtFunction: {
+			Function *pFunction = (Function*)pStmt;
+			DumpModifiers(pFunction->GetModifiers(), Out);
+			*Out += "func ";
+			*Out += Symbols->GetName(pFunction->GetIdentifier());
+			*Out += "(";
+			for (size_t i = 0; i < pFunction->GetParameterCount(); i++) {
+				TestDump(pFunction->GetParameter(i), Symbols, Out);
+			}
+			*Out += "){";
+			TestDump(pFunction->GetBody(), Symbols, Out);
+			*Out += "}";
+		} break;
+		case StmtAssign:
+			*Out += Symbols->GetName(((Assignment*)pStmt)->GetIdentifier());
+			*Out += "=";
+			DumpExpression(((Assignment*)pStmt)->GetExpression(), Symbols, Out);
+			*Out += ";";
+			break;
+		case StmtCall:
+			DumpExpression(((Call*)pStmt)->GetCall(), Symbols, Out);
+			*Out += ";";
+			break;
+		case StmtSequence:
+			for (size_t i = 0; i < ((Sequence*)pStmt)->GetCount(); i++) {
+				TestDump(((Sequence*)pStmt)->GetStatement(i), Symbols, Out);
+			}
+			break;
+	}
+}
+
+/* Values */
+TestValue_t TestInteger(long long Value) {
+	TestValue_t Result;
+	Result.Type = ValueInteger;
+	Result.Integer = Value;
+	Result.Float = 0.0;
+	return Result;
+}
+
+TestValue_t TestCallResult(long long Calls) {
+	return TestInteger(1000003 * Calls);
+}
+
+/* Integers wrap around in two's complement and divide 
+ * towards zero, mixed with a float they become floats.
+ * Strings are only added to strings */
+int TestArithmetic(char Operator, const TestValue_t &Left, 
+	const TestValue_t &Right, TestValue_t *Result) {
+
+	/* Integers */
+	if (Left.Type == ValueInteger && Right.Type == ValueInteger) {
+		unsigned long long A = (unsigned long long)Left.Integer;
+		unsigned long long B = (unsigned long long)Right.Integer;
+		unsigned long long Value = 0;
+
+		switch (Operator) {
+			case '+': Value = A + B; break;
+			case '-': Value = A - B; break;
+			case '*': Value = A * B; break;
+			case '/': 
+			case '%': {
+				if (Right.Integer == 0) {
+					Value = 0;
+				}
+				else if (Right.Integer == -1) {
+					Value = (Operator == '/') ? (0ULL - A) : 0;
+				}
+				else {
+					Value = (unsigned long long)((Operator == '/') ? 
+						(Left.Integer / Right.Integer) : (Left.Integer % Right.Integer));
+				}
+			} break;
+			default:
+				return -1;
+		}
+		*Result = TestInteger((long long)Value);
+		return 0;
+	}
+
+	/* Floats */
+	if ((Left.Type == ValueInteger || Left.Type == ValueFloat)
+		&& (Right.Type == ValueInteger || Right.Type == ValueFloat)) {
+		double A = (Left.Type == ValueFloat) ? Left.Float : (double)Left.Integer;
+		double B = (Right.Type == ValueFloat) ? Right.Float : (double)Right.Integer;
+
+		*Result = TestInteger(0);
+		Result->Type = ValueFloat;
+		switch (Operator) {
+			case '+': Result->Float = A + B; break;
+			case '-': Result->Float = A - B; break;
+			case '*': Result->Float = A * B; break;
+			case '/': Result->Float = (B == 0.0) ? 0.0 : (A / B); break;
+			case '%': Result->Float = (B == 0.0) ? 0.0 : fmod(A, B); break;
+			default:
+				return -1;
+		}
+		return 0;
+	}
+
+	/* Strings */
+	if (Left.Type == ValueString && Right.Type == ValueString && Operator == '+') {
+		*Result = Left;
+		Result->Text += Right.Text;
+		return 0;
+	}
+	return -1;
+}
+
+/* Formats a value for the logs */
+std::string TestFormat(const TestValue_t &Value) {
+	char Buffer[64];
+	switch (Value.Type) {
+		case ValueInteger: 
+			snprintf(&Buffer[0], sizeof(Buffer), "%lld", Value.Integer); 
+			return &Buffer[0];
+		case ValueFloat: 
+			snprintf(&Buffer[0], sizeof(Buffer), "%.17g", Value.Float); 
+			return &Buffer[0];
+		case ValueString: 
+			return "\"" + Value.Text + "\"";
+		default:
+			return "object";
+	}
+}
+
+/* A small generator of pseudo random numbers, 
+ * the programs must be the same everywhere */
+static unsigned int Random(unsigned int *State, unsigned int Range) {
+	*State = *State * 1103515245u + 12345u;
+	return ((*State >> 8) & 0xFFFFFF) % Range;
+}
+
+/* Builds a random expression over the given names,
+ * calls go to the functions given */
+static void RandomExpression(unsigned int *State, std::string *Out, int Depth,
+	const std::vector<std::string> &Names, const std::vector<int> &Arities) {
+	unsigned int Kind = Random(State, 100);
+	char Buffer[32];
+
+	/* Leaves, the odd one needs more than 32 bits */
+	if (Depth <= 0 || Kind < 15) {
+		if (!Names.empty() && Random(State, 100) < 60) {
+			*Out += Names[Random(State, (unsigned int)Names.size())];
+		}
+		else if (Random(State, 100) < 5) {
+			snprintf(&Buffer[0], sizeof(Buffer), "%u000000000", 1 + Random(State, 9));
+			*Out += &Buffer[0];
+		}
+		else {
+			snprintf(&Buffer[0], sizeof(Buffer), "%u", Random(State, 51));
+			*Out += &Buffer[0];
+		}
+		return;
+	}
+
+	if (Kind < 25) {
+		*Out += "-(";
+		RandomExpression(State, Out, Depth - 1, Names, Arities);
+		*Out += ")";
+	}
+	else if (Kind < 37 && !Arities.empty()) {
+		unsigned int Function = Random(State, (unsigned int)Arities.size());
+		snprintf(&Buffer[0], sizeof(Buffer), "F%u(", Function);
+		*Out += &Buffer[0];
+		for (int i = 0; i < Arities[Function]; i++) {
+			if (i != 0) {
+				*Out += ", ";
+			}
+			RandomExpression(State, Out, Depth - 2, Names, Arities);
+		}
+		*Out += ")";
+	}
+	else if (Kind < 45) {
+		*Out += "(";
+		RandomExpression(State, Out, Depth - 1, Names, Arities);
+		*Out += ")";
+	}
+	else {
+		static const char Operators[] = "+-*/%+*-";
+		RandomExpression(State, Out, Depth - 1, Names, Arities);
+		*Out += " ";
+		*Out += Operators[Random(State, 8)];
+		*Out += " ";
+		RandomExpression(State, Out, Depth - 1, Names, Arities);
+	}
+}
+
+/* Builds the statements of a function body */
+static void RandomBody(unsigned int *State, std::string *Out, int Depth, int Count,
+	std::vector<std::string> Names, const std::vector<int> &Arities) {
+	char Buffer[32];
+
+	for (int i = 0; i < Count; i++) {
+		unsigned int Kind = Random(State, 100);
+
+		if (Kind < 30) {
+			*Out += "        " + Names[Random(State, (unsigned int)Names.size())] + " = ";
+			RandomExpression(State, Out, Depth, Names, Arities);
+			*Out += ";\n";
+		}
+		else if (Kind < 40 && !Arities.empty()) {
+			unsigned int Function = Random(State, (unsigned int)Arities.size());
+			snprintf(&Buffer[0], sizeof(Buffer), "        F%u(", Function);
+			*Out += &Buffer[0];
+			for (int j = 0; j < Arities[Function]; j++) {
+				if (j != 0) {
+					*Out += ", ";
+				}
+				RandomExpression(State, Out, Depth - 2, Names, Arities);
+			}
+			*Out += ");\n";
+		}
+		else {
+			snprintf(&Buffer[0], sizeof(Buffer), "v%i", i);
+			*Out += "        int ";
+			*Out += &Buffer[0];
+			*Out += " = ";
+			RandomExpression(State, Out, Depth, Names, Arities);
+			*Out += ";\n";
+			Names.push_back(&Buffer[0]);
+		}
+	}
+}
+
+/* Builds a random program of integer arithmetic over 
+ * locals, parameters and members, with functions that call 
+ * the ones before them. No call takes more than the given 
+ * number of arguments */
+std::string TestRandomProgram(unsigned int Seed, int Depth, int MaxArguments) {
+	std::string Out = "object Program {\n    int m0;\n    int m1;\n    func Program() { }\n";
+	std::vector<int> Arities;
+	unsigned int State = Seed;
+	int Functions = 1 + (int)Random(&State, 4);
+	char Buffer[32];
+
+	for (int i = 0; i < Functions; i++) {
+		std::vector<std::string> Names;
+		int Arity = (int)Random(&State, (unsigned int)MaxArguments + 1);
+
+		snprintf(&Buffer[0], sizeof(Buffer), "    func F%i(", i);
+		Out += &Buffer[0];
+		for (int j = 0; j < Arity; j++) {
+			snprintf(&Buffer[0], sizeof(Buffer), "p%i", j);
+			Out += (j != 0) ? ", int " : "int ";
+			Out += &Buffer[0];
+			Names.push_back(&Buffer[0]);
+		}
+		Out += ") {\n";
+		Names.push_back("m0");
+		Names.push_back("m1");
+		RandomBody(&State, &Out, Depth, 1 + (int)Random(&State, 6), Names, Arities);
+		Out += "    }\n";
+		Arities.push_back(Arity);
+	}
+
+	Out += "    func Main() {\n";
+	std::vector<std::string> Members;
+	Members.push_back("m0");
+	Members.push_back("m1");
+	RandomBody(&State, &Out, Depth, 3 + (int)Random(&State, 10), Members, Arities);
+	Out += "    }\n}\n";
+	return Out;
+}
@@ -0,0 +1,121 @@
+/* The Macia Language (MACIA)
+*
+* Copyright 2016, Philip Meulengracht
+*
+* This program is free software : you can redistribute it and / or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation ? , either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.If not, see <http://www.gnu.org/licenses/>.
+*
+*
+* Macia - Test Support
+* - Runs generated bytecode and evaluates the AST it was 
+* - generated from, so the two can be compared
+*/
+#pragma once
+
+/* Includes */
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../lexer/scanner.h"
+#include "../parser/parser.h"
+#include "../generator/generator.h"
+
+/* Checks a condition, failures are counted 
+ * and reported with where they happened */
+#define TEST_CHECK(Condition, ...) do { \
+	if (!(Condition)) { \
+		printf("%s:%i: ", __FILE__, __LINE__); \
+		printf(__VA_ARGS__); \
+		printf("\n"); \
+		TestFailures++; \
+	} } while (0)
+
+/* The number of failed checks */
+extern int TestFailures;
+
+/* The value types of the test machines */
+typedef enum {
+	ValueInteger,
+	ValueFloat,
+	ValueString,
+	ValueObject
+} ValueType_t;
+
+/* A value held by a register or a variable */
+typedef struct {
+	ValueType_t Type;
+	long long Integer;
+	double Float;
+	std::string Text;
+} TestValue_t;
+
+/* A parsed source, the scanner and the parser 
+ * own the AST and must live as long as it is used */
+class TestSource
+{
+public:
+	TestSource(SymbolTable *Symbols, const char *pText);
+	~TestSource();
+
+	/* Gets, the program is NULL when parsing failed */
+	Statement *GetProgram() { return m_pProgram; }
+
+private:
+	std::string m_sText;
+	Scanner *m_pScanner;
+	Parser *m_pParser;
+	Statement *m_pProgram;
+};
+
+/* Generates code for a program with the given number of
+ * registers, the trace of the generator is silenced. The 
+ * image is the code followed by the data, returns 0 on success */
+int TestGenerate(Statement *pProgram, SymbolTable *Symbols, int Registers, 
+	std::vector<unsigned char> *Code, std::vector<unsigned char> *Data);
+
+/* Generates like TestGenerate, imports are searched for in 
+ * Imports and the namespaces are saved as modules in Exports, 
+ * either can be NULL. Returns 0 on success */
+int TestGenerateModules(Statement *pProgram, SymbolTable *Symbols, int Registers, 
+	const char *pImports, const char *pExports,
+	std::vector<unsigned char> *Code, std::vector<unsigned char> *Data);
+
+/* Runs a generated program from its entry point, 
+ * every function logs its variables when it returns 
+ * and the members are logged last. Returns 0 on success */
+int TestExecute(const std::vector<unsigned char> &Code, 
+	const std::vector<unsigned char> &Data, std::string *Log);
+
+/* Evaluates the AST of a program with a single Program 
+ * object, the log is the same as the one of TestExecute. 
+ * Returns 0 on success */
+int TestEvaluate(Statement *pProgram, SymbolTable *Symbols, std::string *Log);
+
+/* Writes a statement as text, symbols by name, so 
+ * programs can be compared across symbol tables */
+void TestDump(Statement *pStmt, SymbolTable *Symbols, std::string *Out);
+
+/* Builds a random program of integer arithmetic over 
+ * locals, parameters and members, with functions that call 
+ * the ones before them. No call takes more than the given 
+ * number of arguments */
+std::string TestRandomProgram(unsigned int Seed, int Depth, int MaxArguments);
+
+/* Shared semantics of both machines, calls yield 
+ * a value derived from the number of calls made and 
+ * a division by zero yields zero */
+TestValue_t TestInteger(long long Value);
+TestValue_t TestCallResult(long long Calls);
+int TestArithmetic(char Operator, const TestValue_t &Left, 
+	const TestValue_t &Right, TestValue_t *Result);
+std::string TestFormat(const TestValue_t &Value);